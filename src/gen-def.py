@@ -20,10 +20,13 @@ if '--experimental-api' not in sys.argv:
 	# Move these to harfbuzz-sections.txt when got stable
 	experimental_symbols = \
 """hb_font_draw_glyph
+hb_font_draw_glyphs
+hb_font_set_draw_cache_size
 hb_draw_funcs_t
 hb_draw_close_path_func_t
 hb_draw_cubic_to_func_t
 hb_draw_line_to_func_t
+hb_draw_lines_to_func_t
 hb_draw_move_to_func_t
 hb_draw_quadratic_to_func_t
 hb_draw_funcs_create
@@ -33,7 +36,9 @@ hb_draw_funcs_make_immutable
 hb_draw_funcs_reference
 hb_draw_funcs_set_close_path_func
 hb_draw_funcs_set_cubic_to_func
+hb_draw_funcs_set_flatten_tolerance
 hb_draw_funcs_set_line_to_func
+hb_draw_funcs_set_lines_to_func
 hb_draw_funcs_set_move_to_func
 hb_draw_funcs_set_quadratic_to_func
 hb_style_get_value
@@ -234,6 +234,7 @@ hb_aat_layout_compile_map (const hb_aat_map_builder_t *mapper,
 hb_bool_t
 hb_aat_layout_has_substitution (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.morx->has_data () ||
 	 face->table.mort->has_data ();
 }
@@ -243,6 +244,7 @@ hb_aat_layout_substitute (const hb_ot_shape_plan_t *plan,
 			  hb_font_t *font,
 			  hb_buffer_t *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_blob_t *morx_blob = font->face->table.morx.get_blob ();
   const AAT::morx& morx = *morx_blob->as<AAT::morx> ();
   if (morx.has_data ())
@@ -301,6 +303,7 @@ hb_aat_layout_remove_deleted_glyphs (hb_buffer_t *buffer)
 hb_bool_t
 hb_aat_layout_has_positioning (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.kerx->has_data ();
 }
 
@@ -309,6 +312,7 @@ hb_aat_layout_position (const hb_ot_shape_plan_t *plan,
 			hb_font_t *font,
 			hb_buffer_t *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_blob_t *kerx_blob = font->face->table.kerx.get_blob ();
   const AAT::kerx& kerx = *kerx_blob->as<AAT::kerx> ();
 
@@ -332,6 +336,7 @@ hb_aat_layout_position (const hb_ot_shape_plan_t *plan,
 hb_bool_t
 hb_aat_layout_has_tracking (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.trak->has_data ();
 }
 
@@ -340,6 +345,7 @@ hb_aat_layout_track (const hb_ot_shape_plan_t *plan,
 		     hb_font_t *font,
 		     hb_buffer_t *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   const AAT::trak& trak = *font->face->table.trak;
 
   AAT::hb_aat_apply_context_t c (plan, font, buffer);
@@ -366,6 +372,7 @@ hb_aat_layout_get_feature_types (hb_face_t                    *face,
 				 unsigned int                 *feature_count, /* IN/OUT.  May be NULL. */
 				 hb_aat_layout_feature_type_t *features       /* OUT.     May be NULL. */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.feat->get_feature_types (start_offset, feature_count, features);
 }
 
@@ -384,6 +391,7 @@ hb_ot_name_id_t
 hb_aat_layout_feature_type_get_name_id (hb_face_t                    *face,
 					hb_aat_layout_feature_type_t  feature_type)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.feat->get_feature_name_id (feature_type);
 }
 
@@ -416,6 +424,7 @@ hb_aat_layout_feature_type_get_selector_infos (hb_face_t
 					       hb_aat_layout_feature_selector_info_t *selectors,      /* OUT.     May be NULL. */
 					       unsigned int                          *default_index   /* OUT.     May be NULL. */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.feat->get_selector_infos (feature_type, start_offset, selector_count, selectors, default_index);
 }
 
@@ -63,6 +63,7 @@
 #define hb_atomic_int_impl_get(AI)		__atomic_load_n ((AI), __ATOMIC_ACQUIRE)
 
 #define hb_atomic_ptr_impl_set_relaxed(P, V)	__atomic_store_n ((P), (V), __ATOMIC_RELAXED)
+#define hb_atomic_ptr_impl_set(P, V)		__atomic_store_n ((P), (V), __ATOMIC_RELEASE)
 #define hb_atomic_ptr_impl_get_relaxed(P)	__atomic_load_n ((P), __ATOMIC_RELAXED)
 #define hb_atomic_ptr_impl_get(P)		__atomic_load_n ((P), __ATOMIC_ACQUIRE)
 static inline bool
@@ -90,6 +91,7 @@ _hb_atomic_ptr_impl_cmplexch (const void **P, const void *O_, const void *N)
 #define hb_atomic_int_impl_get(AI)		(reinterpret_cast<std::atomic<int> const *> (AI)->load (std::memory_order_acquire))
 
 #define hb_atomic_ptr_impl_set_relaxed(P, V)	(reinterpret_cast<std::atomic<void*> *> (P)->store ((V), std::memory_order_relaxed))
+#define hb_atomic_ptr_impl_set(P, V)		(reinterpret_cast<std::atomic<void*> *> (P)->store ((V), std::memory_order_release))
 #define hb_atomic_ptr_impl_get_relaxed(P)	(reinterpret_cast<std::atomic<void*> const *> (P)->load (std::memory_order_relaxed))
 #define hb_atomic_ptr_impl_get(P)		(reinterpret_cast<std::atomic<void*> *> (P)->load (std::memory_order_acquire))
 static inline bool
@@ -254,6 +256,9 @@ inline void hb_atomic_int_impl_set (int *AI, int v)	{ _hb_memory_w_barrier (); *
 #ifndef hb_atomic_int_impl_get
 inline int hb_atomic_int_impl_get (const int *AI)	{ int v = *AI; _hb_memory_r_barrier (); return v; }
 #endif
+#ifndef hb_atomic_ptr_impl_set
+inline void hb_atomic_ptr_impl_set (void **P, void *v)	{ _hb_memory_w_barrier (); *P = v; }
+#endif
 #ifndef hb_atomic_ptr_impl_get
 inline void *hb_atomic_ptr_impl_get (void ** const P)	{ void *v = *P; _hb_memory_r_barrier (); return v; }
 #endif
@@ -268,6 +273,7 @@ struct hb_atomic_int_t
   int get () const { return hb_atomic_int_impl_get (&v); }
   int inc () { return hb_atomic_int_impl_add (&v,  1); }
   int dec () { return hb_atomic_int_impl_add (&v, -1); }
+  int add (int v_) { return hb_atomic_int_impl_add (&v, v_); }
 
   int v;
 };
@@ -281,6 +287,7 @@ struct hb_atomic_ptr_t
 
   void init (T* v_ = nullptr) { set_relaxed (v_); }
   void set_relaxed (T* v_) { hb_atomic_ptr_impl_set_relaxed (&v, v_); }
+  void set (T* v_) { hb_atomic_ptr_impl_set ((void **) &v, (void *) v_); }
   T *get_relaxed () const { return (T *) hb_atomic_ptr_impl_get_relaxed (&v); }
   T *get () const { return (T *) hb_atomic_ptr_impl_get ((void **) &v); }
   bool cmpexch (const T *old, T *new_) const { return hb_atomic_ptr_impl_cmpexch ((void **) &v, (void *) old, (void *) new_); }
@@ -292,4 +299,43 @@ struct hb_atomic_ptr_t
 };
 
 
+/* Counts lock-free readers in two phases, so that what they may be looking
+ * at can be freed once none is anymore.  A writer that unpublished something
+ * and then calls flip() can free it once each phase has been returned as
+ * drained, by that call or later ones.  Calls to flip() must not overlap. */
+struct hb_reader_phases_t
+{
+  /* Returns the phase entered, to pass to leave(). */
+  unsigned int enter ()
+  {
+    unsigned int p = phase.get_relaxed () & 1;
+    readers[p].inc ();
+    /* Ordered before anything the reader loads. */
+    _hb_memory_barrier ();
+    return p;
+  }
+  void leave (unsigned int p) { readers[p].dec (); }
+
+  /* Switches the phase readers enter.  Returns the phases seen with no
+   * readers, as bits 1 and 2: the one readers were not entering has likely
+   * drained before, and the other may have after. */
+  unsigned int flip ()
+  {
+    /* Ordered after what the writer unpublished. */
+    _hb_memory_barrier ();
+    unsigned int drained = get_drained ();
+    phase.set_relaxed (phase.get_relaxed () ^ 1);
+    _hb_memory_barrier ();
+    return drained | get_drained ();
+  }
+
+  private:
+  unsigned int get_drained () const
+  { return (readers[0].get () ? 0 : 1) | (readers[1].get () ? 0 : 2); }
+
+  hb_atomic_int_t phase;
+  hb_atomic_int_t readers[2];
+};
+
+
 #endif /* HB_ATOMIC_HH */
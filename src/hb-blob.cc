@@ -376,12 +376,11 @@ hb_blob_get_data_writable (hb_blob_t *blob, unsigned int *length)
 }
 
 
-bool
-hb_blob_t::try_make_writable_inplace_unix ()
+#ifdef HAVE_SYS_MMAN_H
+static inline uintptr_t
+_hb_blob_get_pagesize ()
 {
-#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MPROTECT)
-  uintptr_t pagesize = -1, mask, length;
-  const char *addr;
+  uintptr_t pagesize = -1;
 
 #if defined(HAVE_SYSCONF) && defined(_SC_PAGE_SIZE)
   pagesize = (uintptr_t) sysconf (_SC_PAGE_SIZE);
@@ -391,6 +390,17 @@ hb_blob_t::try_make_writable_inplace_unix ()
   pagesize = (uintptr_t) getpagesize ();
 #endif
 
+  return pagesize;
+}
+#endif
+
+bool
+hb_blob_t::try_make_writable_inplace_unix ()
+{
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MPROTECT)
+  uintptr_t pagesize = _hb_blob_get_pagesize (), mask, length;
+  const char *addr;
+
   if ((uintptr_t) -1L == pagesize) {
     DEBUG_MSG_FUNC (BLOB, this, "failed to get pagesize: %s", strerror (errno));
     return false;
@@ -556,6 +566,56 @@ _open_resource_fork (const char *file_name, hb_mapped_file_t *file)
 }
 #endif
 
+/* Allocates room for a copy of a file of @length bytes, backed by
+ * transparent huge pages if asked for and the file is large enough to
+ * fill one.  Free with free(). */
+static char *
+_hb_blob_allocate_for_file (unsigned long length, hb_blob_file_flags_t flags)
+{
+#if defined(HAVE_SYS_MMAN_H) && defined(MADV_HUGEPAGE)
+  const unsigned long huge_page_size = 2 << 20;
+  void *data;
+  if ((flags & HB_BLOB_FILE_FLAG_HUGE_PAGES) && length >= huge_page_size &&
+      !posix_memalign (&data, huge_page_size, length))
+  {
+    madvise (data, length, MADV_HUGEPAGE);
+    return (char *) data;
+  }
+#endif
+  return (char *) malloc (length);
+}
+
+#if defined(HAVE_MMAP) && !defined(HB_NO_MMAP)
+/* Reads @length bytes from @fd in one go, or returns nullptr. */
+static hb_blob_t *
+_hb_blob_read_fd (int fd, unsigned long length, hb_blob_file_flags_t flags)
+{
+  if (unlikely (!length)) return nullptr;
+
+  char *data = _hb_blob_allocate_for_file (length, flags);
+  if (unlikely (!data)) return nullptr;
+
+  unsigned long done = 0;
+  while (done < length)
+  {
+    ssize_t ret = read (fd, data + done, length - done);
+#ifdef EINTR
+    if (unlikely (ret == -1 && errno == EINTR)) continue;
+#endif
+    if (unlikely (ret <= 0)) break;
+    done += ret;
+  }
+  if (unlikely (done < length))
+  {
+    free (data);
+    return nullptr;
+  }
+
+  return hb_blob_create (data, length, HB_MEMORY_MODE_WRITABLE, data,
+			 (hb_destroy_func_t) free);
+}
+#endif
+
 /**
  * hb_blob_create_from_file:
  * @file_name: font filename.
@@ -567,6 +627,33 @@ _open_resource_fork (const char *file_name, hb_mapped_file_t *file)
 hb_blob_t *
 hb_blob_create_from_file (const char *file_name)
 {
+  return hb_blob_create_from_file_with_flags (file_name, HB_BLOB_FILE_FLAG_DEFAULT);
+}
+
+/**
+ * hb_blob_create_from_file_with_flags:
+ * @file_name: font filename.
+ * @flags: How to bring the file into memory.
+ *
+ * Like hb_blob_create_from_file(), with control over how the file is
+ * brought into memory; see #hb_blob_file_flags_t.  Mapping, the default,
+ * is cheapest to start with and shares memory with other processes using
+ * the same font.  Populating the mapping saves page faults later, when
+ * most of the file will be used anyway.  Copying a large font into huge
+ * pages takes more memory and startup time, in exchange for faster
+ * scattered access, as to its glyph outlines, afterwards.
+ *
+ * Returns: A hb_blob_t pointer with the content of the file
+ *
+ * Since: REPLACEME
+ **/
+hb_blob_t *
+hb_blob_create_from_file_with_flags (const char           *file_name,
+				     hb_blob_file_flags_t  flags)
+{
+  if (flags & HB_BLOB_FILE_FLAG_HUGE_PAGES)
+    flags = (hb_blob_file_flags_t) (flags | HB_BLOB_FILE_FLAG_COPY);
+
   /* Adopted from glib's gmappedfile.c with Matthias Clasen and
      Allison Lortie permission but changed a lot to suit our need. */
 #if defined(HAVE_MMAP) && !defined(HB_NO_MMAP)
@@ -593,16 +680,39 @@ hb_blob_create_from_file (const char *file_name)
   }
 #endif
 
-  file->contents = (char *) mmap (nullptr, file->length, PROT_READ,
-				  MAP_PRIVATE | MAP_NORESERVE, fd, 0);
+  if (flags & HB_BLOB_FILE_FLAG_COPY)
+  {
+    hb_blob_t *blob = _hb_blob_read_fd (fd, file->length, flags);
+    if (unlikely (!blob)) goto fail;
+    close (fd);
+    free (file);
+    return blob;
+  }
+
+  {
+    int map_flags = MAP_PRIVATE | MAP_NORESERVE;
+#ifdef MAP_POPULATE
+    if (flags & HB_BLOB_FILE_FLAG_POPULATE)
+      map_flags |= MAP_POPULATE;
+#endif
+    file->contents = (char *) mmap (nullptr, file->length, PROT_READ,
+				    map_flags, fd, 0);
+  }
 
   if (unlikely (file->contents == MAP_FAILED)) goto fail;
 
   close (fd);
 
-  return hb_blob_create (file->contents, file->length,
-			 HB_MEMORY_MODE_READONLY_MAY_MAKE_WRITABLE, (void *) file,
-			 (hb_destroy_func_t) _hb_mapped_file_destroy);
+  {
+    hb_blob_t *blob = hb_blob_create (file->contents, file->length,
+				      HB_MEMORY_MODE_READONLY_MAY_MAKE_WRITABLE, (void *) file,
+				      (hb_destroy_func_t) _hb_mapped_file_destroy);
+#ifndef MAP_POPULATE
+    if (flags & HB_BLOB_FILE_FLAG_POPULATE)
+      blob->prefault ();
+#endif
+    return blob;
+  }
 
 fail:
   close (fd);
@@ -610,75 +720,88 @@ fail_without_close:
   free (file);
 
 #elif defined(_WIN32) && !defined(HB_NO_MMAP)
-  hb_mapped_file_t *file = (hb_mapped_file_t *) calloc (1, sizeof (hb_mapped_file_t));
-  if (unlikely (!file)) return hb_blob_get_empty ();
-
-  HANDLE fd;
-  unsigned int size = strlen (file_name) + 1;
-  wchar_t * wchar_file_name = (wchar_t *) malloc (sizeof (wchar_t) * size);
-  if (unlikely (!wchar_file_name)) goto fail_without_close;
-  mbstowcs (wchar_file_name, file_name, size);
-#if !WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+  if (!(flags & HB_BLOB_FILE_FLAG_COPY))
   {
-    CREATEFILE2_EXTENDED_PARAMETERS ceparams = { 0 };
-    ceparams.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS);
-    ceparams.dwFileAttributes = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED & 0xFFFF;
-    ceparams.dwFileFlags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED & 0xFFF00000;
-    ceparams.dwSecurityQosFlags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED & 0x000F0000;
-    ceparams.lpSecurityAttributes = nullptr;
-    ceparams.hTemplateFile = nullptr;
-    fd = CreateFile2 (wchar_file_name, GENERIC_READ, FILE_SHARE_READ,
-		      OPEN_EXISTING, &ceparams);
-  }
+    hb_mapped_file_t *file = (hb_mapped_file_t *) calloc (1, sizeof (hb_mapped_file_t));
+    if (unlikely (!file)) return hb_blob_get_empty ();
+
+    HANDLE fd;
+    unsigned int size = strlen (file_name) + 1;
+    wchar_t * wchar_file_name = (wchar_t *) malloc (sizeof (wchar_t) * size);
+    if (unlikely (!wchar_file_name)) goto fail_without_close;
+    mbstowcs (wchar_file_name, file_name, size);
+#if !WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+    {
+      CREATEFILE2_EXTENDED_PARAMETERS ceparams = { 0 };
+      ceparams.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS);
+      ceparams.dwFileAttributes = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED & 0xFFFF;
+      ceparams.dwFileFlags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED & 0xFFF00000;
+      ceparams.dwSecurityQosFlags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED & 0x000F0000;
+      ceparams.lpSecurityAttributes = nullptr;
+      ceparams.hTemplateFile = nullptr;
+      fd = CreateFile2 (wchar_file_name, GENERIC_READ, FILE_SHARE_READ,
+		        OPEN_EXISTING, &ceparams);
+    }
 #else
-  fd = CreateFileW (wchar_file_name, GENERIC_READ, FILE_SHARE_READ, nullptr,
-		    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL|FILE_FLAG_OVERLAPPED,
-		    nullptr);
+    fd = CreateFileW (wchar_file_name, GENERIC_READ, FILE_SHARE_READ, nullptr,
+		      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL|FILE_FLAG_OVERLAPPED,
+		      nullptr);
 #endif
-  free (wchar_file_name);
+    free (wchar_file_name);
 
-  if (unlikely (fd == INVALID_HANDLE_VALUE)) goto fail_without_close;
+    if (unlikely (fd == INVALID_HANDLE_VALUE)) goto fail_without_close;
 
 #if !WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
-  {
-    LARGE_INTEGER length;
-    GetFileSizeEx (fd, &length);
-    file->length = length.LowPart;
-    file->mapping = CreateFileMappingFromApp (fd, nullptr, PAGE_READONLY, length.QuadPart, nullptr);
-  }
+    {
+      LARGE_INTEGER length;
+      GetFileSizeEx (fd, &length);
+      file->length = length.LowPart;
+      file->mapping = CreateFileMappingFromApp (fd, nullptr, PAGE_READONLY, length.QuadPart, nullptr);
+    }
 #else
-  file->length = (unsigned long) GetFileSize (fd, nullptr);
-  file->mapping = CreateFileMapping (fd, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    file->length = (unsigned long) GetFileSize (fd, nullptr);
+    file->mapping = CreateFileMapping (fd, nullptr, PAGE_READONLY, 0, 0, nullptr);
 #endif
-  if (unlikely (!file->mapping)) goto fail;
+    if (unlikely (!file->mapping)) goto fail;
 
 #if !WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
-  file->contents = (char *) MapViewOfFileFromApp (file->mapping, FILE_MAP_READ, 0, 0);
+    file->contents = (char *) MapViewOfFileFromApp (file->mapping, FILE_MAP_READ, 0, 0);
 #else
-  file->contents = (char *) MapViewOfFile (file->mapping, FILE_MAP_READ, 0, 0, 0);
+    file->contents = (char *) MapViewOfFile (file->mapping, FILE_MAP_READ, 0, 0, 0);
 #endif
-  if (unlikely (!file->contents)) goto fail;
+    if (unlikely (!file->contents)) goto fail;
 
-  CloseHandle (fd);
-  return hb_blob_create (file->contents, file->length,
-			 HB_MEMORY_MODE_READONLY_MAY_MAKE_WRITABLE, (void *) file,
-			 (hb_destroy_func_t) _hb_mapped_file_destroy);
+    CloseHandle (fd);
+    return hb_blob_create (file->contents, file->length,
+			   HB_MEMORY_MODE_READONLY_MAY_MAKE_WRITABLE, (void *) file,
+			   (hb_destroy_func_t) _hb_mapped_file_destroy);
 
 fail:
-  CloseHandle (fd);
+    CloseHandle (fd);
 fail_without_close:
-  free (file);
+    free (file);
+  }
 
 #endif
 
-  /* The following tries to read a file without knowing its size beforehand
-     It's used as a fallback for systems without mmap or to read from pipes */
-  unsigned long len = 0, allocated = BUFSIZ * 16;
-  char *data = (char *) malloc (allocated);
-  if (unlikely (!data)) return hb_blob_get_empty ();
-
+  /* The following reads a file whose size is known only approximately, if
+     at all.  It's used as a fallback for systems without mmap or to read
+     from pipes */
   FILE *fp = fopen (file_name, "rb");
-  if (unlikely (!fp)) goto fread_fail_without_close;
+  if (unlikely (!fp)) return hb_blob_get_empty ();
+
+  /* Room for the whole file if it can be sized, plus some, so that the
+     loop below ends after a single read. */
+  unsigned long len = 0, allocated = BUFSIZ * 16;
+  if (!fseek (fp, 0, SEEK_END))
+  {
+    long size = ftell (fp);
+    if (size > 0 && (unsigned long) size < (2 << 28))
+      allocated = hb_max (allocated, (unsigned long) size + BUFSIZ);
+    rewind (fp);
+  }
+  char *data = _hb_blob_allocate_for_file (allocated, flags);
+  if (unlikely (!data)) goto fread_fail_without_data;
 
   while (!feof (fp))
   {
@@ -709,9 +832,90 @@ fail_without_close:
 			 (hb_destroy_func_t) free);
 
 fread_fail:
-  fclose (fp);
-fread_fail_without_close:
   free (data);
+fread_fail_without_data:
+  fclose (fp);
   return hb_blob_get_empty ();
 }
 #endif /* !HB_NO_OPEN */
+
+
+/*
+ * Paging hints.
+ */
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && defined(POSIX_MADV_WILLNEED) && \
+    !defined(HB_NO_OPEN) && !defined(HB_NO_MMAP)
+#define HB_BLOB_PAGING_HINTS 1
+#endif
+
+#ifdef HB_BLOB_PAGING_HINTS
+/* The blob of the file hb_blob_create_from_file() mapped that @blob's
+ * data lives in, or nullptr.  Hints on anything else would apply to
+ * whatever heap pages happen to surround it. */
+static const hb_blob_t *
+_hb_blob_get_mapped_file (const hb_blob_t *blob)
+{
+  while (blob->destroy == _hb_blob_destroy)
+    blob = (const hb_blob_t *) blob->user_data;
+  return blob->destroy == (hb_destroy_func_t) _hb_mapped_file_destroy ? blob : nullptr;
+}
+#endif
+
+void
+hb_blob_t::advise (advice_t advice) const
+{
+#ifdef HB_BLOB_PAGING_HINTS
+  const hb_blob_t *file = length ? _hb_blob_get_mapped_file (this) : nullptr;
+  if (!file) return;
+
+  uintptr_t pagesize = _hb_blob_get_pagesize ();
+  if (unlikely ((uintptr_t) -1L == pagesize)) return;
+
+  uintptr_t mask = ~(pagesize-1);
+  uintptr_t start = ((uintptr_t) data) & mask;
+  uintptr_t end = ((uintptr_t) data + length + pagesize-1) & mask;
+  int ret;
+
+  if (advice == ADVICE_DONTNEED)
+  {
+#ifdef MADV_DONTNEED
+    /* Only pages the file can give back unchanged: not those of a mapping
+     * made writable in place, and not those shared with neighboring data. */
+    if (file->mode == HB_MEMORY_MODE_WRITABLE) return;
+    start = ((uintptr_t) data + pagesize-1) & mask;
+    end = ((uintptr_t) data + length) & mask;
+    if (start >= end) return;
+    ret = madvise ((void *) start, end - start, MADV_DONTNEED);
+#else
+    return;
+#endif
+  }
+  else
+    ret = posix_madvise ((void *) start, end - start,
+			 advice == ADVICE_RANDOM ? POSIX_MADV_RANDOM : POSIX_MADV_WILLNEED);
+
+  DEBUG_MSG_FUNC (BLOB, this, "advice %d on [%p..%p] returned %d",
+		  advice, (void *) start, (void *) end, ret);
+  (void) ret;
+#endif
+}
+
+void
+hb_blob_t::prefault () const
+{
+#ifdef HB_BLOB_PAGING_HINTS
+  if (!length || !_hb_blob_get_mapped_file (this)) return;
+
+  uintptr_t pagesize = _hb_blob_get_pagesize ();
+  if (unlikely ((uintptr_t) -1L == pagesize)) return;
+
+  /* Read one byte per page; the mapping is read-only, so that is all it
+   * takes to bring a page in. */
+  const volatile char *p = data;
+  uintptr_t offset = pagesize - (((uintptr_t) data) & (pagesize-1));
+  (void) p[0];
+  for (; offset < length; offset += pagesize)
+    (void) p[offset];
+#endif
+}
@@ -74,6 +74,34 @@ hb_blob_create (const char        *data,
 HB_EXTERN hb_blob_t *
 hb_blob_create_from_file (const char *file_name);
 
+/**
+ * hb_blob_file_flags_t:
+ * @HB_BLOB_FILE_FLAG_DEFAULT: Map the file into memory where possible, and
+ *                             otherwise read it in.
+ * @HB_BLOB_FILE_FLAG_POPULATE: Read all of a mapped file in upfront, rather
+ *                              than page by page on first access.
+ * @HB_BLOB_FILE_FLAG_COPY: Read the file into memory instead of mapping it,
+ *                          with a single read sized from the file size.
+ * @HB_BLOB_FILE_FLAG_HUGE_PAGES: Back the copy of a large file with
+ *                                transparent huge pages, to lower TLB
+ *                                pressure.  Implies @HB_BLOB_FILE_FLAG_COPY.
+ *
+ * Flags for hb_blob_create_from_file_with_flags().  Those a platform does
+ * not support are ignored.
+ *
+ * Since: REPLACEME
+ **/
+typedef enum { /*< flags >*/
+  HB_BLOB_FILE_FLAG_DEFAULT		= 0x00000000u,
+  HB_BLOB_FILE_FLAG_POPULATE		= 0x00000001u,
+  HB_BLOB_FILE_FLAG_COPY		= 0x00000002u,
+  HB_BLOB_FILE_FLAG_HUGE_PAGES		= 0x00000004u
+} hb_blob_file_flags_t;
+
+HB_EXTERN hb_blob_t *
+hb_blob_create_from_file_with_flags (const char           *file_name,
+				     hb_blob_file_flags_t  flags);
+
 /* Always creates with MEMORY_MODE_READONLY.
  * Even if the parent blob is writable, we don't
  * want the user of the sub-blob to be able to
@@ -54,10 +54,29 @@ struct hb_blob_t
   HB_INTERNAL bool try_make_writable_inplace ();
   HB_INTERNAL bool try_make_writable_inplace_unix ();
 
+  /* Paging hints for blobs backed by a file hb_blob_create_from_file()
+   * mapped; no-ops for any other blob. */
+  enum advice_t {
+    ADVICE_WILLNEED,	/* Will be read soon; start reading ahead. */
+    ADVICE_RANDOM,	/* Read sparsely; don't read ahead. */
+    ADVICE_DONTNEED,	/* Not needed for now; drop from memory. */
+  };
+  HB_INTERNAL void advise (advice_t advice) const;
+  /* Touches every page, blocking until all are resident. */
+  HB_INTERNAL void prefault () const;
+
   hb_bytes_t as_bytes () const { return hb_bytes_t (data, length); }
   template <typename Type>
   const Type* as () const { return as_bytes ().as<Type> (); }
 
+  /* The blob object, plus its data if the blob owns a malloc()ed copy,
+   * as made by try_make_writable(). */
+  unsigned int get_memory_usage () const
+  {
+    return sizeof (*this) +
+	   (destroy == (hb_destroy_func_t) free && user_data == data ? length : 0);
+  }
+
   public:
   hb_object_header_t header;
 
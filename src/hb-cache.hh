@@ -77,4 +77,107 @@ typedef hb_cache_t<21, 16, 8> hb_cmap_cache_t;
 typedef hb_cache_t<16, 24, 8> hb_advance_cache_t;
 
 
+/* Implements a lock-free, lazily allocated cache of one Type per glyph,
+ * holding at most max_bytes worth of items.  Space is reserved before an
+ * item is built, so that concurrent fills can't overshoot the cap.  Type
+ * must provide a static destroy() that frees an item. */
+
+template <typename Type, unsigned int max_bytes>
+struct hb_glyph_cache_t
+{
+  typedef hb_atomic_ptr_t<Type> slot_t;
+
+  void init (unsigned int num_glyphs_)
+  {
+    num_glyphs = num_glyphs_;
+    slots.init ();
+    used_bytes.set_relaxed (0);
+  }
+
+  void fini ()
+  {
+    slot_t *s = slots.get ();
+    if (s)
+    {
+      for (unsigned int i = 0; i < num_glyphs; i++)
+      {
+	Type *item = s[i].get ();
+	if (item) Type::destroy (item);
+      }
+      free (s);
+    }
+    init (0);
+  }
+
+  const Type *get (hb_codepoint_t glyph) const
+  {
+    const slot_t *s = slots.get ();
+    if (!s || glyph >= num_glyphs) return nullptr;
+    return s[glyph].get ();
+  }
+
+  /* Reserves size bytes for an item of glyph.  On success, the caller must
+   * either set() the item or release() the space. */
+  bool reserve (hb_codepoint_t glyph, unsigned int size) const
+  {
+    if (unlikely (glyph >= num_glyphs || size > max_bytes)) return false;
+    if ((unsigned int) used_bytes.add (size) + size > max_bytes)
+    {
+      release (size);
+      return false;
+    }
+    if (unlikely (!get_slots ()))
+    {
+      release (size);
+      return false;
+    }
+    return true;
+  }
+
+  void release (unsigned int size) const { used_bytes.add (-(int) size); }
+
+  /* Publishes item, for which size bytes were reserved, and takes ownership
+   * of it.  If another thread beat us to it, item is destroyed and theirs
+   * is returned. */
+  const Type *set (hb_codepoint_t glyph, Type *item, unsigned int size) const
+  {
+    slot_t *s = slots.get ();
+    if (unlikely (!s[glyph].cmpexch (nullptr, item)))
+    {
+      Type::destroy (item);
+      release (size);
+      return s[glyph].get ();
+    }
+    return item;
+  }
+
+  unsigned int get_used_bytes () const { return used_bytes.get_relaxed (); }
+
+  unsigned int get_memory_usage () const
+  { return (slots.get () ? num_glyphs * sizeof (slot_t) : 0) + get_used_bytes (); }
+
+  private:
+  slot_t *get_slots () const
+  {
+  retry:
+    slot_t *s = slots.get ();
+    if (unlikely (!s))
+    {
+      s = (slot_t *) calloc (num_glyphs, sizeof (slot_t));
+      if (unlikely (!s)) return nullptr;
+      if (unlikely (!slots.cmpexch (nullptr, s)))
+      {
+	free (s);
+	goto retry;
+      }
+    }
+    return s;
+  }
+
+  unsigned int num_glyphs;
+  hb_atomic_ptr_t<slot_t> slots;
+  mutable hb_atomic_int_t used_bytes;
+};
+
+
 #endif /* HB_CACHE_HH */
@@ -579,6 +579,7 @@ struct parsed_values_t
   }
 
   unsigned get_count () const { return values.length; }
+  unsigned get_memory_usage () const { return values.get_allocated_size (); }
   const VAL &get_value (unsigned int i)   const { return values[i]; }
   const VAL &operator [] (unsigned int i) const { return get_value (i); }
 
@@ -28,6 +28,7 @@
 
 #include "hb.hh"
 #include "hb-cff-interp-common.hh"
+#include "hb-cache.hh"
 
 namespace CFF {
 
@@ -115,6 +116,178 @@ struct point_t
   number_t  y;
 };
 
+struct bounds_t
+{
+  void init ()
+  {
+    min.set_int (INT_MAX, INT_MAX);
+    max.set_int (INT_MIN, INT_MIN);
+  }
+
+  void update (const point_t &pt)
+  {
+    if (pt.x < min.x) min.x = pt.x;
+    if (pt.x > max.x) max.x = pt.x;
+    if (pt.y < min.y) min.y = pt.y;
+    if (pt.y > max.y) max.y = pt.y;
+  }
+
+  void merge (const bounds_t &b)
+  {
+    if (empty ())
+      *this = b;
+    else if (!b.empty ())
+    {
+      if (b.min.x < min.x) min.x = b.min.x;
+      if (b.max.x > max.x) max.x = b.max.x;
+      if (b.min.y < min.y) min.y = b.min.y;
+      if (b.max.y > max.y) max.y = b.max.y;
+    }
+  }
+
+  void offset (const point_t &delta)
+  {
+    if (!empty ())
+    {
+      min.move (delta);
+      max.move (delta);
+    }
+  }
+
+  bool empty () const { return (min.x >= max.x) || (min.y >= max.y); }
+
+  point_t min;
+  point_t max;
+};
+
+/* A charstring decoded into path operations in font units, along with its
+ * bounds.  Replaying it is much cheaper than running the Type2 interpreter,
+ * which has to resolve subroutines and rebuild the argument stack. */
+struct cs_outline_t
+{
+  enum op_t
+  {
+    OP_MOVE_TO,
+    OP_LINE_TO,
+    OP_CUBIC_TO,
+    OP_END_PATH
+  };
+
+  void init ()
+  {
+    ops.init ();
+    points.init ();
+    bounds.init ();
+    has_seac = false;
+  }
+
+  void fini ()
+  {
+    ops.fini ();
+    points.fini ();
+  }
+
+  void move_to (const point_t &pt) { ops.push (OP_MOVE_TO); points.push (pt); }
+  void line_to (const point_t &pt) { ops.push (OP_LINE_TO); points.push (pt); }
+  void cubic_to (const point_t &pt1, const point_t &pt2, const point_t &pt3)
+  {
+    ops.push (OP_CUBIC_TO);
+    points.push (pt1);
+    points.push (pt2);
+    points.push (pt3);
+  }
+  void end_path () { ops.push (OP_END_PATH); }
+
+  /* Appends the path of a seac component, shifted by delta. */
+  void append (const cs_outline_t &other, const point_t *delta = nullptr)
+  {
+    for (unsigned int i = 0; i < other.ops.length; i++)
+      ops.push (other.ops[i]);
+    for (unsigned int i = 0; i < other.points.length; i++)
+    {
+      point_t pt = other.points[i];
+      if (delta) pt.move (*delta);
+      points.push (pt);
+    }
+  }
+
+  template <typename SINK>
+  void replay (SINK &sink) const
+  {
+    const point_t *pt = points.arrayZ;
+    for (unsigned int i = 0; i < ops.length; i++)
+      switch (ops[i])
+      {
+      case OP_MOVE_TO:  sink.move_to (pt[0]); pt += 1; break;
+      case OP_LINE_TO:  sink.line_to (pt[0]); pt += 1; break;
+      case OP_CUBIC_TO: sink.cubic_to (pt[0], pt[1], pt[2]); pt += 3; break;
+      case OP_END_PATH: sink.end_path (); break;
+      default: break;
+      }
+  }
+
+  bool in_error () const { return ops.in_error () || points.in_error (); }
+
+  static void destroy (cs_outline_t *outline)
+  {
+    outline->fini ();
+    free (outline);
+  }
+
+  unsigned int get_size () const
+  { return sizeof (*this) + ops.get_size () + points.get_size (); }
+
+  hb_vector_t<uint8_t>	ops;
+  hb_vector_t<point_t>	points;
+  bounds_t		bounds;
+  bool			has_seac;
+};
+
+#ifndef HB_CFF_OUTLINE_CACHE_MAX_BYTES
+#define HB_CFF_OUTLINE_CACHE_MAX_BYTES (8u << 20)
+#endif
+
+/* Per-face cache of decoded charstrings, filled lazily and lock-free.
+ * Once HB_CFF_OUTLINE_CACHE_MAX_BYTES worth of outlines are cached, the
+ * remaining glyphs are interpreted on every call as before. */
+struct cs_outline_cache_t
+{
+  void init (unsigned int num_glyphs) { cache.init (num_glyphs); }
+  void fini () { cache.fini (); }
+
+  const cs_outline_t *get (hb_codepoint_t glyph) const { return cache.get (glyph); }
+
+  /* Moves outline into the cache.  Returns the cached copy, or nullptr if
+   * the glyph could not be cached, in which case outline is left as is. */
+  const cs_outline_t *set (hb_codepoint_t glyph, cs_outline_t &outline) const
+  {
+    if (unlikely (outline.in_error ())) return nullptr;
+
+    unsigned int size = outline.get_size ();
+    if (!cache.reserve (glyph, size)) return nullptr;
+
+    cs_outline_t *p = (cs_outline_t *) calloc (1, sizeof (cs_outline_t));
+    if (unlikely (!p))
+    {
+      cache.release (size);
+      return nullptr;
+    }
+    p->init ();
+    p->ops = hb_move (outline.ops);
+    p->points = hb_move (outline.points);
+    p->bounds = outline.bounds;
+    p->has_seac = outline.has_seac;
+
+    return cache.set (glyph, p, size);
+  }
+
+  unsigned int get_used_bytes () const { return cache.get_used_bytes (); }
+  unsigned int get_memory_usage () const { return cache.get_memory_usage (); }
+
+  private:
+  hb_glyph_cache_t<cs_outline_t, HB_CFF_OUTLINE_CACHE_MAX_BYTES> cache;
+};
+
 template <typename ARG, typename SUBRS>
 struct cs_interp_env_t : interp_env_t<ARG>
 {
@@ -884,6 +1057,62 @@ struct path_procs_t
   }
 };
 
+/* Records the path of a charstring into a cs_outline_t, keeping track of
+ * its bounds the same way extents are computed. */
+struct cs_outline_param_t
+{
+  void init (cs_outline_t *outline_)
+  {
+    outline = outline_;
+    path_open = false;
+  }
+
+  void start_path   ()       { path_open = true; }
+  void end_path     ()       { path_open = false; }
+  bool is_path_open () const { return path_open; }
+
+  cs_outline_t *outline;
+  bool path_open;
+};
+
+template <typename ENV, typename PARAM>
+struct path_procs_outline_t : path_procs_t<path_procs_outline_t<ENV, PARAM>, ENV, PARAM>
+{
+  static void moveto (ENV &env, PARAM& param, const point_t &pt)
+  {
+    param.end_path ();
+    param.outline->move_to (pt);
+    env.moveto (pt);
+  }
+
+  static void line (ENV &env, PARAM& param, const point_t &pt1)
+  {
+    if (!param.is_path_open ())
+    {
+      param.start_path ();
+      param.outline->bounds.update (env.get_pt ());
+    }
+    param.outline->line_to (pt1);
+    env.moveto (pt1);
+    param.outline->bounds.update (env.get_pt ());
+  }
+
+  static void curve (ENV &env, PARAM& param, const point_t &pt1, const point_t &pt2, const point_t &pt3)
+  {
+    if (!param.is_path_open ())
+    {
+      param.start_path ();
+      param.outline->bounds.update (env.get_pt ());
+    }
+    param.outline->cubic_to (pt1, pt2, pt3);
+    /* include control points */
+    param.outline->bounds.update (pt1);
+    param.outline->bounds.update (pt2);
+    env.moveto (pt3);
+    param.outline->bounds.update (env.get_pt ());
+  }
+};
+
 template <typename ENV, typename OPSET, typename PARAM>
 struct cs_interpreter_t : interpreter_t<ENV>
 {
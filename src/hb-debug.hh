@@ -381,6 +381,10 @@ struct hb_no_trace_t {
 #define HB_DEBUG_SHAPE_PLAN (HB_DEBUG+0)
 #endif
 
+#ifndef HB_DEBUG_SUBSET_REPACK
+#define HB_DEBUG_SUBSET_REPACK (HB_DEBUG+0)
+#endif
+
 #ifndef HB_DEBUG_UNISCRIBE
 #define HB_DEBUG_UNISCRIBE (HB_DEBUG+0)
 #endif
@@ -139,6 +139,49 @@ _cubic_to_nil (hb_position_t control1_x HB_UNUSED, hb_position_t control1_y HB_U
 static void
 _close_path_nil (void *user_data HB_UNUSED) {}
 
+/**
+ * hb_draw_funcs_set_lines_to_func:
+ * @funcs: draw functions object
+ * @lines_to: lines-to callback
+ *
+ * Sets lines-to callback to the draw functions object.  When set, it is
+ * called instead of the line-to callback, with runs of consecutive line
+ * segments: @points holds @count x, y pairs, each the end of a line from
+ * the previous point, the first one starting at the current point.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_draw_funcs_set_lines_to_func (hb_draw_funcs_t          *funcs,
+				 hb_draw_lines_to_func_t   lines_to)
+{
+  if (unlikely (hb_object_is_immutable (funcs))) return;
+  funcs->lines_to = lines_to;
+}
+
+/**
+ * hb_draw_funcs_set_flatten_tolerance:
+ * @funcs: draw functions object
+ * @tolerance: maximum distance from a curve to its flattened lines, or 0
+ *
+ * Makes drawing with @funcs flatten curves into line segments that stay
+ * within @tolerance, in font scale units, of the curve; the quadratic-to
+ * and cubic-to callbacks are then not called.  Combined with
+ * hb_draw_funcs_set_lines_to_func(), a whole contour reaches the callbacks
+ * in a few batches of lines.
+ *
+ * Passing 0, the default, disables flattening.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_draw_funcs_set_flatten_tolerance (hb_draw_funcs_t *funcs,
+				     float            tolerance)
+{
+  if (unlikely (hb_object_is_immutable (funcs))) return;
+  funcs->tolerance = tolerance > 0.f ? tolerance : 0.f;
+}
+
 /**
  * hb_draw_funcs_create:
  *
@@ -159,6 +202,8 @@ hb_draw_funcs_create ()
   funcs->is_quadratic_to_set = false;
   funcs->cubic_to = (hb_draw_cubic_to_func_t) _cubic_to_nil;
   funcs->close_path = (hb_draw_close_path_func_t) _close_path_nil;
+  funcs->lines_to = nullptr;
+  funcs->tolerance = 0.f;
   return funcs;
 }
 
@@ -226,6 +271,34 @@ hb_draw_funcs_is_immutable (hb_draw_funcs_t *funcs)
   return hb_object_is_immutable (funcs);
 }
 
+static bool
+_hb_font_draw_glyph (hb_font_t *font, hb_codepoint_t glyph,
+		     draw_helper_t &draw_helper,
+		     OT::glyf::points_scratch_t &scratch)
+{
+  hb_ot_face_reader_t reader (font->face->table);
+  if (font->face->table.glyf->get_path (font, glyph, draw_helper, scratch)) return true;
+#ifndef HB_NO_CFF
+  if (font->face->table.cff1->get_path (font, glyph, draw_helper)) return true;
+  if (font->face->table.cff2->get_path (font, glyph, draw_helper)) return true;
+#endif
+
+  return false;
+}
+
+static bool
+_hb_font_draw_glyph (hb_font_t *font, hb_codepoint_t glyph,
+		     const hb_draw_funcs_t *funcs,
+		     void *user_data)
+{
+  draw_helper_t draw_helper (funcs, user_data);
+  OT::glyf::points_scratch_t scratch;
+  scratch.init ();
+  bool ret = _hb_font_draw_glyph (font, glyph, draw_helper, scratch);
+  scratch.fini ();
+  return ret;
+}
+
 /**
  * hb_font_draw_glyph:
  * @font: a font object
@@ -247,14 +320,351 @@ hb_font_draw_glyph (hb_font_t *font, hb_codepoint_t glyph,
 		glyph >= font->face->get_num_glyphs ()))
     return false;
 
+  if (font->draw_cache)
+    return font->draw_cache->draw (font, glyph, funcs, user_data);
+
+  return _hb_font_draw_glyph (font, glyph, funcs, user_data);
+}
+
+/**
+ * hb_font_draw_glyphs:
+ * @font: a font object
+ * @count: number of glyphs to draw
+ * @first_glyph: the first glyph id to draw
+ * @glyph_stride: the stride between successive glyph ids
+ * @first_x: the x position of the first glyph
+ * @x_stride: the stride between successive x positions
+ * @first_y: the y position of the first glyph
+ * @y_stride: the stride between successive y positions
+ * @funcs: draw callbacks object
+ * @user_data: parameter you like be passed to the callbacks when are called
+ *
+ * Draws a run of glyphs, each offset by its position, as one stream of
+ * draw calls.  The result is the same as calling hb_font_draw_glyph() for
+ * each glyph and translating its output, but the memory used to load
+ * glyph outlines is shared by the whole run.
+ *
+ * Glyphs that can't be drawn are skipped.
+ *
+ * Returns: Whether all glyphs were drawn successfully.
+ * Since: EXPERIMENTAL
+ **/
+hb_bool_t
+hb_font_draw_glyphs (hb_font_t *font,
+		     unsigned int count,
+		     const hb_codepoint_t *first_glyph,
+		     unsigned int glyph_stride,
+		     const hb_position_t *first_x,
+		     unsigned int x_stride,
+		     const hb_position_t *first_y,
+		     unsigned int y_stride,
+		     const hb_draw_funcs_t *funcs,
+		     void *user_data)
+{
+  if (unlikely (funcs == &Null (hb_draw_funcs_t)))
+    return false;
+
+  unsigned int num_glyphs = font->face->get_num_glyphs ();
+  hb_draw_cache_t *cache = font->draw_cache;
+  bool ret = true;
+
   draw_helper_t draw_helper (funcs, user_data);
-  if (font->face->table.glyf->get_path (font, glyph, draw_helper)) return true;
-#ifndef HB_NO_CFF
-  if (font->face->table.cff1->get_path (font, glyph, draw_helper)) return true;
-  if (font->face->table.cff2->get_path (font, glyph, draw_helper)) return true;
-#endif
+  OT::glyf::points_scratch_t scratch;
+  scratch.init ();
+  for (unsigned int i = 0; i < count; i++)
+  {
+    hb_codepoint_t glyph = *first_glyph;
+    hb_position_t x = *first_x;
+    hb_position_t y = *first_y;
+    first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+    first_x = &StructAtOffsetUnaligned<hb_position_t> (first_x, x_stride);
+    first_y = &StructAtOffsetUnaligned<hb_position_t> (first_y, y_stride);
 
-  return false;
+    if (unlikely (glyph >= num_glyphs))
+    {
+      ret = false;
+      continue;
+    }
+
+    if (cache)
+    {
+      ret = cache->draw (font, glyph, funcs, user_data, x, y) && ret;
+      continue;
+    }
+
+    draw_helper.set_origin (x, y);
+    ret = _hb_font_draw_glyph (font, glyph, draw_helper, scratch) && ret;
+  }
+  draw_helper.end_path ();
+  scratch.fini ();
+
+  return ret;
+}
+
+
+/*
+ * Outline cache.
+ */
+
+static void
+_hb_draw_cache_record_move_to (hb_position_t to_x, hb_position_t to_y,
+			       hb_vector_t<hb_position_t> *commands)
+{
+  *commands << hb_draw_cache_t::OP_MOVE_TO << to_x << to_y;
+}
+
+static void
+_hb_draw_cache_record_line_to (hb_position_t to_x, hb_position_t to_y,
+			       hb_vector_t<hb_position_t> *commands)
+{
+  *commands << hb_draw_cache_t::OP_LINE_TO << to_x << to_y;
+}
+
+static void
+_hb_draw_cache_record_quadratic_to (hb_position_t control_x, hb_position_t control_y,
+				    hb_position_t to_x, hb_position_t to_y,
+				    hb_vector_t<hb_position_t> *commands)
+{
+  *commands << hb_draw_cache_t::OP_QUADRATIC_TO
+	    << control_x << control_y << to_x << to_y;
+}
+
+static void
+_hb_draw_cache_record_cubic_to (hb_position_t control1_x, hb_position_t control1_y,
+				hb_position_t control2_x, hb_position_t control2_y,
+				hb_position_t to_x, hb_position_t to_y,
+				hb_vector_t<hb_position_t> *commands)
+{
+  *commands << hb_draw_cache_t::OP_CUBIC_TO
+	    << control1_x << control1_y << control2_x << control2_y << to_x << to_y;
+}
+
+static void
+_hb_draw_cache_record_close_path (hb_vector_t<hb_position_t> *commands)
+{
+  *commands << hb_draw_cache_t::OP_CLOSE_PATH;
+}
+
+bool
+hb_draw_cache_t::instance_t::matches (const hb_font_t *font) const
+{
+  return x_scale == font->x_scale &&
+	 y_scale == font->y_scale &&
+	 coords.as_array () == hb_array (font->coords, font->num_coords);
+}
+
+void
+hb_draw_cache_t::reset ()
+{
+  for (auto _ : paths.values ())
+    free (_);
+  paths.reset ();
+  instances.fini_deep ();
+  size = 0;
+}
+
+unsigned int
+hb_draw_cache_t::get_memory_usage ()
+{
+  hb_lock_t l (lock);
+  unsigned int usage = sizeof (*this) + size + instances.get_allocated_size ();
+  for (unsigned int i = 0; i < instances.length; i++)
+    usage += instances[i].coords.get_allocated_size ();
+  return usage;
+}
+
+const hb_draw_cache_t::path_t *
+hb_draw_cache_t::find (hb_font_t *font, hb_codepoint_t glyph, unsigned int *instance)
+{
+  hb_lock_t l (lock);
+
+  for (unsigned int i = 0; i < instances.length; i++)
+    if (instances[i].matches (font))
+    {
+      *instance = i;
+      return paths.get ((i << 16) | glyph);
+    }
+  *instance = (unsigned int) -1;
+  return nullptr;
+}
+
+const hb_draw_cache_t::path_t *
+hb_draw_cache_t::add (hb_font_t *font, hb_codepoint_t glyph,
+		      const hb_vector_t<hb_position_t> &commands)
+{
+  unsigned int path_size = sizeof (path_t) + commands.get_size ();
+
+  hb_lock_t l (lock);
+
+  if (size + path_size > max_size) return nullptr;
+
+  unsigned int i;
+  for (i = 0; i < instances.length; i++)
+    if (instances[i].matches (font))
+      break;
+  if (i == instances.length)
+  {
+    if (instances.length >= HB_DRAW_CACHE_MAX_INSTANCES) return nullptr;
+    instance_t *instance = instances.push ();
+    if (unlikely (instances.in_error ())) return nullptr;
+    instance->x_scale = font->x_scale;
+    instance->y_scale = font->y_scale;
+    instance->coords.init ();
+    for (unsigned int j = 0; j < font->num_coords; j++)
+      instance->coords.push (font->coords[j]);
+    if (unlikely (instance->coords.in_error ()))
+    {
+      instance->fini ();
+      instances.pop ();
+      return nullptr;
+    }
+  }
+
+  unsigned int key = (i << 16) | glyph;
+  path_t *path = paths.get (key);
+  if (path) return path; /* Another thread beat us to it. */
+
+  path = (path_t *) malloc (path_size);
+  if (unlikely (!path)) return nullptr;
+  path->length = commands.length;
+  memcpy (path->commands, commands.arrayZ, commands.get_size ());
+
+  paths.set (key, path);
+  if (unlikely (!paths.successful))
+  {
+    free (path);
+    return nullptr;
+  }
+  size += path_size;
+
+  return path;
+}
+
+bool
+hb_draw_cache_t::draw (hb_font_t *font, hb_codepoint_t glyph,
+		       const hb_draw_funcs_t *funcs, void *user_data,
+		       hb_position_t x, hb_position_t y)
+{
+  unsigned int instance;
+  const path_t *path = glyph < 0x10000u ? find (font, glyph, &instance) : nullptr;
+  if (path)
+  {
+    replay (path->commands, path->length, funcs, user_data, x, y);
+    return true;
+  }
+
+  hb_draw_funcs_t record_funcs;
+  record_funcs.move_to = (hb_draw_move_to_func_t) _hb_draw_cache_record_move_to;
+  record_funcs.line_to = (hb_draw_line_to_func_t) _hb_draw_cache_record_line_to;
+  record_funcs.quadratic_to = (hb_draw_quadratic_to_func_t) _hb_draw_cache_record_quadratic_to;
+  record_funcs.is_quadratic_to_set = true;
+  record_funcs.cubic_to = (hb_draw_cubic_to_func_t) _hb_draw_cache_record_cubic_to;
+  record_funcs.close_path = (hb_draw_close_path_func_t) _hb_draw_cache_record_close_path;
+  record_funcs.lines_to = nullptr;
+  record_funcs.tolerance = 0.f;
+
+  hb_vector_t<hb_position_t> commands;
+  if (!_hb_font_draw_glyph (font, glyph, &record_funcs, &commands))
+    return false;
+  if (unlikely (commands.in_error ()))
+  {
+    draw_helper_t draw_helper (funcs, user_data);
+    draw_helper.set_origin (x, y);
+    OT::glyf::points_scratch_t scratch;
+    scratch.init ();
+    bool ret = _hb_font_draw_glyph (font, glyph, draw_helper, scratch);
+    scratch.fini ();
+    return ret;
+  }
+
+  if (glyph < 0x10000u)
+    add (font, glyph, commands);
+
+  replay (commands.arrayZ, commands.length, funcs, user_data, x, y);
+  return true;
+}
+
+/* Feeds the recording back through a draw_helper_t, which calls funcs the
+ * way drawing the glyph would have: converting or flattening curves as
+ * funcs asks.  Everything is offset by (x, y). */
+void
+hb_draw_cache_t::replay (const hb_position_t *commands, unsigned int length,
+			 const hb_draw_funcs_t *funcs, void *user_data,
+			 hb_position_t x, hb_position_t y)
+{
+  draw_helper_t draw_helper (funcs, user_data);
+  draw_helper.set_origin (x, y);
+  const hb_position_t *end = commands + length;
+  while (commands < end)
+    switch (*commands++)
+    {
+    case OP_MOVE_TO:
+      draw_helper.move_to (commands[0], commands[1]);
+      commands += 2;
+      break;
+    case OP_LINE_TO:
+      draw_helper.line_to (commands[0], commands[1]);
+      commands += 2;
+      break;
+    case OP_QUADRATIC_TO:
+      draw_helper.quadratic_to (commands[0], commands[1], commands[2], commands[3]);
+      commands += 4;
+      break;
+    case OP_CUBIC_TO:
+      draw_helper.cubic_to (commands[0], commands[1], commands[2], commands[3],
+			    commands[4], commands[5]);
+      commands += 6;
+      break;
+    case OP_CLOSE_PATH:
+      draw_helper.end_path ();
+      break;
+    default:
+      return;
+    }
+}
+
+void
+hb_draw_cache_destroy (hb_draw_cache_t *cache)
+{
+  if (!cache) return;
+  cache->fini ();
+  free (cache);
+}
+
+/**
+ * hb_font_set_draw_cache_size:
+ * @font: a font object
+ * @max_size: maximum number of bytes of outlines to keep, or 0
+ *
+ * Enables caching of glyph outlines drawn with hb_font_draw_glyph() on
+ * @font.  The first time a glyph is drawn its outline is recorded; later
+ * calls, with any draw functions, replay the recording instead of parsing
+ * the glyph again.  Outlines are kept separately for each scale and set of
+ * variation coordinates the font is drawn at, up to @max_size bytes in
+ * total; glyphs drawn after that are not cached.
+ *
+ * Passing 0 disables the cache.  Any call drops the outlines cached so far.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_font_set_draw_cache_size (hb_font_t    *font,
+			     unsigned int  max_size)
+{
+  if (hb_object_is_immutable (font))
+    return;
+
+  hb_draw_cache_destroy (font->draw_cache);
+  font->draw_cache = nullptr;
+
+  if (!max_size)
+    return;
+
+  hb_draw_cache_t *cache = (hb_draw_cache_t *) calloc (1, sizeof (hb_draw_cache_t));
+  if (unlikely (!cache))
+    return;
+  cache->init (max_size);
+  font->draw_cache = cache;
 }
 
 #endif
@@ -44,6 +44,8 @@ typedef void (*hb_draw_cubic_to_func_t) (hb_position_t control1_x, hb_position_t
 					 hb_position_t to_x, hb_position_t to_y,
 					 void *user_data);
 typedef void (*hb_draw_close_path_func_t) (void *user_data);
+typedef void (*hb_draw_lines_to_func_t) (const hb_position_t *points, unsigned int count,
+					 void *user_data);
 
 /**
  * hb_draw_funcs_t:
@@ -77,6 +79,14 @@ HB_EXTERN void
 hb_draw_funcs_set_close_path_func (hb_draw_funcs_t           *funcs,
 				   hb_draw_close_path_func_t  close_path);
 
+HB_EXTERN void
+hb_draw_funcs_set_lines_to_func (hb_draw_funcs_t          *funcs,
+				 hb_draw_lines_to_func_t   lines_to);
+
+HB_EXTERN void
+hb_draw_funcs_set_flatten_tolerance (hb_draw_funcs_t *funcs,
+				     float            tolerance);
+
 HB_EXTERN hb_draw_funcs_t *
 hb_draw_funcs_create (void);
 
@@ -26,6 +26,7 @@
 #define HB_DRAW_HH
 
 #include "hb.hh"
+#include "hb-map.hh"
 
 #ifdef HB_EXPERIMENTAL_API
 struct hb_draw_funcs_t
@@ -38,8 +39,18 @@ struct hb_draw_funcs_t
   bool is_quadratic_to_set;
   hb_draw_cubic_to_func_t cubic_to;
   hb_draw_close_path_func_t close_path;
+  hb_draw_lines_to_func_t lines_to;
+  float tolerance;
 };
 
+#ifndef HB_DRAW_LINES_BATCH
+#define HB_DRAW_LINES_BATCH 64
+#endif
+
+#ifndef HB_DRAW_FLATTEN_MAX_SEGMENTS
+#define HB_DRAW_FLATTEN_MAX_SEGMENTS 128
+#endif
+
 struct draw_helper_t
 {
   draw_helper_t (const hb_draw_funcs_t *funcs_, void *user_data_)
@@ -48,9 +59,19 @@ struct draw_helper_t
     user_data = user_data_;
     path_open = false;
     path_start_x = current_x = path_start_y = current_y = 0;
+    origin_x = origin_y = 0;
+    num_lines = 0;
   }
   ~draw_helper_t () { end_path (); }
 
+  /* Offsets everything drawn from now on by (x, y); closes any open path. */
+  void set_origin (hb_position_t x, hb_position_t y)
+  {
+    end_path ();
+    origin_x = x;
+    origin_y = y;
+  }
+
   void move_to (hb_position_t x, hb_position_t y)
   {
     if (path_open) end_path ();
@@ -62,7 +83,7 @@ struct draw_helper_t
   {
     if (equal_to_current (x, y)) return;
     if (!path_open) start_path ();
-    funcs->line_to (x, y, user_data);
+    emit_line (x, y);
     current_x = x;
     current_y = y;
   }
@@ -74,14 +95,21 @@ struct draw_helper_t
     if (equal_to_current (control_x, control_y) && equal_to_current (to_x, to_y))
       return;
     if (!path_open) start_path ();
-    if (funcs->is_quadratic_to_set)
-      funcs->quadratic_to (control_x, control_y, to_x, to_y, user_data);
+    if (funcs->tolerance > 0.f)
+      flatten_quadratic (control_x, control_y, to_x, to_y);
     else
-      funcs->cubic_to (roundf ((current_x + 2.f * control_x) / 3.f),
-		       roundf ((current_y + 2.f * control_y) / 3.f),
-		       roundf ((to_x + 2.f * control_x) / 3.f),
-		       roundf ((to_y + 2.f * control_y) / 3.f),
-		       to_x, to_y, user_data);
+    {
+      flush_lines ();
+      if (funcs->is_quadratic_to_set)
+	funcs->quadratic_to (origin_x + control_x, origin_y + control_y,
+			     origin_x + to_x, origin_y + to_y, user_data);
+      else
+	funcs->cubic_to (origin_x + roundf ((current_x + 2.f * control_x) / 3.f),
+			 origin_y + roundf ((current_y + 2.f * control_y) / 3.f),
+			 origin_x + roundf ((to_x + 2.f * control_x) / 3.f),
+			 origin_y + roundf ((to_y + 2.f * control_y) / 3.f),
+			 origin_x + to_x, origin_y + to_y, user_data);
+    }
     current_x = to_x;
     current_y = to_y;
   }
@@ -96,7 +124,15 @@ struct draw_helper_t
 	equal_to_current (to_x, to_y))
       return;
     if (!path_open) start_path ();
-    funcs->cubic_to (control1_x, control1_y, control2_x, control2_y, to_x, to_y, user_data);
+    if (funcs->tolerance > 0.f)
+      flatten_cubic (control1_x, control1_y, control2_x, control2_y, to_x, to_y);
+    else
+    {
+      flush_lines ();
+      funcs->cubic_to (origin_x + control1_x, origin_y + control1_y,
+		       origin_x + control2_x, origin_y + control2_y,
+		       origin_x + to_x, origin_y + to_y, user_data);
+    }
     current_x = to_x;
     current_y = to_y;
   }
@@ -106,7 +142,8 @@ struct draw_helper_t
     if (path_open)
     {
       if ((path_start_x != current_x) || (path_start_y != current_y))
-	funcs->line_to (path_start_x, path_start_y, user_data);
+	emit_line (path_start_x, path_start_y);
+      flush_lines ();
       funcs->close_path (user_data);
     }
     path_open = false;
@@ -117,11 +154,102 @@ struct draw_helper_t
   bool equal_to_current (hb_position_t x, hb_position_t y)
   { return current_x == x && current_y == y; }
 
+  /* Lines go to lines_to in batches if it's set, to line_to otherwise. */
+  void emit_line (hb_position_t x, hb_position_t y)
+  {
+    if (!funcs->lines_to)
+    {
+      funcs->line_to (origin_x + x, origin_y + y, user_data);
+      return;
+    }
+    if (num_lines == HB_DRAW_LINES_BATCH) flush_lines ();
+    lines[2 * num_lines] = origin_x + x;
+    lines[2 * num_lines + 1] = origin_y + y;
+    num_lines++;
+  }
+
+  void flush_lines ()
+  {
+    if (!num_lines) return;
+    funcs->lines_to (lines, num_lines, user_data);
+    num_lines = 0;
+  }
+
+  /* Number of chords needed to keep a curve within tolerance; dd is the
+   * largest second difference of its control points, and scale is
+   * d (d - 1) / 8 for a curve of degree d (Wang's formula). */
+  unsigned int flatten_segments (float ddx, float ddy, float scale) const
+  {
+    float n = ceilf (sqrtf (scale * sqrtf (ddx * ddx + ddy * ddy) / funcs->tolerance));
+    return (unsigned int) hb_clamp (n, 1.f, (float) HB_DRAW_FLATTEN_MAX_SEGMENTS);
+  }
+
+  /* Emits the points of a curve after the current point, skipping the
+   * ones that round to the previous point.  The end point is always
+   * emitted exactly. */
+  void emit_flattened (const float *xs, const float *ys, unsigned int n,
+		       hb_position_t to_x, hb_position_t to_y)
+  {
+    hb_position_t last_x = current_x, last_y = current_y;
+    for (unsigned int i = 1; i < n; i++)
+    {
+      hb_position_t x = roundf (xs[i]), y = roundf (ys[i]);
+      if (x == last_x && y == last_y) continue;
+      emit_line (x, y);
+      last_x = x;
+      last_y = y;
+    }
+    if (to_x != last_x || to_y != last_y)
+      emit_line (to_x, to_y);
+  }
+
+  void flatten_quadratic (hb_position_t control_x, hb_position_t control_y,
+			  hb_position_t to_x, hb_position_t to_y)
+  {
+    float x0 = current_x, y0 = current_y;
+    unsigned int n = flatten_segments (x0 - 2.f * control_x + to_x,
+				       y0 - 2.f * control_y + to_y, .25f);
+
+    /* Evaluated at evenly spaced t, independently for each point. */
+    float xs[HB_DRAW_FLATTEN_MAX_SEGMENTS], ys[HB_DRAW_FLATTEN_MAX_SEGMENTS];
+    float step = 1.f / n;
+    for (unsigned int i = 1; i < n; i++)
+    {
+      float t = i * step, mt = 1.f - t;
+      float a = mt * mt, b = 2.f * mt * t, c = t * t;
+      xs[i] = a * x0 + b * control_x + c * to_x;
+      ys[i] = a * y0 + b * control_y + c * to_y;
+    }
+    emit_flattened (xs, ys, n, to_x, to_y);
+  }
+
+  void flatten_cubic (hb_position_t control1_x, hb_position_t control1_y,
+		      hb_position_t control2_x, hb_position_t control2_y,
+		      hb_position_t to_x, hb_position_t to_y)
+  {
+    float x0 = current_x, y0 = current_y;
+    float ddx1 = x0 - 2.f * control1_x + control2_x, ddy1 = y0 - 2.f * control1_y + control2_y;
+    float ddx2 = control1_x - 2.f * control2_x + to_x, ddy2 = control1_y - 2.f * control2_y + to_y;
+    unsigned int n = hb_max (flatten_segments (ddx1, ddy1, .75f),
+			     flatten_segments (ddx2, ddy2, .75f));
+
+    float xs[HB_DRAW_FLATTEN_MAX_SEGMENTS], ys[HB_DRAW_FLATTEN_MAX_SEGMENTS];
+    float step = 1.f / n;
+    for (unsigned int i = 1; i < n; i++)
+    {
+      float t = i * step, mt = 1.f - t;
+      float a = mt * mt * mt, b = 3.f * mt * mt * t, c = 3.f * mt * t * t, d = t * t * t;
+      xs[i] = a * x0 + b * control1_x + c * control2_x + d * to_x;
+      ys[i] = a * y0 + b * control1_y + c * control2_y + d * to_y;
+    }
+    emit_flattened (xs, ys, n, to_x, to_y);
+  }
+
   void start_path ()
   {
     if (path_open) end_path ();
     path_open = true;
-    funcs->move_to (path_start_x, path_start_y, user_data);
+    funcs->move_to (origin_x + path_start_x, origin_y + path_start_y, user_data);
   }
 
   hb_position_t path_start_x;
@@ -130,10 +258,98 @@ struct draw_helper_t
   hb_position_t current_x;
   hb_position_t current_y;
 
+  hb_position_t origin_x;
+  hb_position_t origin_y;
+
+  /* Pending lines for lines_to, as x, y pairs. */
+  hb_position_t lines[2 * HB_DRAW_LINES_BATCH];
+  unsigned int num_lines;
+
   bool path_open;
   const hb_draw_funcs_t *funcs;
   void *user_data;
 };
+
+#ifndef HB_DRAW_CACHE_MAX_INSTANCES
+#define HB_DRAW_CACHE_MAX_INSTANCES 64
+#endif
+
+/* Per-font cache of glyph outlines, recorded as the stream of draw calls
+ * draw_helper_t makes, in font units scaled to the font's scale.  Entries
+ * are keyed by glyph and by instance (scale plus variation coordinates),
+ * so a font whose coordinates change keeps the outlines of earlier
+ * instances around until the cache is full.  Recorded paths are never
+ * freed before the cache itself, so they can be replayed without holding
+ * the lock. */
+struct hb_draw_cache_t
+{
+  enum op_t
+  {
+    OP_MOVE_TO,
+    OP_LINE_TO,
+    OP_QUADRATIC_TO,
+    OP_CUBIC_TO,
+    OP_CLOSE_PATH
+  };
+
+  struct path_t
+  {
+    unsigned int length;
+    hb_position_t commands[HB_VAR_ARRAY];
+  };
+
+  struct instance_t
+  {
+    void fini () { coords.fini (); }
+
+    bool matches (const hb_font_t *font) const;
+
+    int32_t x_scale;
+    int32_t y_scale;
+    hb_vector_t<int> coords;
+  };
+
+  void init (unsigned int max_size_)
+  {
+    lock.init ();
+    max_size = max_size_;
+    size = 0;
+    instances.init ();
+    paths.init ();
+  }
+  void fini ()
+  {
+    reset ();
+    instances.fini ();
+    paths.fini ();
+    lock.fini ();
+  }
+
+  HB_INTERNAL void reset ();
+  HB_INTERNAL unsigned int get_memory_usage ();
+  HB_INTERNAL bool draw (hb_font_t *font, hb_codepoint_t glyph,
+			 const hb_draw_funcs_t *funcs, void *user_data,
+			 hb_position_t x = 0, hb_position_t y = 0);
+
+  HB_INTERNAL static void replay (const hb_position_t *commands, unsigned int length,
+				  const hb_draw_funcs_t *funcs, void *user_data,
+				  hb_position_t x = 0, hb_position_t y = 0);
+
+  private:
+  const path_t *find (hb_font_t *font, hb_codepoint_t glyph, unsigned int *instance);
+  const path_t *add (hb_font_t *font, hb_codepoint_t glyph,
+		     const hb_vector_t<hb_position_t> &commands);
+
+  hb_mutex_t lock;
+  unsigned int max_size;
+  unsigned int size;
+  hb_vector_t<instance_t> instances;
+  /* (instance << 16 | glyph) -> path */
+  hb_hashmap_t<unsigned int, path_t *, (unsigned int) -1, nullptr> paths;
+};
+
+HB_INTERNAL void
+hb_draw_cache_destroy (hb_draw_cache_t *cache);
 #endif
 
 #endif /* HB_DRAW_HH */
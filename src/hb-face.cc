@@ -34,6 +34,16 @@
 #include "hb-ot-face.hh"
 #include "hb-ot-cmap-table.hh"
 
+#if !defined(HB_NO_MT) && defined(HAVE_PTHREAD)
+#include <pthread.h>
+#endif
+
+#if !defined(HB_NO_OPEN) && !defined(HB_NO_FACE_REGISTRY) && defined(HAVE_MMAP)
+#include <sys/types.h>
+#include <sys/stat.h>
+#define HB_FACE_REGISTRY 1
+#endif
+
 
 /**
  * SECTION:hb-face
@@ -140,9 +150,194 @@ hb_face_create_for_tables (hb_reference_table_func_t  reference_table_func,
 }
 
 
+/*
+ * hb_face_collection_t
+ *
+ * What the faces made from one blob with hb_face_create() share: the table
+ * directory of each face in the blob, parsed once into an index sorted by
+ * tag, and the tables that passed sanitize unedited.  Faces of a collection
+ * that point to the same table data, or several faces made from the same
+ * blob, then sanitize it only once.  It lives in the blob's user data.
+ */
+
+struct hb_face_collection_t
+{
+  struct table_t
+  {
+    hb_tag_t tag;
+    unsigned int index;
+    unsigned int offset;
+    unsigned int length;
+
+    /* Duplicate tags sort in directory order, so the first one wins. */
+    static int cmp (const void *pa, const void *pb)
+    {
+      const table_t *a = (const table_t *) pa;
+      const table_t *b = (const table_t *) pb;
+      if (a->tag != b->tag) return a->tag < b->tag ? -1 : 1;
+      return a->index < b->index ? -1 : a->index > b->index ? 1 : 0;
+    }
+  };
+
+  struct directory_t
+  {
+    const table_t *find (hb_tag_t tag) const
+    {
+      unsigned int lo = 0, hi = count;
+      while (lo < hi)
+      {
+	unsigned int mid = lo + (hi - lo) / 2;
+	if (tables[mid].tag < tag)
+	  lo = mid + 1;
+	else
+	  hi = mid;
+      }
+      return lo < count && tables[lo].tag == tag ? &tables[lo] : nullptr;
+    }
+
+    unsigned int count;
+    table_t tables[HB_VAR_ARRAY];
+  };
+
+  struct sanitized_t
+  {
+    const char *data;
+    unsigned int length;
+    hb_tag_t tag;
+    unsigned int num_glyphs;
+    const void *type;
+  };
+
+  static hb_face_collection_t *get (hb_blob_t *blob)
+  {
+    static hb_user_data_key_t key;
+    if (unlikely (hb_object_is_inert (blob)))
+      return nullptr;
+    hb_face_collection_t *collection = (hb_face_collection_t *) hb_blob_get_user_data (blob, &key);
+    if (likely (collection))
+      return collection;
+
+    collection = (hb_face_collection_t *) calloc (1, sizeof (hb_face_collection_t));
+    if (unlikely (!collection))
+      return nullptr;
+    collection->blob = blob;
+    collection->face_count = blob->as<OT::OpenTypeFontFile> ()->get_face_count ();
+    collection->directories = (hb_atomic_ptr_t<directory_t> *)
+			      calloc (collection->face_count, sizeof (collection->directories[0]));
+    collection->lock.init ();
+    collection->sanitized.init ();
+    if (unlikely (collection->face_count && !collection->directories))
+    {
+      destroy (collection);
+      return nullptr;
+    }
+
+    if (unlikely (!hb_blob_set_user_data (blob, &key, collection, destroy, false)))
+    {
+      /* Another face got there first, or setting failed to allocate. */
+      destroy (collection);
+      return (hb_face_collection_t *) hb_blob_get_user_data (blob, &key);
+    }
+    return collection;
+  }
+
+  static void destroy (void *data)
+  {
+    hb_face_collection_t *collection = (hb_face_collection_t *) data;
+    if (collection->directories)
+      for (unsigned int i = 0; i < collection->face_count; i++)
+	free (collection->directories[i].get_relaxed ());
+    free (collection->directories);
+    collection->sanitized.fini ();
+    collection->lock.fini ();
+    free (collection);
+  }
+
+  /* Returns nullptr for faces past the end of the collection, and on
+   * allocation failure; those go through the table directory every time. */
+  const directory_t *get_directory (unsigned int index)
+  {
+    if (unlikely (index >= face_count))
+      return nullptr;
+
+  retry:
+    directory_t *directory = directories[index].get ();
+    if (likely (directory))
+      return directory;
+
+    const OT::OpenTypeFontFile &ot_file = *blob->as<OT::OpenTypeFontFile> ();
+    unsigned int base_offset;
+    const OT::OpenTypeFontFace &ot_face = ot_file.get_face (index, &base_offset);
+    unsigned int count = ot_face.get_table_count ();
+
+    directory = (directory_t *) calloc (1, sizeof (directory_t) + count * sizeof (table_t));
+    if (unlikely (!directory))
+      return nullptr;
+    directory->count = count;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      const OT::TableRecord &record = ot_face.get_table (i);
+      table_t &table = directory->tables[i];
+      table.tag = record.tag;
+      table.index = i;
+      table.offset = base_offset + record.offset;
+      table.length = record.length;
+    }
+    hb_qsort (directory->tables, count, sizeof (table_t), table_t::cmp);
+
+    if (unlikely (!directories[index].cmpexch (nullptr, directory)))
+    {
+      free (directory);
+      goto retry;
+    }
+    return directory;
+  }
+
+  bool is_sanitized (hb_tag_t tag, hb_blob_t *table,
+		     unsigned int num_glyphs, const void *type)
+  {
+    if (!table->length)
+      return false;
+    hb_lock_t l (lock);
+    for (unsigned int i = 0; i < sanitized.length; i++)
+    {
+      const sanitized_t &s = sanitized[i];
+      if (s.data == table->data && s.length == table->length &&
+	  s.tag == tag && s.num_glyphs == num_glyphs && s.type == type)
+	return true;
+    }
+    return false;
+  }
+
+  void set_sanitized (hb_tag_t tag, hb_blob_t *table,
+		      unsigned int num_glyphs, const void *type)
+  {
+    /* Only our own, immutable, data is known not to change under us. */
+    if (!table->length ||
+	table->data < blob->data ||
+	table->length > blob->length ||
+	table->data > blob->data + (blob->length - table->length))
+      return;
+    hb_lock_t l (lock);
+    sanitized_t *s = sanitized.push ();
+    if (likely (!sanitized.in_error ()))
+      *s = {table->data, table->length, tag, num_glyphs, type};
+  }
+
+  private:
+  hb_blob_t *blob; /* Not referenced; we live in its user data. */
+  unsigned int face_count;
+  hb_atomic_ptr_t<directory_t> *directories;
+  hb_mutex_t lock;
+  hb_vector_t<sanitized_t> sanitized;
+};
+
+
 typedef struct hb_face_for_data_closure_t {
   hb_blob_t *blob;
   unsigned int  index;
+  hb_face_collection_t *collection;
+  const hb_face_collection_t::directory_t *directory;
 } hb_face_for_data_closure_t;
 
 static hb_face_for_data_closure_t *
@@ -156,6 +351,9 @@ _hb_face_for_data_closure_create (hb_blob_t *blob, unsigned int index)
 
   closure->blob = blob;
   closure->index = index;
+  closure->collection = hb_face_collection_t::get (blob);
+  if (closure->collection)
+    closure->directory = closure->collection->get_directory (index);
 
   return closure;
 }
@@ -177,6 +375,14 @@ _hb_face_for_data_reference_table (hb_face_t *face HB_UNUSED, hb_tag_t tag, void
   if (tag == HB_TAG_NONE)
     return hb_blob_reference (data->blob);
 
+  if (likely (data->directory))
+  {
+    const hb_face_collection_t::table_t *table = data->directory->find (tag);
+    if (!table)
+      return hb_blob_get_empty ();
+    return hb_blob_create_sub_blob (data->blob, table->offset, table->length);
+  }
+
   const OT::OpenTypeFontFile &ot_file = *data->blob->as<OT::OpenTypeFontFile> ();
   unsigned int base_offset;
   const OT::OpenTypeFontFace &ot_face = ot_file.get_face (data->index, &base_offset);
@@ -188,6 +394,39 @@ _hb_face_for_data_reference_table (hb_face_t *face HB_UNUSED, hb_tag_t tag, void
   return blob;
 }
 
+static hb_face_collection_t *
+_hb_face_get_collection (const hb_face_t *face)
+{
+  if (face->reference_table_func != _hb_face_for_data_reference_table)
+    return nullptr;
+  return ((hb_face_for_data_closure_t *) face->user_data)->collection;
+}
+
+bool
+hb_face_table_is_sanitized (const hb_face_t *face,
+			    hb_tag_t tag,
+			    hb_blob_t *table,
+			    unsigned int num_glyphs,
+			    const void *type)
+{
+  hb_face_collection_t *collection = _hb_face_get_collection (face);
+  if (collection && collection->is_sanitized (tag, table, num_glyphs, type))
+    return true;
+  return face->table.is_sanitized (tag, table, num_glyphs);
+}
+
+void
+hb_face_table_set_sanitized (const hb_face_t *face,
+			     hb_tag_t tag,
+			     hb_blob_t *table,
+			     unsigned int num_glyphs,
+			     const void *type)
+{
+  hb_face_collection_t *collection = _hb_face_get_collection (face);
+  if (collection)
+    collection->set_sanitized (tag, table, num_glyphs, type);
+}
+
 /**
  * hb_face_create: (Xconstructor)
  * @blob: #hb_blob_t to work upon
@@ -230,6 +469,219 @@ hb_face_create (hb_blob_t    *blob,
   return face;
 }
 
+
+/*
+ * Registry.
+ */
+
+/* Faces shared by file identity and face index.  Entries are only ever
+ * prepended, with a compare-and-swap, and never freed, as hb_language_t
+ * items are, so they can be walked without locking; a face evicted from
+ * its entry while still referenced keeps pointing at it.
+ *
+ * The entry holds a reference to its face; when all others are gone, the
+ * face is evicted and that reference dropped.  Lookups announce
+ * themselves in @readers before reading @face, and eviction waits for
+ * them to leave after clearing it, so a face is never freed under a
+ * lookup that is about to reference it. */
+struct hb_face_registry_entry_t
+{
+  struct key_t
+  {
+    bool same_file (const key_t &o) const
+    {
+      return dev == o.dev && ino == o.ino &&
+	     size == o.size && mtime == o.mtime;
+    }
+    bool operator == (const key_t &o) const
+    { return same_file (o) && index == o.index; }
+
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime;
+    unsigned int index;
+  };
+
+  /* Returns a new reference to the face, or nullptr if there is none. */
+  hb_face_t *reference_face ()
+  {
+    readers.inc ();
+    hb_face_t *ret = face.get ();
+    if (ret)
+      hb_face_reference (ret);
+    readers.dec ();
+    return ret;
+  }
+
+  key_t key;
+  hb_atomic_ptr_t<hb_face_t> face;
+  hb_atomic_int_t readers;
+  hb_face_registry_entry_t *next;
+};
+
+#ifdef HB_FACE_REGISTRY
+static hb_atomic_ptr_t<hb_face_registry_entry_t> face_registry;
+
+static hb_face_registry_entry_t *
+_hb_face_registry_find_or_insert (const hb_face_registry_entry_t::key_t &key)
+{
+retry:
+  hb_face_registry_entry_t *first = face_registry;
+
+  for (hb_face_registry_entry_t *entry = first; entry; entry = entry->next)
+    if (entry->key == key)
+      return entry;
+
+  hb_face_registry_entry_t *entry = (hb_face_registry_entry_t *) calloc (1, sizeof (hb_face_registry_entry_t));
+  if (unlikely (!entry))
+    return nullptr;
+  entry->key = key;
+  entry->next = first;
+
+  if (unlikely (!face_registry.cmpexch (first, entry)))
+  {
+    free (entry);
+    goto retry;
+  }
+
+  return entry;
+}
+
+/* A face of another index of the same file, to share its blob, and with
+ * it the file mapping and the sanitized tables. */
+static hb_blob_t *
+_hb_face_registry_reference_blob (const hb_face_registry_entry_t::key_t &key)
+{
+  for (hb_face_registry_entry_t *entry = face_registry; entry; entry = entry->next)
+  {
+    if (!entry->key.same_file (key)) continue;
+    hb_face_t *face = entry->reference_face ();
+    if (!face) continue;
+    hb_blob_t *blob = hb_face_reference_blob (face);
+    hb_face_destroy (face);
+    return blob;
+  }
+  return nullptr;
+}
+#endif
+
+/* Drops a reference to a face made by hb_face_create_shared_from_file().
+ * Returns whether it was the last one and the face is to be freed. */
+static bool
+_hb_face_registry_release (hb_face_t *face)
+{
+  hb_object_trace (face, HB_FUNC);
+  assert (hb_object_is_valid (face));
+
+  /* Once our reference is dropped, @face may be freed by another thread
+   * at any time; only the registry's reference protects it, and only its
+   * pointer may be used, to evict it. */
+  hb_face_registry_entry_t *entry = face->registry_entry;
+  int old = face->header.ref_count.dec ();
+  if (old == 2)
+  {
+    /* Only the registry's reference is left: evict.  If a lookup
+     * referenced the face in the meantime, it lives on unregistered. */
+    if (entry->face.cmpexch (face, nullptr))
+    {
+      /* An atomic add, rather than a load, to be ordered after any
+       * lookup that could still have seen the face. */
+      while (entry->readers.add (0))
+	;
+      hb_face_destroy (face);
+    }
+    return false;
+  }
+  if (old != 1)
+    return false;
+
+  hb_object_fini (face);
+  return true;
+}
+
+#ifndef HB_NO_OPEN
+/**
+ * hb_face_create_shared_from_file:
+ * @file_name: A font filename
+ * @index: The index of the face within the file
+ *
+ * Like creating a face with hb_face_create() from a blob made with
+ * hb_blob_create_from_file(), but faces are shared process-wide: as long
+ * as a face made by this function for @file_name and @index is alive,
+ * later calls return a new reference to it instead of creating another,
+ * so that its tables and accelerators are loaded only once however many
+ * fonts and threads use it.  Faces for other indices of the same file
+ * share its mapping.
+ *
+ * Files are identified by device, inode, size and modification time, so
+ * a file replaced on disk gets a fresh face.  Looking a face up takes no
+ * lock.  The face is dropped from the registry when its last reference
+ * is destroyed.
+ *
+ * The returned face is immutable, as it may be shared with other users.
+ * Where files cannot be identified, a face is created that is not shared.
+ *
+ * Return value: (transfer full): The face object
+ *
+ * Since: REPLACEME
+ **/
+hb_face_t *
+hb_face_create_shared_from_file (const char   *file_name,
+				 unsigned int  index)
+{
+#ifdef HB_FACE_REGISTRY
+  struct stat st;
+  if (unlikely (stat (file_name, &st) == -1))
+    return hb_face_get_empty ();
+
+  hb_face_registry_entry_t::key_t key = {
+    (uint64_t) st.st_dev,
+    (uint64_t) st.st_ino,
+    (uint64_t) st.st_size,
+    (int64_t) st.st_mtime,
+    index
+  };
+
+  hb_face_registry_entry_t *entry = _hb_face_registry_find_or_insert (key);
+  if (unlikely (!entry))
+    goto unshared;
+
+  for (;;)
+  {
+    hb_face_t *face = entry->reference_face ();
+    if (face)
+      return face;
+
+    hb_blob_t *blob = _hb_face_registry_reference_blob (key);
+    if (!blob)
+      blob = hb_blob_create_from_file (file_name);
+    face = hb_face_create (blob, index);
+    hb_blob_destroy (blob);
+    if (unlikely (hb_object_is_inert (face)))
+      return face;
+
+    hb_face_make_immutable (face);
+    face->registry_entry = entry;
+    hb_face_reference (face); /* The registry's. */
+    if (likely (entry->face.cmpexch (nullptr, face)))
+      return face;
+
+    /* Another thread registered one first; use theirs. */
+    face->registry_entry = nullptr;
+    hb_face_destroy (face);
+    hb_face_destroy (face);
+  }
+
+unshared:
+#endif
+  hb_blob_t *blob = hb_blob_create_from_file (file_name);
+  hb_face_t *face = hb_face_create (blob, index);
+  hb_blob_destroy (blob);
+  return face;
+}
+#endif
+
 /**
  * hb_face_get_empty:
  *
@@ -275,7 +727,11 @@ hb_face_reference (hb_face_t *face)
 void
 hb_face_destroy (hb_face_t *face)
 {
-  if (!hb_object_destroy (face)) return;
+  if (unlikely (face && face->registry_entry))
+  {
+    if (!_hb_face_registry_release (face)) return;
+  }
+  else if (!hb_object_destroy (face)) return;
 
   for (hb_face_t::plan_node_t *node = face->shape_plans; node; )
   {
@@ -557,6 +1013,369 @@ hb_face_get_table_tags (const hb_face_t *face,
   return ot_face.get_table_tags (start_offset, table_count, table_tags);
 }
 
+/**
+ * hb_face_reference_accelerator_cache:
+ * @face: A face object
+ *
+ * Builds the accelerators of @face that are costly to compute, if they are
+ * not built already, and saves them into a blob: the glyphs of the 'post'
+ * table sorted by name, and the glyph digests of every GSUB and GPOS
+ * lookup.  The blob can be stored, for example next to the font file, and
+ * passed to hb_face_set_accelerator_cache() on a face for the same font in
+ * a later process to skip computing those again.
+ *
+ * The blob also records which of the tables sanitizing walks in full passed
+ * it unchanged, for hb_face_set_trusted_accelerator_cache().
+ *
+ * The blob is specific to the build of HarfBuzz and the machine that made
+ * it, and should not be shipped elsewhere.
+ *
+ * Return value: (transfer full): The cache blob, which is empty on failure.
+ *
+ * Since: REPLACEME
+ **/
+hb_blob_t *
+hb_face_reference_accelerator_cache (hb_face_t *face)
+{
+  if (unlikely (hb_object_is_inert (face))) return hb_blob_get_empty ();
+  return face->table.build_cache ();
+}
+
+/**
+ * hb_face_set_accelerator_cache:
+ * @face: A face object
+ * @cache: A blob from hb_face_reference_accelerator_cache()
+ *
+ * Makes @face load its accelerators from @cache instead of computing them,
+ * for the parts of @cache made from the same tables as @face has.  The
+ * data is used in place, so it is cheapest to pass a blob created with
+ * hb_blob_create_from_file(), which maps the file into memory.  @face keeps
+ * a reference to @cache.
+ *
+ * This only affects accelerators built afterwards, so it should be called
+ * right after creating @face.  A face takes only one cache, and rejects
+ * any other passed later.  A cache that was made by a different build of
+ * HarfBuzz or that is corrupted is rejected; sections of it made from
+ * other tables are ignored.
+ *
+ * Return value: Whether @cache was accepted.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_face_set_accelerator_cache (hb_face_t *face,
+			       hb_blob_t *cache)
+{
+  if (hb_object_is_immutable (face))
+    return false;
+
+  return face->table.set_cache (cache, false);
+}
+
+/**
+ * hb_face_set_trusted_accelerator_cache:
+ * @face: A face object
+ * @cache: A blob from hb_face_reference_accelerator_cache()
+ *
+ * Like hb_face_set_accelerator_cache(), and additionally lets @face skip
+ * sanitizing the tables that @cache records as having passed sanitizing
+ * unchanged, such as GSUB, GPOS and CFF, as long as their length and hash
+ * still match.  Tables that don't match are sanitized as usual.
+ *
+ * The hash only guards against mistakes, like the font file changing under
+ * the cache, and not against font data crafted to match it.  Only use this
+ * for fonts that are as trusted as @cache itself, such as system fonts and
+ * their caches kept in a location only the system can write to.
+ *
+ * Return value: Whether @cache was accepted.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_face_set_trusted_accelerator_cache (hb_face_t *face,
+				       hb_blob_t *cache)
+{
+  if (hb_object_is_immutable (face))
+    return false;
+
+  return face->table.set_cache (cache, true);
+}
+
+
+/*
+ * Memory usage.
+ */
+
+unsigned int
+hb_memory_usage_report (const hb_vector_t<hb_memory_usage_t> &usage,
+			unsigned int       start_offset,
+			unsigned int      *usage_count, /* IN/OUT */
+			hb_memory_usage_t *out /* OUT */)
+{
+  if (usage_count)
+  {
+    + usage.as_array ().sub_array (start_offset, usage_count)
+    | hb_sink (hb_array (out, *usage_count))
+    ;
+  }
+
+  unsigned int total = 0;
+  for (unsigned int i = 0; i < usage.length; i++)
+    total += usage[i].bytes;
+  return total;
+}
+
+/**
+ * hb_face_get_memory_usage:
+ * @face: A face object
+ * @start_offset: The index of the first entry to fill in
+ * @usage_count: (inout) (optional): Input = the maximum number of entries to
+ * fill in; Output = the actual number of entries filled in
+ * @usage: (out) (array length=usage_count): The breakdown
+ *
+ * Reports the heap memory held by @face: the tables it loaded and the
+ * accelerators it built for them so far, such as the character map, the
+ * GSUB and GPOS lookup accelerators, the 'post' glyph name index or the
+ * decoded CFF charstrings, with one entry per table; and the shape plans it
+ * caches, under #HB_MEMORY_USAGE_TAG_SHAPE_PLANS.
+ *
+ * The font data is not counted, as it belongs to the blob @face was made
+ * from; only copies of tables that had to be modified to be used are.  Nor
+ * is the memory of fonts made from @face, see hb_font_get_memory_usage().
+ * The numbers are estimates, meant for capacity planning.
+ *
+ * Return value: The total number of bytes held.
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_get_memory_usage (hb_face_t         *face,
+			  unsigned int       start_offset,
+			  unsigned int      *usage_count, /* IN/OUT */
+			  hb_memory_usage_t *usage /* OUT */)
+{
+  hb_vector_t<hb_memory_usage_t> entries;
+  if (!hb_object_is_inert (face))
+  {
+    unsigned int object = sizeof (*face);
+    if (face->destroy == (hb_destroy_func_t) _hb_face_for_data_closure_destroy)
+      object += sizeof (hb_face_for_data_closure_t);
+    entries.push (hb_memory_usage_t {HB_MEMORY_USAGE_TAG_OBJECT, object});
+
+    face->table.get_memory_usage (entries);
+
+    unsigned int plans = 0;
+    for (hb_face_t::plan_node_t *node = face->shape_plans; node; node = node->next)
+      plans += sizeof (*node) + node->shape_plan->get_memory_usage ();
+    if (plans)
+      entries.push (hb_memory_usage_t {HB_MEMORY_USAGE_TAG_SHAPE_PLANS, plans});
+  }
+
+  unsigned int total = hb_memory_usage_report (entries, start_offset, usage_count, usage);
+  entries.fini ();
+  return total;
+}
+
+/**
+ * hb_face_drop_accelerators:
+ * @face: A face object
+ *
+ * Frees the accelerators @face built and the shape plans it caches, to
+ * give memory back under pressure.  They are built again when next
+ * needed, which makes the first shaping calls after slower.  See
+ * hb_face_get_memory_usage() for what they hold.
+ *
+ * This is not thread-safe: no other thread may be using @face, or fonts
+ * or shape plans made from it, during the call.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_drop_accelerators (hb_face_t *face)
+{
+  if (unlikely (hb_object_is_inert (face)))
+    return;
+
+  face->table.drop_accelerators ();
+
+  hb_face_t::plan_node_t *node = face->shape_plans;
+  face->shape_plans.set_relaxed (nullptr);
+  while (node)
+  {
+    hb_face_t::plan_node_t *next = node->next;
+    hb_shape_plan_destroy (node->shape_plan);
+    free (node);
+    node = next;
+  }
+}
+
+/**
+ * hb_face_trim:
+ * @face: A face object
+ * @generation: The generation returned by the previous call, or 0
+ *
+ * Releases the tables and accelerators of @face that were not used since
+ * @generation began, so that long-lived faces don't keep tables they only
+ * briefly needed, such as color bitmaps or the 'name' table, in memory.
+ * They are loaded again when next needed.  Calling this periodically, as
+ * in `generation = hb_face_trim (face, generation);`, releases what was
+ * not used during the previous period.  With a @generation of 0, nothing
+ * is released.
+ *
+ * Unlike hb_face_drop_accelerators(), this is safe to call while other
+ * threads use @face.  Calls that read the tables of @face keep track of
+ * themselves, and what is released is only freed once no call that could
+ * still be using it is running: right away when @face is idle, otherwise
+ * by a later call to this function.  The pages of mapped tables that were
+ * not needed again are then given back to the kernel.
+ *
+ * Return value: The generation starting now, to pass to the next call.
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_trim (hb_face_t    *face,
+	      unsigned int  generation)
+{
+  if (unlikely (hb_object_is_inert (face)))
+    return 0;
+
+  return face->table.trim (generation);
+}
+
+
+/*
+ * Paging.
+ */
+
+/* Tables read on every shaping call, all over. */
+static const hb_tag_t _hb_face_hot_tables[] =
+{
+  HB_TAG ('c','m','a','p'),
+  HB_TAG ('h','e','a','d'),
+  HB_TAG ('h','h','e','a'),
+  HB_TAG ('h','m','t','x'),
+  HB_TAG ('m','a','x','p'),
+  HB_TAG ('O','S','/','2'),
+  HB_TAG ('G','D','E','F'),
+  HB_TAG ('G','S','U','B'),
+  HB_TAG ('G','P','O','S'),
+  HB_TAG ('l','o','c','a'),
+};
+
+/* Tables read a glyph at a time, at scattered offsets. */
+static const hb_tag_t _hb_face_sparse_tables[] =
+{
+  HB_TAG ('g','l','y','f'),
+  HB_TAG ('C','F','F',' '),
+  HB_TAG ('C','F','F','2'),
+  HB_TAG ('g','v','a','r'),
+};
+
+/**
+ * hb_face_advise_tables:
+ * @face: A face object
+ *
+ * Tells the kernel how @face is about to be read, so that cold page
+ * faults come in fewer, larger reads: to read ahead the tables every
+ * shaping call goes through, such as 'cmap', 'hmtx', 'GDEF', 'GSUB' and
+ * 'GPOS', and not to read ahead in the ones only looked up a glyph at a
+ * time, 'glyf', 'CFF ', 'CFF2' and 'gvar'.  Call it once after creating
+ * @face.
+ *
+ * Only has an effect on faces made from a blob hb_blob_create_from_file()
+ * mapped into memory, and where posix_madvise() is available.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_advise_tables (hb_face_t *face)
+{
+  for (hb_tag_t tag : _hb_face_hot_tables)
+  {
+    hb_blob_t *blob = hb_face_reference_table (face, tag);
+    blob->advise (hb_blob_t::ADVICE_WILLNEED);
+    hb_blob_destroy (blob);
+  }
+  for (hb_tag_t tag : _hb_face_sparse_tables)
+  {
+    hb_blob_t *blob = hb_face_reference_table (face, tag);
+    blob->advise (hb_blob_t::ADVICE_RANDOM);
+    hb_blob_destroy (blob);
+  }
+}
+
+/**
+ * hb_face_prefault_tables:
+ * @face: A face object
+ *
+ * Reads in the pages of the tables hb_face_advise_tables() asks to read
+ * ahead, blocking until they are all resident, so that shaping with @face
+ * afterwards does not wait on the disk.  This is safe to call from any
+ * thread while @face is being used, and is meant to be run off the
+ * shaping threads; see hb_face_prefault_tables_async().
+ *
+ * Like hb_face_advise_tables(), only has an effect on faces made from a
+ * blob hb_blob_create_from_file() mapped into memory.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_prefault_tables (hb_face_t *face)
+{
+  for (hb_tag_t tag : _hb_face_hot_tables)
+  {
+    hb_blob_t *blob = hb_face_reference_table (face, tag);
+    blob->prefault ();
+    hb_blob_destroy (blob);
+  }
+}
+
+#if !defined(HB_NO_MT) && defined(HAVE_PTHREAD)
+static void *
+_hb_face_prefault_tables_thread (void *data)
+{
+  hb_face_t *face = (hb_face_t *) data;
+  hb_face_prefault_tables (face);
+  hb_face_destroy (face);
+  return nullptr;
+}
+#endif
+
+/**
+ * hb_face_prefault_tables_async:
+ * @face: A face object
+ *
+ * Runs hb_face_prefault_tables() on a new background thread, which holds
+ * a reference to @face until it is done.  Applications with a thread pool
+ * of their own should rather call hb_face_prefault_tables() from it.
+ *
+ * Return value: %true if the thread was started, %false if threads are not
+ * available or it could not be started.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_face_prefault_tables_async (hb_face_t *face)
+{
+#if !defined(HB_NO_MT) && defined(HAVE_PTHREAD)
+  if (unlikely (hb_object_is_inert (face)))
+    return false;
+
+  pthread_t thread;
+  hb_face_reference (face);
+  if (unlikely (pthread_create (&thread, nullptr, _hb_face_prefault_tables_thread, face) != 0))
+  {
+    hb_face_destroy (face);
+    return false;
+  }
+  pthread_detach (thread);
+  return true;
+#else
+  return false;
+#endif
+}
+
 
 /*
  * Character set.
@@ -578,6 +1397,7 @@ void
 hb_face_collect_unicodes (hb_face_t *face,
 			  hb_set_t  *out)
 {
+  hb_ot_face_reader_t reader (face->table);
   face->table.cmap->collect_unicodes (out, face->get_num_glyphs ());
 }
 /**
@@ -594,6 +1414,7 @@ void
 hb_face_collect_variation_selectors (hb_face_t *face,
 				     hb_set_t  *out)
 {
+  hb_ot_face_reader_t reader (face->table);
   face->table.cmap->collect_variation_selectors (out);
 }
 /**
@@ -612,6 +1433,7 @@ hb_face_collect_variation_unicodes (hb_face_t *face,
 				    hb_codepoint_t variation_selector,
 				    hb_set_t  *out)
 {
+  hb_ot_face_reader_t reader (face->table);
   face->table.cmap->collect_variation_unicodes (variation_selector, out);
 }
 #endif
@@ -66,6 +66,10 @@ hb_face_create_for_tables (hb_reference_table_func_t  reference_table_func,
 			   void                      *user_data,
 			   hb_destroy_func_t          destroy);
 
+HB_EXTERN hb_face_t *
+hb_face_create_shared_from_file (const char   *file_name,
+				 unsigned int  index);
+
 HB_EXTERN hb_face_t *
 hb_face_get_empty (void);
 
@@ -127,6 +131,82 @@ hb_face_get_table_tags (const hb_face_t *face,
 			unsigned int *table_count, /* IN/OUT */
 			hb_tag_t     *table_tags /* OUT */);
 
+HB_EXTERN hb_blob_t *
+hb_face_reference_accelerator_cache (hb_face_t *face);
+
+HB_EXTERN hb_bool_t
+hb_face_set_accelerator_cache (hb_face_t *face,
+			       hb_blob_t *cache);
+
+HB_EXTERN hb_bool_t
+hb_face_set_trusted_accelerator_cache (hb_face_t *face,
+				       hb_blob_t *cache);
+
+
+/*
+ * Memory usage.
+ */
+
+/**
+ * hb_memory_usage_t:
+ * @tag: What holds the memory: the tag of a table, for its blob and
+ * accelerators, or one of the `HB_MEMORY_USAGE_TAG_*` tags.
+ * @bytes: The heap memory held, in bytes.
+ *
+ * An entry in the breakdown filled in by hb_face_get_memory_usage() and
+ * hb_font_get_memory_usage().
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_memory_usage_t {
+  hb_tag_t     tag;
+  unsigned int bytes;
+} hb_memory_usage_t;
+
+/**
+ * HB_MEMORY_USAGE_TAG_OBJECT:
+ *
+ * Tag for the memory of an object itself, rather than of any table.
+ *
+ * Since: REPLACEME
+ **/
+#define HB_MEMORY_USAGE_TAG_OBJECT	HB_TAG ('o','b','j','t')
+/**
+ * HB_MEMORY_USAGE_TAG_SHAPE_PLANS:
+ *
+ * Tag for the memory of the shape plans a face caches.
+ *
+ * Since: REPLACEME
+ **/
+#define HB_MEMORY_USAGE_TAG_SHAPE_PLANS	HB_TAG ('p','l','a','n')
+
+HB_EXTERN unsigned int
+hb_face_get_memory_usage (hb_face_t         *face,
+			  unsigned int       start_offset,
+			  unsigned int      *usage_count, /* IN/OUT */
+			  hb_memory_usage_t *usage /* OUT */);
+
+HB_EXTERN void
+hb_face_drop_accelerators (hb_face_t *face);
+
+HB_EXTERN unsigned int
+hb_face_trim (hb_face_t    *face,
+	      unsigned int  generation);
+
+
+/*
+ * Paging.
+ */
+
+HB_EXTERN void
+hb_face_advise_tables (hb_face_t *face);
+
+HB_EXTERN void
+hb_face_prefault_tables (hb_face_t *face);
+
+HB_EXTERN hb_bool_t
+hb_face_prefault_tables_async (hb_face_t *face);
+
 
 /*
  * Character set.
@@ -67,6 +67,10 @@ struct hb_face_t
   };
   hb_atomic_ptr_t<plan_node_t> shape_plans;
 
+  /* Entry of the process-wide registry the face is shared through, if
+   * it was made with hb_face_create_shared_from_file(). */
+  struct hb_face_registry_entry_t *registry_entry;
+
   hb_blob_t *reference_table (hb_tag_t tag) const
   {
     hb_blob_t *blob;
@@ -105,5 +109,13 @@ struct hb_face_t
 };
 DECLARE_NULL_INSTANCE (hb_face_t);
 
+/* Copies the entries of @usage from @start_offset on to @out, as the
+ * *_get_memory_usage() functions do, and returns their total bytes. */
+HB_INTERNAL unsigned int
+hb_memory_usage_report (const hb_vector_t<hb_memory_usage_t> &usage,
+			unsigned int       start_offset,
+			unsigned int      *usage_count, /* IN/OUT */
+			hb_memory_usage_t *out /* OUT */);
+
 
 #endif /* HB_FACE_HH */
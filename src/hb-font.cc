@@ -30,6 +30,7 @@
 
 #include "hb-font.hh"
 #include "hb-machinery.hh"
+#include "hb-draw.hh"
 
 #include "hb-ot.h"
 
@@ -1499,6 +1500,10 @@ hb_font_destroy (hb_font_t *font)
 
   font->data.fini ();
 
+#if !defined(HB_NO_DRAW) && defined(HB_EXPERIMENTAL_API)
+  hb_draw_cache_destroy (font->draw_cache);
+#endif
+
   if (font->destroy)
     font->destroy (font->user_data);
 
@@ -1657,6 +1662,11 @@ hb_font_set_face (hb_font_t *font,
   font->face = hb_face_reference (face);
   font->mults_changed ();
 
+#if !defined(HB_NO_DRAW) && defined(HB_EXPERIMENTAL_API)
+  if (font->draw_cache)
+    font->draw_cache->reset ();
+#endif
+
   hb_face_destroy (old);
 }
 
@@ -1900,6 +1910,7 @@ hb_font_set_variations (hb_font_t *font,
     return;
   }
 
+  hb_ot_face_reader_t reader (font->face->table);
   const OT::fvar &fvar = *font->face->table.fvar;
   for (unsigned int i = 0; i < variations_length; i++)
   {
@@ -2006,6 +2017,7 @@ hb_font_set_var_coords_normalized (hb_font_t *font,
   }
 
   /* Best effort design coords simulation */
+  hb_ot_face_reader_t reader (font->face->table);
   font->face->table.avar->unmap_coords (unmapped, coords_length);
   for (unsigned int i = 0; i < coords_length; ++i)
     design_coords[i] = font->face->table.fvar->unnormalize_axis_value (i, unmapped[i]);
@@ -2053,6 +2065,51 @@ hb_font_get_var_coords_design (hb_font_t *font,
 #endif
 #endif
 
+
+/**
+ * hb_font_get_memory_usage:
+ * @font: #hb_font_t to work upon
+ * @start_offset: The index of the first entry to fill in
+ * @usage_count: (inout) (optional): Input = the maximum number of entries to
+ * fill in; Output = the actual number of entries filled in
+ * @usage: (out) (array length=usage_count): The breakdown
+ *
+ * Reports the heap memory held by @font itself, such as its variation
+ * coordinates, under #HB_MEMORY_USAGE_TAG_OBJECT, and by the outlines its
+ * draw cache recorded, if it has one.  The memory of its face, which fonts
+ * share, is reported by hb_face_get_memory_usage().
+ *
+ * Return value: The total number of bytes held.
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_font_get_memory_usage (hb_font_t         *font,
+			  unsigned int       start_offset,
+			  unsigned int      *usage_count, /* IN/OUT */
+			  hb_memory_usage_t *usage /* OUT */)
+{
+  hb_vector_t<hb_memory_usage_t> entries;
+  if (!hb_object_is_inert (font))
+  {
+    unsigned int object = sizeof (*font) +
+			  font->num_coords * (sizeof (font->coords[0]) +
+					      sizeof (font->design_coords[0]));
+    entries.push (hb_memory_usage_t {HB_MEMORY_USAGE_TAG_OBJECT, object});
+
+#if !defined(HB_NO_DRAW) && defined(HB_EXPERIMENTAL_API)
+    if (font->draw_cache)
+      entries.push (hb_memory_usage_t {HB_MEMORY_USAGE_TAG_DRAW_CACHE,
+				       font->draw_cache->get_memory_usage ()});
+#endif
+  }
+
+  unsigned int total = hb_memory_usage_report (entries, start_offset, usage_count, usage);
+  entries.fini ();
+  return total;
+}
+
+
 #ifndef HB_DISABLE_DEPRECATED
 /*
  * Deprecated get_glyph_func():
@@ -724,10 +724,40 @@ HB_EXTERN void
 hb_font_set_var_named_instance (hb_font_t *font,
 				unsigned instance_index);
 
+HB_EXTERN unsigned int
+hb_font_get_memory_usage (hb_font_t         *font,
+			  unsigned int       start_offset,
+			  unsigned int      *usage_count, /* IN/OUT */
+			  hb_memory_usage_t *usage /* OUT */);
+
 #ifdef HB_EXPERIMENTAL_API
 HB_EXTERN hb_bool_t
 hb_font_draw_glyph (hb_font_t *font, hb_codepoint_t glyph,
 		    const hb_draw_funcs_t *funcs, void *user_data);
+
+HB_EXTERN hb_bool_t
+hb_font_draw_glyphs (hb_font_t *font,
+		     unsigned int count,
+		     const hb_codepoint_t *first_glyph,
+		     unsigned int glyph_stride,
+		     const hb_position_t *first_x,
+		     unsigned int x_stride,
+		     const hb_position_t *first_y,
+		     unsigned int y_stride,
+		     const hb_draw_funcs_t *funcs, void *user_data);
+
+HB_EXTERN void
+hb_font_set_draw_cache_size (hb_font_t    *font,
+			     unsigned int  max_size);
+
+/**
+ * HB_MEMORY_USAGE_TAG_DRAW_CACHE:
+ *
+ * Tag for the memory of the outlines a font's draw cache recorded.
+ *
+ * Since: EXPERIMENTAL
+ **/
+#define HB_MEMORY_USAGE_TAG_DRAW_CACHE	HB_TAG ('d','r','a','w')
 #endif
 
 HB_END_DECLS
@@ -100,6 +100,8 @@ DECLARE_NULL_INSTANCE (hb_font_funcs_t);
 #include "hb-shaper-list.hh"
 #undef HB_SHAPER_IMPLEMENT
 
+struct hb_draw_cache_t;
+
 struct hb_font_t
 {
   hb_object_header_t header;
@@ -128,6 +130,10 @@ struct hb_font_t
 
   hb_shaper_object_dataset_t<hb_font_t> data; /* Various shaper data. */
 
+#ifdef HB_EXPERIMENTAL_API
+  hb_draw_cache_t *draw_cache; /* Recorded glyph outlines, if enabled. */
+#endif
+
 
   /* Convert from font-space to user-space */
   int64_t dir_mult (hb_direction_t direction)
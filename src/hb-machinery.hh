@@ -145,6 +145,9 @@ struct hb_data_wrapper_t
 
   template <typename Stored, typename Subclass>
   Stored * call_create () const { return Subclass::create (get_data ()); }
+
+  template <typename Subclass>
+  void call_note_use () const { Subclass::note_use (get_data (), WheresData); }
 };
 template <>
 struct hb_data_wrapper_t<void, 0>
@@ -153,6 +156,9 @@ struct hb_data_wrapper_t<void, 0>
 
   template <typename Stored, typename Funcs>
   Stored * call_create () const { return Funcs::create (); }
+
+  template <typename Funcs>
+  void call_note_use () const {}
 };
 
 template <typename T1, typename T2> struct hb_non_void_t { typedef T1 value; };
@@ -213,6 +219,7 @@ struct hb_lazy_loader_t : hb_data_wrapper_t<Data, WheresData>
 	goto retry;
       }
     }
+    this->template call_note_use<Funcs> ();
     return p;
   }
   Stored * get_stored_relaxed () const
@@ -220,6 +227,15 @@ struct hb_lazy_loader_t : hb_data_wrapper_t<Data, WheresData>
     return this->instance.get_relaxed ();
   }
 
+  /* Heap memory held by the loaded instance; zero if not loaded. */
+  unsigned int get_memory_usage () const
+  {
+    Stored *p = this->instance.get ();
+    if (!p || p == Funcs::get_null ())
+      return 0;
+    return Funcs::memory_usage (p);
+  }
+
   bool cmpexch (Stored *current, Stored *value) const
   {
     /* This *must* be called when there are no other threads accessing. */
@@ -233,6 +249,10 @@ struct hb_lazy_loader_t : hb_data_wrapper_t<Data, WheresData>
   /* To be possibly overloaded by subclasses. */
   static Returned* convert (Stored *p) { return p; }
 
+  /* Called on every access; face loaders record it for trimming. */
+  template <typename D>
+  static void note_use (D *data HB_UNUSED, unsigned int order HB_UNUSED) {}
+
   /* By default null/init/fini the object. */
   static const Stored* get_null () { return &Null (Stored); }
   static Stored *create (Data *data)
@@ -254,6 +274,16 @@ struct hb_lazy_loader_t : hb_data_wrapper_t<Data, WheresData>
     p->fini ();
     free (p);
   }
+  /* Stored objects with heap memory of their own report it through a
+   * get_memory_usage() method. */
+  static unsigned int memory_usage (const Stored *p)
+  { return sizeof (Stored) + _memory_usage (p, hb_prioritize); }
+  template <typename T>
+  static auto _memory_usage (const T *p, hb_priority<1>) HB_AUTO_RETURN
+  ((unsigned int) p->get_memory_usage ())
+  template <typename T>
+  static unsigned int _memory_usage (const T *p HB_UNUSED, hb_priority<0>)
+  { return 0; }
 
 //  private:
   /* Must only have one pointer. */
@@ -265,7 +295,12 @@ struct hb_lazy_loader_t : hb_data_wrapper_t<Data, WheresData>
 template <typename T, unsigned int WheresFace>
 struct hb_face_lazy_loader_t : hb_lazy_loader_t<T,
 						hb_face_lazy_loader_t<T, WheresFace>,
-						hb_face_t, WheresFace> {};
+						hb_face_t, WheresFace>
+{
+  template <typename Face>
+  static void note_use (Face *face, unsigned int order)
+  { face->table.note_use (order); }
+};
 
 template <typename T, unsigned int WheresFace>
 struct hb_table_lazy_loader_t : hb_lazy_loader_t<T,
@@ -276,6 +311,11 @@ struct hb_table_lazy_loader_t : hb_lazy_loader_t<T,
   static hb_blob_t *create (hb_face_t *face)
   { return hb_sanitize_context_t ().reference_table<T> (face); }
   static void destroy (hb_blob_t *p) { hb_blob_destroy (p); }
+  template <typename Face>
+  static void note_use (Face *face, unsigned int order)
+  { face->table.note_use (order); }
+  static unsigned int memory_usage (const hb_blob_t *p)
+  { return p->get_memory_usage (); }
 
   static const hb_blob_t *get_null ()
   { return hb_blob_get_empty (); }
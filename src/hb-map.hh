@@ -184,6 +184,9 @@ struct hb_hashmap_t
 
   unsigned int get_population () const { return population; }
 
+  unsigned int get_allocated_size () const
+  { return items ? (mask + 1) * sizeof (item_t) : 0; }
+
   /*
    * Iterator
    */
@@ -38,104 +38,6 @@
 #include "hb-vector.hh"
 
 
-/*
- * Lockable set
- */
-
-template <typename item_t, typename lock_t>
-struct hb_lockable_set_t
-{
-  hb_vector_t<item_t> items;
-
-  void init () { items.init (); }
-
-  template <typename T>
-  item_t *replace_or_insert (T v, lock_t &l, bool replace)
-  {
-    l.lock ();
-    item_t *item = items.find (v);
-    if (item) {
-      if (replace) {
-	item_t old = *item;
-	*item = v;
-	l.unlock ();
-	old.fini ();
-      }
-      else {
-	item = nullptr;
-	l.unlock ();
-      }
-    } else {
-      item = items.push (v);
-      l.unlock ();
-    }
-    return item;
-  }
-
-  template <typename T>
-  void remove (T v, lock_t &l)
-  {
-    l.lock ();
-    item_t *item = items.find (v);
-    if (item)
-    {
-      item_t old = *item;
-      *item = items[items.length - 1];
-      items.pop ();
-      l.unlock ();
-      old.fini ();
-    } else {
-      l.unlock ();
-    }
-  }
-
-  template <typename T>
-  bool find (T v, item_t *i, lock_t &l)
-  {
-    l.lock ();
-    item_t *item = items.find (v);
-    if (item)
-      *i = *item;
-    l.unlock ();
-    return !!item;
-  }
-
-  template <typename T>
-  item_t *find_or_insert (T v, lock_t &l)
-  {
-    l.lock ();
-    item_t *item = items.find (v);
-    if (!item) {
-      item = items.push (v);
-    }
-    l.unlock ();
-    return item;
-  }
-
-  void fini (lock_t &l)
-  {
-    if (!items.length)
-    {
-      /* No need to lock. */
-      items.fini ();
-      return;
-    }
-    l.lock ();
-    while (items.length)
-    {
-      item_t old = items[items.length - 1];
-      items.pop ();
-      l.unlock ();
-      old.fini ();
-      l.lock ();
-    }
-    items.fini ();
-    l.unlock ();
-  }
-
-};
-
-
 /*
  * Reference-count.
  */
@@ -161,23 +63,39 @@ struct hb_reference_count_t
 
 /* user_data */
 
+#ifndef HB_USER_DATA_MAX_RETIRED
+#define HB_USER_DATA_MAX_RETIRED 8
+#endif
+
 struct hb_user_data_array_t
 {
   struct hb_user_data_item_t {
     hb_user_data_key_t *key;
-    void *data;
+    hb_atomic_ptr_t<void> data;
     hb_destroy_func_t destroy;
+    bool present;
+  };
 
-    bool operator == (const hb_user_data_key_t *other_key) const { return key == other_key; }
-    bool operator == (const hb_user_data_item_t &other) const { return key == other.key; }
-
-    void fini () { if (destroy) destroy (data); }
+  /* Lookups don't lock: readers scan the first length items of the current
+   * array.  Writers, under lock, update data in place, append and publish
+   * the new length, or replace the array with a copy of the items present.
+   * An item never changes key.  Replaced arrays are retired, and freed once
+   * no reader that could be scanning them is left. */
+  struct items_t
+  {
+    hb_atomic_int_t length;
+    unsigned int allocated;
+    items_t *next_retired;
+    unsigned int drained; /* Reader phases seen drained since retired. */
+    hb_user_data_item_t arrayZ[HB_VAR_ARRAY];
   };
 
   hb_mutex_t lock;
-  hb_lockable_set_t<hb_user_data_item_t, hb_mutex_t> items;
+  hb_atomic_ptr_t<items_t> items;
+  items_t *retired;
+  hb_reader_phases_t readers;
 
-  void init () { lock.init (); items.init (); }
+  void init () { lock.init (); items.init (); retired = nullptr; }
 
   HB_INTERNAL bool set (hb_user_data_key_t *key,
 			void *              data,
@@ -186,7 +104,10 @@ struct hb_user_data_array_t
 
   HB_INTERNAL void *get (hb_user_data_key_t *key);
 
-  void fini () { items.fini (lock); lock.fini (); }
+  HB_INTERNAL void fini ();
+
+  private:
+  HB_INTERNAL void reclaim ();
 };
 
 
@@ -182,6 +182,86 @@ typedef struct OffsetTable
     return_trace (true);
   }
 
+  /* Produces the same bytes as serialize(), but hands them to writer in
+   * order instead of building the whole font in memory.  Only the table
+   * directory is buffered. */
+  template <typename item_t, typename writer_t>
+  static bool write (hb_tag_t sfnt_tag,
+		     hb_array_t<item_t> items,
+		     writer_t &&writer)
+  {
+    unsigned int dir_size = min_size + items.length * TableRecord::static_size;
+    hb_vector_t<char> buf;
+    if (unlikely (!buf.resize (dir_size))) return false;
+
+    hb_serialize_context_t c (buf.arrayZ, dir_size);
+    OffsetTable *dir = c.start_serialize<OffsetTable> ();
+    if (unlikely (!c.extend_min (*dir))) return false;
+    dir->sfnt_version = sfnt_tag;
+    if (unlikely (!dir->tables.serialize (&c, items.length))) return false;
+
+    const head *h = nullptr;
+    unsigned int head_index = items.length;
+    unsigned int offset = dir_size;
+    for (unsigned int i = 0; i < items.length; i++)
+    {
+      TableRecord &rec = dir->tables.arrayZ[i];
+      hb_blob_t *blob = items[i].blob;
+      rec.tag = items[i].tag;
+      rec.length = blob->length;
+      rec.offset = offset;
+      rec.checkSum = CheckSum::CalcUnpaddedChecksum (blob->data, blob->length);
+      offset += hb_ceil_to_4 (blob->length);
+
+      if (items[i].tag == HB_OT_TAG_head &&
+	  hb_ceil_to_4 (blob->length) >= head::static_size)
+      {
+	h = (const head *) blob->data;
+	head_index = i;
+	rec.checkSum = rec.checkSum - h->checkSumAdjustment;
+      }
+    }
+
+    dir->tables.qsort ();
+    c.end_serialize ();
+    if (unlikely (c.in_error ())) return false;
+
+    HBUINT32 checksum_adjustment;
+    checksum_adjustment = 0;
+    if (h)
+    {
+      CheckSum checksum;
+      checksum.set_for_data (dir, dir_size);
+      for (unsigned int i = 0; i < items.length; i++)
+	checksum = checksum + dir->tables.arrayZ[i].checkSum;
+      checksum_adjustment = 0xB1B0AFBAu - checksum;
+    }
+
+    if (unlikely (!writer ((const char *) dir, dir_size))) return false;
+
+    static const char padding[4] = {};
+    for (unsigned int i = 0; i < items.length; i++)
+    {
+      const char *data = items[i].blob->data;
+      unsigned int length = items[i].blob->length;
+      unsigned int pad = hb_ceil_to_4 (length) - length;
+      if (i == head_index)
+      {
+	unsigned int split = (const char *) &h->checkSumAdjustment - data;
+	if (unlikely (!writer (data, split) ||
+		      !writer ((const char *) &checksum_adjustment, checksum_adjustment.static_size)))
+	  return false;
+	split += checksum_adjustment.static_size;
+	data += split;
+	length -= split;
+      }
+      if (length && unlikely (!writer (data, length))) return false;
+      if (pad && unlikely (!writer (padding, pad))) return false;
+    }
+
+    return true;
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -226,6 +226,20 @@ struct CheckSum : HBUINT32
     return Sum;
   }
 
+  /* Same, for data that is not padded; sums as if padded with zeros. */
+  static uint32_t CalcUnpaddedChecksum (const char *data, unsigned int length)
+  {
+    uint32_t sum = CalcTableChecksum ((const HBUINT32 *) data, length & ~3u);
+    if (length & 3)
+    {
+      HBUINT32 tail;
+      tail = 0;
+      memcpy (&tail, data + (length & ~3u), length & 3);
+      sum += tail;
+    }
+    return sum;
+  }
+
   /* Note: data should be 4byte aligned and have 4byte padding at the end. */
   void set_for_data (const void *data, unsigned int length)
   { *this = CalcTableChecksum ((const HBUINT32 *) data, length); }
@@ -265,109 +265,30 @@ hb_codepoint_t OT::cff1::lookup_standard_encoding_for_sid (hb_codepoint_t code)
     return CFF_UNDEF_SID;
 }
 
-struct bounds_t
+struct cff1_outline_param_t : cs_outline_param_t
 {
-  void init ()
+  void init (const OT::cff1::accelerator_t *cff_, cs_outline_t *outline_)
   {
-    min.set_int (INT_MAX, INT_MAX);
-    max.set_int (INT_MIN, INT_MIN);
-  }
-
-  void update (const point_t &pt)
-  {
-    if (pt.x < min.x) min.x = pt.x;
-    if (pt.x > max.x) max.x = pt.x;
-    if (pt.y < min.y) min.y = pt.y;
-    if (pt.y > max.y) max.y = pt.y;
-  }
-
-  void merge (const bounds_t &b)
-  {
-    if (empty ())
-      *this = b;
-    else if (!b.empty ())
-    {
-      if (b.min.x < min.x) min.x = b.min.x;
-      if (b.max.x > max.x) max.x = b.max.x;
-      if (b.min.y < min.y) min.y = b.min.y;
-      if (b.max.y > max.y) max.y = b.max.y;
-    }
-  }
-
-  void offset (const point_t &delta)
-  {
-    if (!empty ())
-    {
-      min.move (delta);
-      max.move (delta);
-    }
-  }
-
-  bool empty () const { return (min.x >= max.x) || (min.y >= max.y); }
-
-  point_t min;
-  point_t max;
-};
-
-struct cff1_extents_param_t
-{
-  void init (const OT::cff1::accelerator_t *_cff)
-  {
-    path_open = false;
-    cff = _cff;
-    bounds.init ();
+    cs_outline_param_t::init (outline_);
+    cff = cff_;
   }
 
-  void start_path   ()       { path_open = true; }
-  void end_path     ()       { path_open = false; }
-  bool is_path_open () const { return path_open; }
-
-  bool path_open;
-  bounds_t bounds;
-
   const OT::cff1::accelerator_t *cff;
 };
 
-struct cff1_path_procs_extents_t : path_procs_t<cff1_path_procs_extents_t, cff1_cs_interp_env_t, cff1_extents_param_t>
-{
-  static void moveto (cff1_cs_interp_env_t &env, cff1_extents_param_t& param, const point_t &pt)
-  {
-    param.end_path ();
-    env.moveto (pt);
-  }
-
-  static void line (cff1_cs_interp_env_t &env, cff1_extents_param_t& param, const point_t &pt1)
-  {
-    if (!param.is_path_open ())
-    {
-      param.start_path ();
-      param.bounds.update (env.get_pt ());
-    }
-    env.moveto (pt1);
-    param.bounds.update (env.get_pt ());
-  }
-
-  static void curve (cff1_cs_interp_env_t &env, cff1_extents_param_t& param, const point_t &pt1, const point_t &pt2, const point_t &pt3)
-  {
-    if (!param.is_path_open ())
-    {
-      param.start_path ();
-      param.bounds.update (env.get_pt ());
-    }
-    /* include control points */
-    param.bounds.update (pt1);
-    param.bounds.update (pt2);
-    env.moveto (pt3);
-    param.bounds.update (env.get_pt ());
-  }
-};
+typedef path_procs_outline_t<cff1_cs_interp_env_t, cff1_outline_param_t> cff1_path_procs_outline_t;
 
-static bool _get_bounds (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph, bounds_t &bounds, bool in_seac=false);
+static const cs_outline_t *_get_outline (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph,
+					 cs_outline_t &scratch, bool in_seac=false);
 
-struct cff1_cs_opset_extents_t : cff1_cs_opset_t<cff1_cs_opset_extents_t, cff1_extents_param_t, cff1_path_procs_extents_t>
+struct cff1_cs_opset_outline_t : cff1_cs_opset_t<cff1_cs_opset_outline_t, cff1_outline_param_t, cff1_path_procs_outline_t>
 {
-  static void process_seac (cff1_cs_interp_env_t &env, cff1_extents_param_t& param)
+  static void process_seac (cff1_cs_interp_env_t &env, cff1_outline_param_t& param)
   {
+    /* End previous path */
+    param.outline->end_path ();
+    param.outline->has_seac = true;
+
     unsigned int  n = env.argStack.get_count ();
     point_t delta;
     delta.x = env.argStack[n-4];
@@ -375,35 +296,53 @@ struct cff1_cs_opset_extents_t : cff1_cs_opset_t<cff1_cs_opset_extents_t, cff1_e
     hb_codepoint_t base = param.cff->std_code_to_glyph (env.argStack[n-2].to_int ());
     hb_codepoint_t accent = param.cff->std_code_to_glyph (env.argStack[n-1].to_int ());
 
-    bounds_t  base_bounds, accent_bounds;
-    if (likely (!env.in_seac && base && accent
-	       && _get_bounds (param.cff, base, base_bounds, true)
-	       && _get_bounds (param.cff, accent, accent_bounds, true)))
+    cs_outline_t base_scratch, accent_scratch;
+    const cs_outline_t *base_outline = nullptr, *accent_outline = nullptr;
+    if (unlikely (!(!env.in_seac && base && accent
+		    && (base_outline = _get_outline (param.cff, base, base_scratch, true))
+		    && (accent_outline = _get_outline (param.cff, accent, accent_scratch, true))
+		    && !base_outline->has_seac && !accent_outline->has_seac)))
     {
-      param.bounds.merge (base_bounds);
-      accent_bounds.offset (delta);
-      param.bounds.merge (accent_bounds);
-    }
-    else
       env.set_error ();
+      return;
+    }
+
+    param.outline->append (*base_outline);
+    param.outline->append (*accent_outline, &delta);
+
+    bounds_t accent_bounds = accent_outline->bounds;
+    param.outline->bounds.merge (base_outline->bounds);
+    accent_bounds.offset (delta);
+    param.outline->bounds.merge (accent_bounds);
   }
 };
 
-bool _get_bounds (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph, bounds_t &bounds, bool in_seac)
+/* Returns the decoded charstring of glyph, from the accelerator's outline
+ * cache if possible.  Otherwise decodes it into scratch and tries to cache
+ * it. */
+const cs_outline_t *_get_outline (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph,
+				  cs_outline_t &scratch, bool in_seac)
 {
-  bounds.init ();
-  if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return false;
+  if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return nullptr;
+
+  const cs_outline_t *cached = cff->outline_cache.get (glyph);
+  if (cached) return cached;
 
   unsigned int fd = cff->fdSelect->get_fd (glyph);
-  cff1_cs_interpreter_t<cff1_cs_opset_extents_t, cff1_extents_param_t> interp;
+  cff1_cs_interpreter_t<cff1_cs_opset_outline_t, cff1_outline_param_t> interp;
   const byte_str_t str = (*cff->charStrings)[glyph];
   interp.env.init (str, *cff, fd);
   interp.env.set_in_seac (in_seac);
-  cff1_extents_param_t  param;
-  param.init (cff);
-  if (unlikely (!interp.interpret (param))) return false;
-  bounds = param.bounds;
-  return true;
+  scratch.init ();
+  cff1_outline_param_t param;
+  param.init (cff, &scratch);
+  if (unlikely (!interp.interpret (param))) return nullptr;
+
+  /* Let's end the path specially since it is called inside seac also */
+  scratch.end_path ();
+
+  cached = cff->outline_cache.set (glyph, scratch);
+  return cached ? cached : &scratch;
 }
 
 bool OT::cff1::accelerator_t::get_extents (hb_font_t *font, hb_codepoint_t glyph, hb_glyph_extents_t *extents) const
@@ -413,10 +352,11 @@ bool OT::cff1::accelerator_t::get_extents (hb_font_t *font, hb_codepoint_t glyph
   return true;
 #endif
 
-  bounds_t bounds;
-
-  if (!_get_bounds (this, glyph, bounds))
+  cs_outline_t scratch;
+  const cs_outline_t *outline = _get_outline (this, glyph, scratch);
+  if (!outline)
     return false;
+  const bounds_t &bounds = outline->bounds;
 
   if (bounds.min.x >= bounds.max.x)
   {
@@ -443,118 +383,34 @@ bool OT::cff1::accelerator_t::get_extents (hb_font_t *font, hb_codepoint_t glyph
 }
 
 #ifdef HB_EXPERIMENTAL_API
-struct cff1_path_param_t
+struct cff1_path_sink_t
 {
-  cff1_path_param_t (const OT::cff1::accelerator_t *cff_, hb_font_t *font_,
-		     draw_helper_t &draw_helper_, point_t *delta_)
+  cff1_path_sink_t (hb_font_t *font_, draw_helper_t &draw_helper_)
   {
     draw_helper = &draw_helper_;
-    cff = cff_;
     font = font_;
-    delta = delta_;
   }
 
   void move_to (const point_t &p)
-  {
-    point_t point = p;
-    if (delta) point.move (*delta);
-    draw_helper->move_to (font->em_scalef_x (point.x.to_real ()), font->em_scalef_y (point.y.to_real ()));
-  }
+  { draw_helper->move_to (font->em_scalef_x (p.x.to_real ()), font->em_scalef_y (p.y.to_real ())); }
 
   void line_to (const point_t &p)
-  {
-    point_t point = p;
-    if (delta) point.move (*delta);
-    draw_helper->line_to (font->em_scalef_x (point.x.to_real ()), font->em_scalef_y (point.y.to_real ()));
-  }
+  { draw_helper->line_to (font->em_scalef_x (p.x.to_real ()), font->em_scalef_y (p.y.to_real ())); }
 
   void cubic_to (const point_t &p1, const point_t &p2, const point_t &p3)
   {
-    point_t point1 = p1, point2 = p2, point3 = p3;
-    if (delta)
-    {
-      point1.move (*delta);
-      point2.move (*delta);
-      point3.move (*delta);
-    }
-    draw_helper->cubic_to (font->em_scalef_x (point1.x.to_real ()), font->em_scalef_y (point1.y.to_real ()),
-			   font->em_scalef_x (point2.x.to_real ()), font->em_scalef_y (point2.y.to_real ()),
-			   font->em_scalef_x (point3.x.to_real ()), font->em_scalef_y (point3.y.to_real ()));
+    draw_helper->cubic_to (font->em_scalef_x (p1.x.to_real ()), font->em_scalef_y (p1.y.to_real ()),
+			   font->em_scalef_x (p2.x.to_real ()), font->em_scalef_y (p2.y.to_real ()),
+			   font->em_scalef_x (p3.x.to_real ()), font->em_scalef_y (p3.y.to_real ()));
   }
 
   void end_path () { draw_helper->end_path (); }
 
-  hb_font_t *font;
+  protected:
   draw_helper_t *draw_helper;
-  point_t *delta;
-
-  const OT::cff1::accelerator_t *cff;
-};
-
-struct cff1_path_procs_path_t : path_procs_t<cff1_path_procs_path_t, cff1_cs_interp_env_t, cff1_path_param_t>
-{
-  static void moveto (cff1_cs_interp_env_t &env, cff1_path_param_t& param, const point_t &pt)
-  {
-    param.move_to (pt);
-    env.moveto (pt);
-  }
-
-  static void line (cff1_cs_interp_env_t &env, cff1_path_param_t &param, const point_t &pt1)
-  {
-    param.line_to (pt1);
-    env.moveto (pt1);
-  }
-
-  static void curve (cff1_cs_interp_env_t &env, cff1_path_param_t &param, const point_t &pt1, const point_t &pt2, const point_t &pt3)
-  {
-    param.cubic_to (pt1, pt2, pt3);
-    env.moveto (pt3);
-  }
-};
-
-static bool _get_path (const OT::cff1::accelerator_t *cff, hb_font_t *font, hb_codepoint_t glyph,
-		       draw_helper_t &draw_helper, bool in_seac = false, point_t *delta = nullptr);
-
-struct cff1_cs_opset_path_t : cff1_cs_opset_t<cff1_cs_opset_path_t, cff1_path_param_t, cff1_path_procs_path_t>
-{
-  static void process_seac (cff1_cs_interp_env_t &env, cff1_path_param_t& param)
-  {
-    /* End previous path */
-    param.end_path ();
-
-    unsigned int n = env.argStack.get_count ();
-    point_t delta;
-    delta.x = env.argStack[n-4];
-    delta.y = env.argStack[n-3];
-    hb_codepoint_t base = param.cff->std_code_to_glyph (env.argStack[n-2].to_int ());
-    hb_codepoint_t accent = param.cff->std_code_to_glyph (env.argStack[n-1].to_int ());
-
-    if (unlikely (!(!env.in_seac && base && accent
-		    && _get_path (param.cff, param.font, base, *param.draw_helper, true)
-		    && _get_path (param.cff, param.font, accent, *param.draw_helper, true, &delta))))
-      env.set_error ();
-  }
+  hb_font_t *font;
 };
 
-bool _get_path (const OT::cff1::accelerator_t *cff, hb_font_t *font, hb_codepoint_t glyph,
-		draw_helper_t &draw_helper, bool in_seac, point_t *delta)
-{
-  if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return false;
-
-  unsigned int fd = cff->fdSelect->get_fd (glyph);
-  cff1_cs_interpreter_t<cff1_cs_opset_path_t, cff1_path_param_t> interp;
-  const byte_str_t str = (*cff->charStrings)[glyph];
-  interp.env.init (str, *cff, fd);
-  interp.env.set_in_seac (in_seac);
-  cff1_path_param_t param (cff, font, draw_helper, delta);
-  if (unlikely (!interp.interpret (param))) return false;
-
-  /* Let's end the path specially since it is called inside seac also */
-  param.end_path ();
-
-  return true;
-}
-
 bool OT::cff1::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, draw_helper_t &draw_helper) const
 {
 #ifdef HB_NO_OT_FONT_CFF
@@ -562,7 +418,14 @@ bool OT::cff1::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, d
   return true;
 #endif
 
-  return _get_path (this, font, glyph, draw_helper);
+  cs_outline_t scratch;
+  const cs_outline_t *outline = _get_outline (this, glyph, scratch);
+  if (!outline)
+    return false;
+
+  cff1_path_sink_t sink (font, draw_helper);
+  outline->replay (sink);
+  return true;
 }
 #endif
 
@@ -1149,6 +1149,19 @@ struct cff1
       blob = nullptr;
     }
 
+    unsigned int get_memory_usage () const
+    {
+      unsigned int size = topDict.get_memory_usage ();
+      size += fontDicts.get_allocated_size () + privateDicts.get_allocated_size ();
+      for (unsigned int i = 0; i < fontDicts.length; i++)
+	size += fontDicts[i].get_memory_usage ();
+      for (unsigned int i = 0; i < privateDicts.length; i++)
+	size += privateDicts[i].get_memory_usage ();
+      if (blob)
+	size += blob->get_memory_usage ();
+      return size;
+    }
+
     bool is_valid () const { return blob; }
     bool   is_CID () const { return topDict.is_CID (); }
 
@@ -1272,6 +1285,7 @@ struct cff1
     void init (hb_face_t *face)
     {
       SUPER::init (face);
+      outline_cache.init (is_valid () ? num_glyphs : 0);
 
       if (!is_valid ()) return;
       if (is_CID ()) return;
@@ -1298,10 +1312,18 @@ struct cff1
     void fini ()
     {
       glyph_names.fini ();
+      outline_cache.fini ();
 
       SUPER::fini ();
     }
 
+    unsigned int get_memory_usage () const
+    {
+      return SUPER::get_memory_usage () +
+	     glyph_names.get_allocated_size () +
+	     outline_cache.get_memory_usage ();
+    }
+
     bool get_glyph_name (hb_codepoint_t glyph,
 			 char *buf, unsigned int buf_len) const
     {
@@ -1351,6 +1373,8 @@ struct cff1
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, draw_helper_t &draw_helper) const;
 #endif
 
+    cs_outline_cache_t outline_cache;
+
     private:
     struct gname_t
     {
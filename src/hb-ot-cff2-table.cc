@@ -34,71 +34,40 @@
 
 using namespace CFF;
 
-struct cff2_extents_param_t
-{
-  void init ()
-  {
-    path_open = false;
-    min_x.set_int (INT_MAX);
-    min_y.set_int (INT_MAX);
-    max_x.set_int (INT_MIN);
-    max_y.set_int (INT_MIN);
-  }
+struct cff2_outline_param_t : cs_outline_param_t {};
 
-  void   start_path ()       { path_open = true; }
-  void     end_path ()       { path_open = false; }
-  bool is_path_open () const { return path_open; }
+typedef path_procs_outline_t<cff2_cs_interp_env_t, cff2_outline_param_t> cff2_path_procs_outline_t;
 
-  void update_bounds (const point_t &pt)
-  {
-    if (pt.x < min_x) min_x = pt.x;
-    if (pt.x > max_x) max_x = pt.x;
-    if (pt.y < min_y) min_y = pt.y;
-    if (pt.y > max_y) max_y = pt.y;
-  }
-
-  bool  path_open;
-  number_t min_x;
-  number_t min_y;
-  number_t max_x;
-  number_t max_y;
-};
+struct cff2_cs_opset_outline_t : cff2_cs_opset_t<cff2_cs_opset_outline_t, cff2_outline_param_t, cff2_path_procs_outline_t> {};
 
-struct cff2_path_procs_extents_t : path_procs_t<cff2_path_procs_extents_t, cff2_cs_interp_env_t, cff2_extents_param_t>
+/* Returns the decoded charstring of glyph at the font's variation
+ * coordinates.  Outlines of the default instance come from, and go to, the
+ * accelerator's outline cache; anything else is decoded into scratch. */
+static const cs_outline_t *_get_outline (const OT::cff2::accelerator_t *cff, hb_font_t *font,
+					 hb_codepoint_t glyph, cs_outline_t &scratch)
 {
-  static void moveto (cff2_cs_interp_env_t &env, cff2_extents_param_t& param, const point_t &pt)
-  {
-    param.end_path ();
-    env.moveto (pt);
-  }
+  if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return nullptr;
 
-  static void line (cff2_cs_interp_env_t &env, cff2_extents_param_t& param, const point_t &pt1)
+  bool cacheable = !font->num_coords;
+  if (cacheable)
   {
-    if (!param.is_path_open ())
-    {
-      param.start_path ();
-      param.update_bounds (env.get_pt ());
-    }
-    env.moveto (pt1);
-    param.update_bounds (env.get_pt ());
+    const cs_outline_t *cached = cff->outline_cache.get (glyph);
+    if (cached) return cached;
   }
 
-  static void curve (cff2_cs_interp_env_t &env, cff2_extents_param_t& param, const point_t &pt1, const point_t &pt2, const point_t &pt3)
-  {
-    if (!param.is_path_open ())
-    {
-      param.start_path ();
-      param.update_bounds (env.get_pt ());
-    }
-    /* include control points */
-    param.update_bounds (pt1);
-    param.update_bounds (pt2);
-    env.moveto (pt3);
-    param.update_bounds (env.get_pt ());
-  }
-};
-
-struct cff2_cs_opset_extents_t : cff2_cs_opset_t<cff2_cs_opset_extents_t, cff2_extents_param_t, cff2_path_procs_extents_t> {};
+  unsigned int fd = cff->fdSelect->get_fd (glyph);
+  cff2_cs_interpreter_t<cff2_cs_opset_outline_t, cff2_outline_param_t> interp;
+  const byte_str_t str = (*cff->charStrings)[glyph];
+  interp.env.init (str, *cff, fd, font->coords, font->num_coords);
+  scratch.init ();
+  cff2_outline_param_t param;
+  param.init (&scratch);
+  if (unlikely (!interp.interpret (param))) return nullptr;
+  scratch.end_path ();
+
+  const cs_outline_t *cached = cacheable ? cff->outline_cache.set (glyph, scratch) : nullptr;
+  return cached ? cached : &scratch;
+}
 
 bool OT::cff2::accelerator_t::get_extents (hb_font_t *font,
 					   hb_codepoint_t glyph,
@@ -109,44 +78,39 @@ bool OT::cff2::accelerator_t::get_extents (hb_font_t *font,
   return true;
 #endif
 
-  if (unlikely (!is_valid () || (glyph >= num_glyphs))) return false;
+  cs_outline_t scratch;
+  const cs_outline_t *outline = _get_outline (this, font, glyph, scratch);
+  if (!outline) return false;
+  const bounds_t &bounds = outline->bounds;
 
-  unsigned int fd = fdSelect->get_fd (glyph);
-  cff2_cs_interpreter_t<cff2_cs_opset_extents_t, cff2_extents_param_t> interp;
-  const byte_str_t str = (*charStrings)[glyph];
-  interp.env.init (str, *this, fd, font->coords, font->num_coords);
-  cff2_extents_param_t  param;
-  param.init ();
-  if (unlikely (!interp.interpret (param))) return false;
-
-  if (param.min_x >= param.max_x)
+  if (bounds.min.x >= bounds.max.x)
   {
     extents->width = 0;
     extents->x_bearing = 0;
   }
   else
   {
-    extents->x_bearing = font->em_scalef_x (param.min_x.to_real ());
-    extents->width = font->em_scalef_x (param.max_x.to_real () - param.min_x.to_real ());
+    extents->x_bearing = font->em_scalef_x (bounds.min.x.to_real ());
+    extents->width = font->em_scalef_x (bounds.max.x.to_real () - bounds.min.x.to_real ());
   }
-  if (param.min_y >= param.max_y)
+  if (bounds.min.y >= bounds.max.y)
   {
     extents->height = 0;
     extents->y_bearing = 0;
   }
   else
   {
-    extents->y_bearing = font->em_scalef_y (param.max_y.to_real ());
-    extents->height = font->em_scalef_y (param.min_y.to_real () - param.max_y.to_real ());
+    extents->y_bearing = font->em_scalef_y (bounds.max.y.to_real ());
+    extents->height = font->em_scalef_y (bounds.min.y.to_real () - bounds.max.y.to_real ());
   }
 
   return true;
 }
 
 #ifdef HB_EXPERIMENTAL_API
-struct cff2_path_param_t
+struct cff2_path_sink_t
 {
-  cff2_path_param_t (hb_font_t *font_, draw_helper_t &draw_helper_)
+  cff2_path_sink_t (hb_font_t *font_, draw_helper_t &draw_helper_)
   {
     draw_helper = &draw_helper_;
     font = font_;
@@ -165,34 +129,14 @@ struct cff2_path_param_t
 			   font->em_scalef_x (p3.x.to_real ()), font->em_scalef_y (p3.y.to_real ()));
   }
 
+  /* The draw helper closes the last path when it goes out of scope. */
+  void end_path () {}
+
   protected:
   draw_helper_t *draw_helper;
   hb_font_t *font;
 };
 
-struct cff2_path_procs_path_t : path_procs_t<cff2_path_procs_path_t, cff2_cs_interp_env_t, cff2_path_param_t>
-{
-  static void moveto (cff2_cs_interp_env_t &env, cff2_path_param_t& param, const point_t &pt)
-  {
-    param.move_to (pt);
-    env.moveto (pt);
-  }
-
-  static void line (cff2_cs_interp_env_t &env, cff2_path_param_t& param, const point_t &pt1)
-  {
-    param.line_to (pt1);
-    env.moveto (pt1);
-  }
-
-  static void curve (cff2_cs_interp_env_t &env, cff2_path_param_t& param, const point_t &pt1, const point_t &pt2, const point_t &pt3)
-  {
-    param.cubic_to (pt1, pt2, pt3);
-    env.moveto (pt3);
-  }
-};
-
-struct cff2_cs_opset_path_t : cff2_cs_opset_t<cff2_cs_opset_path_t, cff2_path_param_t, cff2_path_procs_path_t> {};
-
 bool OT::cff2::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, draw_helper_t &draw_helper) const
 {
 #ifdef HB_NO_OT_FONT_CFF
@@ -200,14 +144,12 @@ bool OT::cff2::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, d
   return true;
 #endif
 
-  if (unlikely (!is_valid () || (glyph >= num_glyphs))) return false;
+  cs_outline_t scratch;
+  const cs_outline_t *outline = _get_outline (this, font, glyph, scratch);
+  if (!outline) return false;
 
-  unsigned int fd = fdSelect->get_fd (glyph);
-  cff2_cs_interpreter_t<cff2_cs_opset_path_t, cff2_path_param_t> interp;
-  const byte_str_t str = (*charStrings)[glyph];
-  interp.env.init (str, *this, fd, font->coords, font->num_coords);
-  cff2_path_param_t param (font, draw_helper);
-  if (unlikely (!interp.interpret (param))) return false;
+  cff2_path_sink_t sink (font, draw_helper);
+  outline->replay (sink);
   return true;
 }
 #endif
@@ -481,6 +481,19 @@ struct cff2
       blob = nullptr;
     }
 
+    unsigned int get_memory_usage () const
+    {
+      unsigned int size = topDict.get_memory_usage ();
+      size += fontDicts.get_allocated_size () + privateDicts.get_allocated_size ();
+      for (unsigned int i = 0; i < fontDicts.length; i++)
+	size += fontDicts[i].get_memory_usage ();
+      for (unsigned int i = 0; i < privateDicts.length; i++)
+	size += privateDicts[i].get_memory_usage ();
+      if (blob)
+	size += blob->get_memory_usage ();
+      return size;
+    }
+
     bool is_valid () const { return blob; }
 
     protected:
@@ -504,12 +517,33 @@ struct cff2
 
   struct accelerator_t : accelerator_templ_t<cff2_private_dict_opset_t, cff2_private_dict_values_t>
   {
+    void init (hb_face_t *face)
+    {
+      SUPER::init (face);
+      outline_cache.init (is_valid () ? num_glyphs : 0);
+    }
+
+    void fini ()
+    {
+      outline_cache.fini ();
+      SUPER::fini ();
+    }
+
+    unsigned int get_memory_usage () const
+    { return SUPER::get_memory_usage () + outline_cache.get_memory_usage (); }
+
     HB_INTERNAL bool get_extents (hb_font_t *font,
 				  hb_codepoint_t glyph,
 				  hb_glyph_extents_t *extents) const;
 #ifdef HB_EXPERIMENTAL_API
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, draw_helper_t &draw_helper) const;
 #endif
+
+    /* Only holds outlines of the default instance. */
+    cs_outline_cache_t outline_cache;
+
+    private:
+    typedef accelerator_templ_t<cff2_private_dict_opset_t, cff2_private_dict_values_t> SUPER;
   };
 
   typedef accelerator_templ_t<cff2_private_dict_opset_subset_t, cff2_private_dict_values_subset_t> accelerator_subset_t;
@@ -1170,6 +1170,9 @@ struct CmapSubtableFormat14
       _.collect_mapping (this, unicodes, mapping);
   }
 
+  /* Not sanitized. */
+  unsigned get_size () const { return length; }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -1419,9 +1422,6 @@ struct cmap
   {
     TRACE_SUBSET (this);
 
-    cmap *cmap_prime = c->serializer->start_embed<cmap> ();
-    if (unlikely (!c->serializer->check_success (cmap_prime))) return_trace (false);
-
     auto encodingrec_iter =
     + hb_iter (encodingRecord)
     | hb_filter ([&] (const EncodingRecord& _)
@@ -1457,6 +1457,32 @@ struct cmap
     if (unlikely (!has_format12 && !unicode_bmp && !ms_bmp)) return_trace (false);
     if (unlikely (has_format12 && (!unicode_ucs4 && !ms_ucs4))) return_trace (false);
 
+    {
+      /* Worst case, every record gets its own subtable, with a segment /
+       * group per code point. */
+      unsigned size = min_size;
+      for (const EncodingRecord& _ : encodingrec_iter)
+      {
+	const CmapSubtable &subtable = this + _.subtable;
+	unsigned num_unicodes = c->plan->unicodes->get_population ();
+	if (subtable.u.format != 14 && !c->plan->glyphs_requested->is_empty ())
+	{
+	  /* Requested glyphs pull in any code point mapping to them. */
+	  hb_set_t unicodes;
+	  subtable.collect_unicodes (&unicodes);
+	  num_unicodes = hb_max (num_unicodes, unicodes.get_population ());
+	}
+	unsigned subtable_size = subtable.u.format == 14
+			       ? hb_min (subtable.u.format14.get_size (), c->source_blob->length)
+			       : 24 + 12 * num_unicodes;
+	size += EncodingRecord::static_size + subtable_size;
+      }
+      if (unlikely (!c->ensure_room (size))) return_trace (false);
+    }
+
+    cmap *cmap_prime = c->serializer->start_embed<cmap> ();
+    if (unlikely (!c->serializer->check_success (cmap_prime))) return_trace (false);
+
     auto it =
     + hb_iter (c->plan->unicodes)
     | hb_map ([&] (hb_codepoint_t _)
@@ -740,7 +740,7 @@ struct CBLC
 						 cbdt_prime->arrayZ,
 						 free);
     cbdt_prime->init ();  // Leak arrayZ to the blob.
-    bool ret = c->plan->add_table (HB_OT_TAG_CBDT, cbdt_prime_blob);
+    bool ret = c->add_table (HB_OT_TAG_CBDT, cbdt_prime_blob);
     hb_blob_destroy (cbdt_prime_blob);
     return ret;
   }
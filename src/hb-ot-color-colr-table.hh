@@ -125,7 +125,7 @@ struct COLR
 
     void fini () { this->colr.destroy (); }
 
-    bool is_valid () { return colr.get_blob ()->length; }
+    bool is_valid () const { return colr.get_blob ()->length; }
 
     void closure_glyphs (hb_codepoint_t glyph,
 			 hb_set_t *related_ids /* OUT */) const
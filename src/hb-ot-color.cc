@@ -71,6 +71,7 @@
 hb_bool_t
 hb_ot_color_has_palettes (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.CPAL->has_data ();
 }
 
@@ -87,6 +88,7 @@ hb_ot_color_has_palettes (hb_face_t *face)
 unsigned int
 hb_ot_color_palette_get_count (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.CPAL->get_palette_count ();
 }
 
@@ -110,6 +112,7 @@ hb_ot_name_id_t
 hb_ot_color_palette_get_name_id (hb_face_t *face,
 				 unsigned int palette_index)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.CPAL->get_palette_name_id (palette_index);
 }
 
@@ -132,6 +135,7 @@ hb_ot_name_id_t
 hb_ot_color_palette_color_get_name_id (hb_face_t *face,
 				       unsigned int color_index)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.CPAL->get_color_name_id (color_index);
 }
 
@@ -150,6 +154,7 @@ hb_ot_color_palette_flags_t
 hb_ot_color_palette_get_flags (hb_face_t *face,
 			       unsigned int palette_index)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.CPAL->get_palette_flags (palette_index);
 }
 
@@ -181,6 +186,7 @@ hb_ot_color_palette_get_colors (hb_face_t     *face,
 				unsigned int  *colors_count  /* IN/OUT.  May be NULL. */,
 				hb_color_t    *colors        /* OUT.     May be NULL. */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.CPAL->get_palette_colors (palette_index, start_offset, colors_count, colors);
 }
 
@@ -202,6 +208,7 @@ hb_ot_color_palette_get_colors (hb_face_t     *face,
 hb_bool_t
 hb_ot_color_has_layers (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.COLR->has_data ();
 }
 
@@ -228,6 +235,7 @@ hb_ot_color_glyph_get_layers (hb_face_t           *face,
 			      unsigned int        *layer_count, /* IN/OUT.  May be NULL. */
 			      hb_ot_color_layer_t *layers /* OUT.     May be NULL. */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.COLR->get_glyph_layers (glyph, start_offset, layer_count, layers);
 }
 
@@ -249,6 +257,7 @@ hb_ot_color_glyph_get_layers (hb_face_t           *face,
 hb_bool_t
 hb_ot_color_has_svg (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.SVG->has_data ();
 }
 
@@ -266,6 +275,7 @@ hb_ot_color_has_svg (hb_face_t *face)
 hb_blob_t *
 hb_ot_color_glyph_reference_svg (hb_face_t *face, hb_codepoint_t glyph)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.SVG->reference_blob_for_glyph (glyph);
 }
 
@@ -287,6 +297,7 @@ hb_ot_color_glyph_reference_svg (hb_face_t *face, hb_codepoint_t glyph)
 hb_bool_t
 hb_ot_color_has_png (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.CBDT->has_data () || face->table.sbix->has_data ();
 }
 
@@ -306,6 +317,7 @@ hb_ot_color_has_png (hb_face_t *face)
 hb_blob_t *
 hb_ot_color_glyph_reference_png (hb_font_t *font, hb_codepoint_t  glyph)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_blob_t *blob = hb_blob_get_empty ();
 
   if (font->face->table.sbix->has_data ())
@@ -41,11 +41,25 @@
 #include "hb-ot-layout-gdef-table.hh"
 #include "hb-ot-layout-gsub-table.hh"
 #include "hb-ot-layout-gpos-table.hh"
+#include "hb-ot-layout-base-table.hh"
+#include "hb-ot-math-table.hh"
+#include "hb-ot-os2-table.hh"
+#include "hb-ot-stat-table.hh"
+#include "hb-ot-vorg-table.hh"
+#include "hb-ot-var-mvar-table.hh"
+#include "hb-ot-var-fvar-table.hh"
+#include "hb-ot-var-avar-table.hh"
+#include "hb-ot-color-colr-table.hh"
+#include "hb-ot-color-cpal-table.hh"
+#include "hb-aat-layout-morx-table.hh"
+#include "hb-aat-layout-trak-table.hh"
+#include "hb-aat-layout-feat-table.hh"
 
 
 void hb_ot_face_t::init0 (hb_face_t *face)
 {
   this->face = face;
+  trim_lock.init ();
 #define HB_OT_TABLE(Namespace, Type) Type.init0 ();
 #include "hb-ot-face-table-list.hh"
 #undef HB_OT_TABLE
@@ -55,4 +69,393 @@ void hb_ot_face_t::fini ()
 #define HB_OT_TABLE(Namespace, Type) Type.fini ();
 #include "hb-ot-face-table-list.hh"
 #undef HB_OT_TABLE
+  for (const retired_t &r : retired)
+    r.destroy (r.instance);
+  retired.fini ();
+  /* After the accelerators, which may point into it. */
+  hb_blob_destroy (cache);
+  trim_lock.fini ();
+}
+
+void hb_ot_face_t::get_memory_usage (hb_vector_t<hb_memory_usage_t> &usage) const
+{
+  hb_ot_face_reader_t reader (*this);
+#define HB_OT_TABLE(Namespace, Type) \
+  if (unsigned int bytes = Type.get_memory_usage ()) \
+    usage.push (hb_memory_usage_t {Namespace::Type::tableTag, bytes});
+#include "hb-ot-face-table-list.hh"
+#undef HB_OT_TABLE
+}
+void hb_ot_face_t::drop_accelerators ()
+{
+#define HB_OT_TABLE(Namespace, Type)
+#define HB_OT_ACCELERATOR(Namespace, Type) Type.free_instance ();
+#include "hb-ot-face-table-list.hh"
+#undef HB_OT_ACCELERATOR
+#undef HB_OT_TABLE
+}
+
+template <typename Returned, typename Subclass, typename Data,
+	  unsigned int WheresData, typename Stored>
+static void
+_hb_ot_face_retire (hb_ot_face_t *ot_face,
+		    hb_lazy_loader_t<Returned, Subclass, Data, WheresData, Stored> &loader,
+		    hb_tag_t tag)
+{
+  typedef hb_lazy_loader_t<Returned, Subclass, Data, WheresData, Stored> loader_t;
+
+  Stored *p = loader.instance.get ();
+  if (!p || p == loader_t::Funcs::get_null ())
+    return;
+
+  /* Make room first; what can't be kept track of stays loaded. */
+  hb_ot_face_t::retired_t *retired = ot_face->retired.push ();
+  if (unlikely (ot_face->retired.in_error ()))
+    return;
+  if (!loader.cmpexch (p, nullptr))
+  {
+    ot_face->retired.pop ();
+    return;
+  }
+
+  retired->instance = p;
+  retired->destroy = [] (void *instance) { loader_t::do_destroy ((Stored *) instance); };
+  retired->tag = tag;
+  retired->order = WheresData;
+  retired->last_used = ot_face->last_used[WheresData].get_relaxed ();
+  retired->drained = 0;
+}
+
+/* A reader that picked up a detached instance entered its read section
+ * before the instance was detached, and counts in one of the two reader
+ * phases until it leaves.  So once each phase has been seen with no readers
+ * after the detaching, no reader can be holding it any more. */
+unsigned int hb_ot_face_t::trim (unsigned int since)
+{
+  trim_lock.lock ();
+
+  int current = generation.get_relaxed ();
+#define HB_OT_TABLE(Namespace, Type) \
+  if (last_used[HB_OT_TABLE_ORDER (Namespace, Type)].get_relaxed () < (int) since) \
+    _hb_ot_face_retire (this, Type, Namespace::Type::tableTag);
+#include "hb-ot-face-table-list.hh"
+#undef HB_OT_TABLE
+
+  unsigned int drained = readers.flip ();
+
+  unsigned int kept = 0;
+  for (unsigned int i = 0; i < retired.length; i++)
+  {
+    retired_t r = retired[i];
+    r.drained |= drained;
+    if (r.drained != 3)
+    {
+      retired[kept++] = r;
+      continue;
+    }
+
+    r.destroy (r.instance);
+
+    /* The pages of a mapped table that was not loaded again can go too;
+     * the kernel reads them back in should they be used after all. */
+    if (last_used[r.order].get_relaxed () == r.last_used)
+    {
+      hb_blob_t *blob = hb_face_reference_table (face, r.tag);
+      blob->advise (hb_blob_t::ADVICE_DONTNEED);
+      hb_blob_destroy (blob);
+    }
+  }
+  retired.shrink (kept);
+
+  generation.set_relaxed (current + 1);
+
+  trim_lock.unlock ();
+  return current + 1;
+}
+
+
+/*
+ * Accelerator cache.
+ *
+ * Accelerator data that is costly to compute, saved in a blob that can be
+ * stored next to the font and mapped back in by later processes.  The data
+ * is in the byte order and layout of the library that wrote it; the magic
+ * number and the build fingerprint in the header reject blobs from
+ * elsewhere.
+ *
+ * Each section holds the data for one table, and records the length and a
+ * hash of the table it was computed from, so that it is only ever used
+ * with that same table.  The contents of a section that passes these
+ * checks are still treated as untrusted by the accelerators using them.
+ *
+ * The stamps section lists the tables that sanitized without edits when
+ * the cache was built.  It is only consulted for caches the caller vouches
+ * for, since its hash is not meant to withstand crafted tables.
+ */
+
+#define HB_OT_FACE_CACHE_MAGIC		HB_TAG ('H','B','A','C')
+#define HB_OT_FACE_CACHE_VERSION	3u
+#define HB_OT_FACE_CACHE_STAMPS		HB_TAG ('s','a','n','e')
+
+struct hb_ot_face_cache_header_t
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t digest_size;
+  uint32_t section_count;
+  uint64_t build;	/* _hb_ot_face_cache_build_fingerprint () */
+};
+
+struct hb_ot_face_cache_section_t
+{
+  uint32_t tag;
+  uint32_t table_length;
+  uint32_t table_hash;
+  uint32_t offset;	/* From the start of the cache; multiple of 8. */
+  uint32_t length;
+  uint32_t hash;	/* Of the section data. */
+};
+
+struct hb_ot_face_cache_stamp_t
+{
+  uint32_t tag;
+  uint32_t table_length;
+  uint32_t num_glyphs;	/* Sanitized with. */
+  uint32_t reserved;
+  uint64_t table_hash;
+};
+
+/* Hashes a word at a time; the tables hashed can be large, and this runs
+ * every time a cached accelerator is loaded. */
+static uint64_t
+_hb_ot_face_cache_hash64 (hb_bytes_t bytes)
+{
+  const char *p = bytes.arrayZ;
+  unsigned int length = bytes.length;
+  uint64_t h[4] = {length, 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull};
+  for (; length >= 32; p += 32, length -= 32)
+    for (unsigned int i = 0; i < 4; i++)
+    {
+      uint64_t v;
+      memcpy (&v, p + 8 * i, 8);
+      h[i] = (h[i] ^ v) * 0x100000001B3ull;
+    }
+  for (; length; p++, length--)
+    h[0] = (h[0] ^ (uint8_t) *p) * 0x100000001B3ull;
+  uint64_t r = h[0];
+  for (unsigned int i = 1; i < 4; i++)
+    r = (r ^ h[i] ^ (h[i] >> 29)) * 0xFF51AFD7ED558CCDull;
+  return r ^ (r >> 32);
+}
+
+static uint32_t
+_hb_ot_face_cache_hash (hb_bytes_t bytes)
+{ return (uint32_t) _hb_ot_face_cache_hash64 (bytes); }
+
+/* Identifies the library version, and the layout and parameters of the
+ * glyph digests stored as is: a build digesting glyphs differently digests
+ * the probe glyphs into different bytes. */
+static uint64_t
+_hb_ot_face_cache_build_fingerprint ()
+{
+  hb_set_digest_t digest;
+  digest.init ();
+  for (hb_codepoint_t g = 1; g < 0x10000u; g = g * 3 + 1)
+    digest.add (g);
+  return _hb_ot_face_cache_hash64 (hb_bytes_t (HB_VERSION_STRING, strlen (HB_VERSION_STRING))) ^
+	 _hb_ot_face_cache_hash64 (hb_bytes_t ((const char *) &digest, sizeof (digest)));
+}
+
+bool hb_ot_face_t::set_cache (hb_blob_t *blob, bool trusted)
+{
+  /* Accelerators built from the current cache may point into it. */
+  if (cache) return false;
+
+  hb_ot_face_cache_header_t header;
+  if (blob->length < sizeof (header)) return false;
+  memcpy (&header, blob->data, sizeof (header));
+  if (header.magic != HB_OT_FACE_CACHE_MAGIC ||
+      header.version != HB_OT_FACE_CACHE_VERSION ||
+      header.digest_size != sizeof (hb_set_digest_t) ||
+      header.build != _hb_ot_face_cache_build_fingerprint () ||
+      header.section_count > (blob->length - sizeof (header)) / sizeof (hb_ot_face_cache_section_t))
+    return false;
+
+  for (unsigned int i = 0; i < header.section_count; i++)
+  {
+    hb_ot_face_cache_section_t section;
+    memcpy (&section, blob->data + sizeof (header) + i * sizeof (section), sizeof (section));
+    if (section.offset > blob->length ||
+	section.length > blob->length - section.offset)
+      return false;
+  }
+
+  cache = hb_blob_reference (blob);
+  cache_trusted = trusted;
+  return true;
+}
+
+hb_bytes_t hb_ot_face_t::get_cache_section (hb_tag_t tag, hb_blob_t *table) const
+{
+  if (!cache) return hb_bytes_t ();
+
+  hb_ot_face_cache_header_t header;
+  memcpy (&header, cache->data, sizeof (header));
+  for (unsigned int i = 0; i < header.section_count; i++)
+  {
+    hb_ot_face_cache_section_t section;
+    memcpy (&section, cache->data + sizeof (header) + i * sizeof (section), sizeof (section));
+    if (section.tag != tag) continue;
+
+    hb_bytes_t data (cache->data + section.offset, section.length);
+    if (table &&
+	(section.table_length != table->length ||
+	 section.table_hash != _hb_ot_face_cache_hash (table->as_bytes ())))
+    {
+      DEBUG_MSG (BLOB, cache, "%c%c%c%c cache built from a different table", HB_UNTAG (tag));
+      return hb_bytes_t ();
+    }
+    if (section.hash != _hb_ot_face_cache_hash (data))
+    {
+      DEBUG_MSG (BLOB, cache, "%c%c%c%c cache corrupted", HB_UNTAG (tag));
+      return hb_bytes_t ();
+    }
+    return data;
+  }
+  return hb_bytes_t ();
+}
+
+bool hb_ot_face_t::is_sanitized (hb_tag_t tag, hb_blob_t *table, unsigned int num_glyphs) const
+{
+  if (!cache_trusted || !table->length) return false;
+
+  hb_bytes_t data = get_cache_section (HB_OT_FACE_CACHE_STAMPS, nullptr);
+  unsigned int count = data.length / sizeof (hb_ot_face_cache_stamp_t);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    hb_ot_face_cache_stamp_t stamp;
+    memcpy (&stamp, data.arrayZ + i * sizeof (stamp), sizeof (stamp));
+    if (stamp.tag != tag) continue;
+    return stamp.table_length == table->length &&
+	   stamp.num_glyphs == num_glyphs &&
+	   stamp.table_hash == _hb_ot_face_cache_hash64 (table->as_bytes ());
+  }
+  return false;
+}
+
+struct hb_ot_face_cache_builder_t
+{
+  hb_ot_face_cache_builder_t () { sections.init (); data.init (); }
+  ~hb_ot_face_cache_builder_t () { sections.fini (); data.fini (); }
+
+  /* Records the data appended to @data since @start as the section
+   * for @tag, computed from @table, if any. */
+  void add_section (hb_tag_t tag, hb_blob_t *table, unsigned int start)
+  {
+    hb_ot_face_cache_section_t *section = sections.push ();
+    if (unlikely (sections.in_error ())) return;
+    section->tag = tag;
+    section->table_length = table ? table->length : 0;
+    section->table_hash = table ? _hb_ot_face_cache_hash (table->as_bytes ()) : 0;
+    section->offset = start;
+    section->length = data.length - start;
+    section->hash = _hb_ot_face_cache_hash (data.as_array ().sub_array (start));
+    /* Keep every section aligned. */
+    data.resize ((data.length + 7) & ~7u);
+  }
+
+  /* Sanitizes the @Type table of @face afresh, and appends a stamp for
+   * it to @data if it needed no edits. */
+  template <typename Type>
+  void add_stamp (hb_face_t *face)
+  {
+    hb_sanitize_context_t c;
+    c.set_num_glyphs (hb_face_get_glyph_count (face));
+    hb_blob_t *table = c.sanitize_blob<Type> (hb_face_reference_table (face, Type::tableTag));
+    if (table->length && !c.was_edited ())
+    {
+      hb_ot_face_cache_stamp_t stamp;
+      stamp.tag = Type::tableTag;
+      stamp.table_length = table->length;
+      stamp.num_glyphs = hb_face_get_glyph_count (face);
+      stamp.reserved = 0;
+      stamp.table_hash = _hb_ot_face_cache_hash64 (table->as_bytes ());
+      unsigned int start = data.length;
+      if (likely (data.resize (start + sizeof (stamp))))
+	memcpy (data.arrayZ + start, &stamp, sizeof (stamp));
+    }
+    hb_blob_destroy (table);
+  }
+
+  hb_blob_t *finish ()
+  {
+    hb_ot_face_cache_header_t header;
+    header.magic = HB_OT_FACE_CACHE_MAGIC;
+    header.version = HB_OT_FACE_CACHE_VERSION;
+    header.digest_size = sizeof (hb_set_digest_t);
+    header.section_count = sections.length;
+    header.build = _hb_ot_face_cache_build_fingerprint ();
+
+    unsigned int data_start = (sizeof (header) + sections.length * sizeof (hb_ot_face_cache_section_t) + 7) & ~7u;
+    unsigned int length = data_start + data.length;
+    if (unlikely (sections.in_error () || data.in_error ())) return hb_blob_get_empty ();
+    char *blob_data = (char *) calloc (length, 1);
+    if (unlikely (!blob_data)) return hb_blob_get_empty ();
+
+    memcpy (blob_data, &header, sizeof (header));
+    for (unsigned int i = 0; i < sections.length; i++)
+    {
+      sections[i].offset += data_start;
+      memcpy (blob_data + sizeof (header) + i * sizeof (sections[i]), &sections[i], sizeof (sections[i]));
+    }
+    if (data.length) memcpy (blob_data + data_start, data.arrayZ, data.length);
+
+    return hb_blob_create (blob_data, length, HB_MEMORY_MODE_WRITABLE, blob_data, free);
+  }
+
+  hb_vector_t<hb_ot_face_cache_section_t> sections;
+  hb_vector_t<char> data;
+};
+
+hb_blob_t *hb_ot_face_t::build_cache ()
+{
+  hb_ot_face_reader_t reader (*this);
+  hb_ot_face_cache_builder_t c;
+  unsigned int start;
+
+#ifndef HB_NO_OT_FONT_GLYPH_NAMES
+  start = c.data.length;
+  if (post->save_cache (c.data))
+    c.add_section (HB_OT_TAG_post, post->table.get_blob (), start);
+#endif
+
+#ifndef HB_NO_OT_LAYOUT
+  start = c.data.length;
+  if (GSUB->save_cache (c.data))
+    c.add_section (HB_OT_TAG_GSUB, GSUB->table.get_blob (), start);
+  start = c.data.length;
+  if (GPOS->save_cache (c.data))
+    c.add_section (HB_OT_TAG_GPOS, GPOS->table.get_blob (), start);
+#endif
+
+  /* The tables whose sanitize() walks all of them. */
+  start = c.data.length;
+#if !defined(HB_NO_FACE_COLLECT_UNICODES) || !defined(HB_NO_OT_FONT)
+  c.add_stamp<OT::cmap> (face);
+#endif
+#ifndef HB_NO_CFF
+  c.add_stamp<OT::cff1> (face);
+  c.add_stamp<OT::cff2> (face);
+#endif
+#ifndef HB_NO_OT_KERN
+  c.add_stamp<OT::kern> (face);
+#endif
+#ifndef HB_NO_OT_LAYOUT
+  c.add_stamp<OT::GDEF> (face);
+  c.add_stamp<OT::GSUB> (face);
+  c.add_stamp<OT::GPOS> (face);
+#endif
+  c.add_section (HB_OT_FACE_CACHE_STAMPS, nullptr, start);
+
+  return c.finish ();
 }
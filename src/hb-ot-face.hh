@@ -50,6 +50,28 @@ struct hb_ot_face_t
   HB_INTERNAL void init0 (hb_face_t *face);
   HB_INTERNAL void fini ();
 
+  /* Accelerator cache; see hb_face_set_accelerator_cache(). */
+  HB_INTERNAL bool set_cache (hb_blob_t *blob, bool trusted);
+  HB_INTERNAL hb_blob_t *build_cache ();
+  /* The cached data for @tag, if it was built from the same @table. */
+  HB_INTERNAL hb_bytes_t get_cache_section (hb_tag_t tag, hb_blob_t *table) const;
+  /* Whether a trusted cache records @table as sane with @num_glyphs. */
+  HB_INTERNAL bool is_sanitized (hb_tag_t tag, hb_blob_t *table, unsigned int num_glyphs) const;
+
+  /* Memory accounting; see hb_face_get_memory_usage(). */
+  HB_INTERNAL void get_memory_usage (hb_vector_t<hb_memory_usage_t> &usage) const;
+  /* This *must* be called when there are no other threads accessing. */
+  HB_INTERNAL void drop_accelerators ();
+
+  /* Trimming; see hb_face_trim(). */
+  HB_INTERNAL unsigned int trim (unsigned int since);
+  void note_use (unsigned int order) const
+  {
+    int current = generation.get_relaxed ();
+    if (last_used[order].get_relaxed () != current)
+      last_used[order].set_relaxed (current);
+  }
+
 #define HB_OT_TABLE_ORDER(Namespace, Type) \
     HB_PASTE (ORDER_, HB_PASTE (Namespace, HB_PASTE (_, Type)))
   enum order_t
@@ -58,7 +80,28 @@ struct hb_ot_face_t
 #define HB_OT_TABLE(Namespace, Type) HB_OT_TABLE_ORDER (Namespace, Type),
 #include "hb-ot-face-table-list.hh"
 #undef HB_OT_TABLE
+    ORDER_COUNT
+  };
+
+  hb_blob_t *cache;
+  bool cache_trusted;
+
+  /* Instances detached by trim(), freed once no read section that could
+   * have picked them up is open. */
+  struct retired_t
+  {
+    void *instance;
+    void (*destroy) (void *instance);
+    hb_tag_t tag;
+    unsigned int order;
+    int last_used;
+    unsigned int drained; /* Phases seen with no readers since. */
   };
+  hb_mutex_t trim_lock;
+  hb_vector_t<retired_t> retired;
+  mutable hb_atomic_int_t generation;
+  mutable hb_atomic_int_t last_used[ORDER_COUNT];
+  mutable hb_reader_phases_t readers; /* See hb_ot_face_reader_t. */
 
   hb_face_t *face; /* MUST be JUST before the lazy loaders. */
 #define HB_OT_TABLE(Namespace, Type) \
@@ -70,5 +113,22 @@ struct hb_ot_face_t
 #undef HB_OT_TABLE
 };
 
+/* Keeps what hb_face_trim() detaches from the tables of a face from being
+ * freed while in scope.  Every public entry point that reads the tables of
+ * a face, directly or through its font functions, opens one for the length
+ * of the call; nested ones are fine. */
+struct hb_ot_face_reader_t
+{
+  hb_ot_face_reader_t (const hb_ot_face_t &ot_face_) :
+    /* The empty face has nothing to trim, and is read-only. */
+    ot_face (ot_face_.face ? &ot_face_ : nullptr),
+    phase (ot_face ? ot_face->readers.enter () : 0) {}
+  ~hb_ot_face_reader_t () { if (ot_face) ot_face->readers.leave (phase); }
+
+  private:
+  const hb_ot_face_t *ot_face;
+  unsigned int phase;
+};
+
 
 #endif /* HB_OT_FACE_HH */
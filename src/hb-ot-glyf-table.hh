@@ -35,6 +35,7 @@
 #include "hb-ot-hmtx-table.hh"
 #include "hb-ot-var-gvar-table.hh"
 #include "hb-draw.hh"
+#include "hb-cache.hh"
 
 namespace OT {
 
@@ -86,83 +87,59 @@ struct glyf
     return_trace (true);
   }
 
-  template<typename Iterator,
-	   hb_requires (hb_is_source_of (Iterator, unsigned int))>
   static bool
-  _add_loca_and_head (hb_subset_plan_t * plan, Iterator padded_offsets)
+  _add_loca_and_head (hb_subset_context_t *c,
+		      char *loca_prime_data,
+		      unsigned loca_prime_length,
+		      bool use_short_loca)
   {
-    unsigned max_offset =
-    + padded_offsets
-    | hb_reduce (hb_add, 0)
-    ;
-    unsigned num_offsets = padded_offsets.len () + 1;
-    bool use_short_loca = max_offset < 0x1FFFF;
-    unsigned entry_size = use_short_loca ? 2 : 4;
-    char *loca_prime_data = (char *) calloc (entry_size, num_offsets);
-
-    if (unlikely (!loca_prime_data)) return false;
-
-    DEBUG_MSG (SUBSET, nullptr, "loca entry_size %d num_offsets %d "
-				"max_offset %d size %d",
-	       entry_size, num_offsets, max_offset, entry_size * num_offsets);
-
-    if (use_short_loca)
-      _write_loca (padded_offsets, 1, hb_array ((HBUINT16 *) loca_prime_data, num_offsets));
-    else
-      _write_loca (padded_offsets, 0, hb_array ((HBUINT32 *) loca_prime_data, num_offsets));
-
     hb_blob_t *loca_blob = hb_blob_create (loca_prime_data,
-					   entry_size * num_offsets,
+					   loca_prime_length,
 					   HB_MEMORY_MODE_WRITABLE,
 					   loca_prime_data,
 					   free);
 
-    bool result = plan->add_table (HB_OT_TAG_loca, loca_blob)
-	       && _add_head_and_set_loca_version (plan, use_short_loca);
+    bool result = c->add_table (HB_OT_TAG_loca, loca_blob)
+	       && _add_head_and_set_loca_version (c, use_short_loca);
 
     hb_blob_destroy (loca_blob);
     return result;
   }
 
-  template<typename IteratorIn, typename IteratorOut,
-	   hb_requires (hb_is_source_of (IteratorIn, unsigned int)),
-	   hb_requires (hb_is_sink_of (IteratorOut, unsigned))>
-  static void
-  _write_loca (IteratorIn it, unsigned right_shift, IteratorOut dest)
-  {
-    unsigned int offset = 0;
-    dest << 0;
-    + it
-    | hb_map ([=, &offset] (unsigned int padded_size)
-	      {
-		offset += padded_size;
-		DEBUG_MSG (SUBSET, nullptr, "loca entry offset %d", offset);
-		return offset >> right_shift;
-	      })
-    | hb_sink (dest)
-    ;
-  }
-
-  /* requires source of SubsetGlyph complains the identifier isn't declared */
+  /* Writes all glyphs with a single allocation, filling in loca
+   * (num_glyphs + 1 entries of the given format) as it goes. */
   template <typename Iterator>
   bool serialize (hb_serialize_context_t *c,
 		  Iterator it,
+		  unsigned glyf_size,
+		  bool use_short_loca,
+		  char *loca_prime_data,
 		  const hb_subset_plan_t *plan)
   {
     TRACE_SERIALIZE (this);
-    unsigned init_len = c->length ();
-    for (const auto &_ : it) _.serialize (c, plan);
 
     /* As a special case when all glyph in the font are empty, add a zero byte
      * to the table, so that OTS doesn’t reject it, and to make the table work
      * on Windows as well.
      * See https://github.com/khaledhosny/ots/issues/52 */
-    if (init_len == c->length ())
+    char *dest = c->allocate_size<char> (hb_max (glyf_size, 1u));
+    if (unlikely (!dest)) return_trace (false);
+
+    HBUINT16 *loca_short = (HBUINT16 *) loca_prime_data;
+    HBUINT32 *loca_long = (HBUINT32 *) loca_prime_data;
+    unsigned offset = 0;
+    unsigned i = 0;
+    for (const auto &_ : it)
     {
-      HBUINT8 empty_byte;
-      empty_byte = 0;
-      c->copy (empty_byte);
+      /* Padding is already zero. */
+      _.serialize (dest + offset, plan);
+      offset += _.padded_size ();
+      i++;
+      if (use_short_loca) loca_short[i] = offset >> 1;
+      else                loca_long[i] = offset;
     }
+    DEBUG_MSG (SUBSET, nullptr, "glyf size %d, %d loca entries", offset, i + 1);
+
     return_trace (true);
   }
 
@@ -173,22 +150,37 @@ struct glyf
   {
     TRACE_SUBSET (this);
 
-    glyf *glyf_prime = c->serializer->start_embed <glyf> ();
-    if (unlikely (!c->serializer->check_success (glyf_prime))) return_trace (false);
-
     hb_vector_t<SubsetGlyph> glyphs;
     _populate_subset_glyphs (c->plan, &glyphs);
 
-    glyf_prime->serialize (c->serializer, hb_iter (glyphs), c->plan);
+    unsigned glyf_size = 0;
+    for (unsigned i = 0; i < glyphs.length; i++)
+      glyf_size += glyphs[i].padded_size ();
+    if (unlikely (!c->ensure_room (glyf_size))) return_trace (false);
 
-    auto padded_offsets =
-    + hb_iter (glyphs)
-    | hb_map (&SubsetGlyph::padded_size)
-    ;
+    bool use_short_loca = glyf_size < 0x1FFFF;
+    unsigned entry_size = use_short_loca ? 2 : 4;
+    unsigned num_offsets = glyphs.length + 1;
+    char *loca_prime_data = (char *) calloc (entry_size, num_offsets);
+    if (unlikely (!loca_prime_data)) return_trace (false);
 
-    if (c->serializer->in_error ()) return_trace (false);
-    return_trace (c->serializer->check_success (_add_loca_and_head (c->plan,
-								    padded_offsets)));
+    DEBUG_MSG (SUBSET, nullptr, "loca entry_size %d num_offsets %d "
+				"max_offset %d size %d",
+	       entry_size, num_offsets, glyf_size, entry_size * num_offsets);
+
+    glyf *glyf_prime = c->serializer->start_embed <glyf> ();
+    if (unlikely (!glyf_prime->serialize (c->serializer, hb_iter (glyphs),
+					  glyf_size, use_short_loca,
+					  loca_prime_data, c->plan)))
+    {
+      free (loca_prime_data);
+      return_trace (false);
+    }
+
+    return_trace (c->serializer->check_success (_add_loca_and_head (c,
+								    loca_prime_data,
+								    entry_size * num_offsets,
+								    use_short_loca)));
   }
 
   template <typename SubsetGlyph>
@@ -222,9 +214,9 @@ struct glyf
   }
 
   static bool
-  _add_head_and_set_loca_version (hb_subset_plan_t *plan, bool use_short_loca)
+  _add_head_and_set_loca_version (hb_subset_context_t *c, bool use_short_loca)
   {
-    hb_blob_t *head_blob = hb_sanitize_context_t ().reference_table<head> (plan->source);
+    hb_blob_t *head_blob = hb_sanitize_context_t ().reference_table<head> (c->plan->source);
     hb_blob_t *head_prime_blob = hb_blob_copy_writable_or_fail (head_blob);
     hb_blob_destroy (head_blob);
 
@@ -233,7 +225,7 @@ struct glyf
 
     head *head_prime = (head *) hb_blob_get_data_writable (head_prime_blob, nullptr);
     head_prime->indexToLocFormat = use_short_loca ? 0 : 1;
-    bool success = plan->add_table (HB_OT_TAG_head, head_prime_blob);
+    bool success = c->add_table (HB_OT_TAG_head, head_prime_blob);
 
     hb_blob_destroy (head_prime_blob);
     return success;
@@ -301,7 +293,7 @@ struct glyf
       }
     }
 
-    void transform_points (contour_point_vector_t &points) const
+    void transform_points (hb_array_t<contour_point_t> points) const
     {
       float matrix[4];
       contour_point_t trans;
@@ -309,13 +301,13 @@ struct glyf
       {
 	if (scaled_offsets ())
 	{
-	  points.translate (trans);
-	  points.transform (matrix);
+	  contour_point_vector_t::translate (points, trans);
+	  contour_point_vector_t::transform (points, matrix);
 	}
 	else
 	{
-	  points.transform (matrix);
-	  points.translate (trans);
+	  contour_point_vector_t::transform (points, matrix);
+	  contour_point_vector_t::translate (points, trans);
 	}
       }
     }
@@ -423,6 +415,88 @@ struct glyf
 
   struct accelerator_t;
 
+  /* Memory used while loading glyph points.  Components are loaded straight
+   * into all_points; each nesting level keeps its own points in levels[].
+   * Reusing one scratch for a run of glyphs means the vectors only grow to
+   * the largest glyph once, instead of being allocated per glyph and per
+   * component. */
+  struct points_scratch_t
+  {
+    void init ()
+    {
+      all_points.init ();
+      levels.init ();
+#ifndef HB_NO_VAR
+      deltas.init ();
+#endif
+    }
+    void fini ()
+    {
+      all_points.fini ();
+      levels.fini_deep ();
+#ifndef HB_NO_VAR
+      deltas.fini ();
+#endif
+    }
+
+    contour_point_vector_t all_points;
+    hb_vector_t<contour_point_vector_t> levels;
+#ifndef HB_NO_VAR
+    gvar::accelerator_t::scratch_t deltas;
+#endif
+  };
+
+#ifndef HB_GLYF_POINTS_CACHE_MAX_BYTES
+#define HB_GLYF_POINTS_CACHE_MAX_BYTES (4u << 20)
+#endif
+
+  /* Per-face cache of the flattened points of composite glyphs and of the
+   * glyphs used as their components, phantom points included, as loaded
+   * without variations.  Filled lazily and lock-free; once
+   * HB_GLYF_POINTS_CACHE_MAX_BYTES worth of points are cached, the
+   * remaining glyphs are loaded on every call as before. */
+  struct points_cache_t
+  {
+    struct points_t
+    {
+      hb_array_t<const contour_point_t> as_array () const
+      { return hb_array (arrayZ, length); }
+
+      static void destroy (points_t *points) { free (points); }
+
+      unsigned int length;
+      contour_point_t arrayZ[HB_VAR_ARRAY];
+    };
+
+    void init (unsigned int num_glyphs) { cache.init (num_glyphs); }
+    void fini () { cache.fini (); }
+
+    const points_t *get (hb_codepoint_t glyph) const { return cache.get (glyph); }
+
+    void set (hb_codepoint_t glyph, hb_array_t<const contour_point_t> points) const
+    {
+      unsigned int size = sizeof (points_t) + points.get_size ();
+      if (!cache.reserve (glyph, size)) return;
+
+      points_t *p = (points_t *) malloc (size);
+      if (unlikely (!p))
+      {
+	cache.release (size);
+	return;
+      }
+      p->length = points.length;
+      for (unsigned int i = 0; i < points.length; i++)
+	p->arrayZ[i] = points[i];
+
+      cache.set (glyph, p, size);
+    }
+
+    unsigned int get_memory_usage () const { return cache.get_memory_usage (); }
+
+    private:
+    hb_glyph_cache_t<points_t, HB_GLYF_POINTS_CACHE_MAX_BYTES> cache;
+  };
+
   struct Glyph
   {
     enum simple_glyph_flag_t
@@ -447,7 +521,7 @@ struct glyf
       {
 	/* Undocumented rasterizer behavior: shift glyph to the left by (lsb - xMin), i.e., xMin = lsb */
 	/* extents->x_bearing = hb_min (glyph_header.xMin, glyph_header.xMax); */
-	extents->x_bearing = font->em_scale_x (glyf_accelerator.hmtx->get_side_bearing (gid));
+	extents->x_bearing = font->em_scale_x (glyf_accelerator.face->table.hmtx->get_side_bearing (gid));
 	extents->y_bearing = font->em_scale_y (hb_max (yMin, yMax));
 	extents->width     = font->em_scale_x (hb_max (xMin, xMax) - hb_min (xMin, xMax));
 	extents->height    = font->em_scale_y (hb_min (yMin, yMax) - hb_max (yMin, yMax));
@@ -492,6 +566,19 @@ struct glyf
 	return instructionLength;
       }
 
+      /* Number of x and y coordinate bytes a point with the given flag uses. */
+      static unsigned int coord_bytes_for_flag (uint8_t flag)
+      {
+	static const uint8_t coord_bytes[64] =
+	{
+	  4, 4, 3, 3, 3, 3, 2, 2, 4, 4, 3, 3, 3, 3, 2, 2,
+	  2, 2, 3, 3, 1, 1, 2, 2, 2, 2, 3, 3, 1, 1, 2, 2,
+	  2, 2, 1, 1, 3, 3, 2, 2, 2, 2, 1, 1, 3, 3, 2, 2,
+	  0, 0, 1, 1, 1, 1, 2, 2, 0, 0, 1, 1, 1, 1, 2, 2,
+	};
+	return coord_bytes[flag & 0x3F];
+      }
+
       const Glyph trim_padding () const
       {
 	/* based on FontTools _g_l_y_f.py::trim */
@@ -513,23 +600,18 @@ struct glyf
 	  uint8_t flag = *glyph;
 	  glyph++;
 
-	  unsigned int repeat = 1;
-	  if (flag & FLAG_REPEAT)
+	  if (likely (!(flag & FLAG_REPEAT)))
 	  {
-	    if (unlikely (glyph >= glyph_end)) return Glyph ();
-	    repeat = *glyph + 1;
-	    glyph++;
+	    coord_bytes += coord_bytes_for_flag (flag);
+	    if (++coords_with_flags >= num_coordinates) break;
+	    continue;
 	  }
 
-	  unsigned int xBytes, yBytes;
-	  xBytes = yBytes = 0;
-	  if (flag & FLAG_X_SHORT) xBytes = 1;
-	  else if ((flag & FLAG_X_SAME) == 0) xBytes = 2;
-
-	  if (flag & FLAG_Y_SHORT) yBytes = 1;
-	  else if ((flag & FLAG_Y_SAME) == 0) yBytes = 2;
+	  if (unlikely (glyph >= glyph_end)) return Glyph ();
+	  unsigned int repeat = *glyph + 1;
+	  glyph++;
 
-	  coord_bytes += (xBytes + yBytes) * repeat;
+	  coord_bytes += coord_bytes_for_flag (flag) * repeat;
 	  coords_with_flags += repeat;
 	  if (coords_with_flags >= num_coordinates) break;
 	}
@@ -705,15 +787,57 @@ struct glyf
     }
 
     /* Note: Recursively calls itself.
-     * all_points includes phantom points
+     * Appends the glyph's points, including phantom points, to all_points.
+     * scratch.levels must have room for HB_MAX_NESTING_LEVEL + 1 levels.
      */
     bool get_points (hb_font_t *font, const accelerator_t &glyf_accelerator,
-		     contour_point_vector_t &all_points /* OUT */,
+		     contour_point_vector_t &all_points /* IN/OUT */,
+		     points_scratch_t &scratch,
 		     bool phantom_only = false,
 		     unsigned int depth = 0) const
     {
       if (unlikely (depth > HB_MAX_NESTING_LEVEL)) return false;
-      contour_point_vector_t points;
+      unsigned int start = all_points.length;
+
+      /* Composites, and the glyphs they are made of, are flattened once
+       * per face and reused, unless variations apply. */
+      bool use_cache = (type == COMPOSITE || depth) && !glyf_accelerator.has_var_points (font);
+      const points_cache_t::points_t *cached = use_cache ? glyf_accelerator.points_cache.get (gid) : nullptr;
+      if (cached)
+	all_points.extend (cached->as_array ());
+      else
+      {
+	if (unlikely (!load_points (font, glyf_accelerator, all_points, scratch, phantom_only, depth)))
+	  return false;
+	if (use_cache && !phantom_only && !all_points.in_error ())
+	  glyf_accelerator.points_cache.set (gid, all_points.sub_array (start));
+      }
+      if (unlikely (all_points.length < start + PHANTOM_COUNT)) return false;
+
+      if (depth == 0) /* Apply at top level */
+      {
+	/* Undocumented rasterizer behavior:
+	 * Shift points horizontally by the updated left side bearing
+	 */
+	contour_point_t delta;
+	delta.init (-all_points[all_points.length - PHANTOM_COUNT + PHANTOM_LEFT].x, 0.f);
+	if (delta.x) contour_point_vector_t::translate (all_points.sub_array (start), delta);
+      }
+
+      return true;
+    }
+
+    private:
+    /* Appends the glyph's points to all_points, before the top-level shift. */
+    bool load_points (hb_font_t *font, const accelerator_t &glyf_accelerator,
+		      contour_point_vector_t &all_points /* IN/OUT */,
+		      points_scratch_t &scratch,
+		      bool phantom_only,
+		      unsigned int depth) const
+    {
+      unsigned int start = all_points.length;
+      contour_point_vector_t &points = scratch.levels[depth];
+      points.resize (0);
 
       switch (type) {
       case COMPOSITE:
@@ -736,10 +860,10 @@ struct glyf
       hb_array_t<contour_point_t> phantoms = points.sub_array (points.length - PHANTOM_COUNT, PHANTOM_COUNT);
       {
 	for (unsigned i = 0; i < PHANTOM_COUNT; ++i) phantoms[i].init ();
-	int h_delta = (int) header->xMin - glyf_accelerator.hmtx->get_side_bearing (gid);
-	int v_orig  = (int) header->yMax + glyf_accelerator.vmtx->get_side_bearing (gid);
-	unsigned h_adv = glyf_accelerator.hmtx->get_advance (gid);
-	unsigned v_adv = glyf_accelerator.vmtx->get_advance (gid);
+	int h_delta = (int) header->xMin - glyf_accelerator.face->table.hmtx->get_side_bearing (gid);
+	int v_orig  = (int) header->yMax + glyf_accelerator.face->table.vmtx->get_side_bearing (gid);
+	unsigned h_adv = glyf_accelerator.face->table.hmtx->get_advance (gid);
+	unsigned v_adv = glyf_accelerator.face->table.vmtx->get_advance (gid);
 	phantoms[PHANTOM_LEFT].x = h_delta;
 	phantoms[PHANTOM_RIGHT].x = h_adv + h_delta;
 	phantoms[PHANTOM_TOP].y = v_orig;
@@ -747,7 +871,8 @@ struct glyf
       }
 
 #ifndef HB_NO_VAR
-      if (unlikely (!glyf_accelerator.gvar->apply_deltas_to_points (gid, font, points.as_array ())))
+      if (unlikely (!glyf_accelerator.face->table.gvar->apply_deltas_to_points (gid, font, points.as_array (),
+								   &scratch.deltas)))
 	return false;
 #endif
 
@@ -760,12 +885,13 @@ struct glyf
 	unsigned int comp_index = 0;
 	for (auto &item : get_composite_iterator ())
 	{
-	  contour_point_vector_t comp_points;
+	  unsigned int comp_start = all_points.length;
 	  if (unlikely (!glyf_accelerator.glyph_for_gid (item.get_glyph_index ())
-					 .get_points (font, glyf_accelerator, comp_points,
-			 			      phantom_only, depth + 1)
-			|| comp_points.length < PHANTOM_COUNT))
+					 .get_points (font, glyf_accelerator, all_points, scratch,
+						      phantom_only, depth + 1)
+			|| all_points.length < comp_start + PHANTOM_COUNT))
 	    return false;
+	  hb_array_t<contour_point_t> comp_points = all_points.sub_array (comp_start);
 
 	  /* Copy phantom points from component if USE_MY_METRICS flag set */
 	  if (item.is_use_my_metrics ())
@@ -776,23 +902,24 @@ struct glyf
 	  item.transform_points (comp_points);
 
 	  /* Apply translation from gvar */
-	  comp_points.translate (points[comp_index]);
+	  contour_point_vector_t::translate (comp_points, points[comp_index]);
 
 	  if (item.is_anchored ())
 	  {
 	    unsigned int p1, p2;
 	    item.get_anchor_points (p1, p2);
-	    if (likely (p1 < all_points.length && p2 < comp_points.length))
+	    if (likely (p1 < comp_start - start && p2 < comp_points.length))
 	    {
 	      contour_point_t delta;
-	      delta.init (all_points[p1].x - comp_points[p2].x,
-			  all_points[p1].y - comp_points[p2].y);
+	      delta.init (all_points[start + p1].x - comp_points[p2].x,
+			  all_points[start + p1].y - comp_points[p2].y);
 
-	      comp_points.translate (delta);
+	      contour_point_vector_t::translate (comp_points, delta);
 	    }
 	  }
 
-	  all_points.extend (comp_points.sub_array (0, comp_points.length - PHANTOM_COUNT));
+	  /* Drop the component's phantom points */
+	  all_points.resize (all_points.length - PHANTOM_COUNT);
 
 	  comp_index++;
 	}
@@ -803,19 +930,10 @@ struct glyf
 	all_points.extend (phantoms);
       }
 
-      if (depth == 0) /* Apply at top level */
-      {
-	/* Undocumented rasterizer behavior:
-	 * Shift points horizontally by the updated left side bearing
-	 */
-	contour_point_t delta;
-	delta.init (-phantoms[PHANTOM_LEFT].x, 0.f);
-	if (delta.x) all_points.translate (delta);
-      }
-
       return true;
     }
 
+    public:
     bool get_extents (hb_font_t *font, const accelerator_t &glyf_accelerator,
 		      hb_glyph_extents_t *extents) const
     {
@@ -848,13 +966,9 @@ struct glyf
     {
       short_offset = false;
       num_glyphs = 0;
+      points_cache.init (0);
       loca_table = nullptr;
       glyf_table = nullptr;
-#ifndef HB_NO_VAR
-      gvar = nullptr;
-#endif
-      hmtx = nullptr;
-      vmtx = nullptr;
       face = face_;
       const OT::head &head = *face->table.head;
       if (head.indexToLocFormat > 1 || head.glyphDataFormat > 0)
@@ -864,36 +978,45 @@ struct glyf
 
       loca_table = hb_sanitize_context_t ().reference_table<loca> (face);
       glyf_table = hb_sanitize_context_t ().reference_table<glyf> (face);
-#ifndef HB_NO_VAR
-      gvar = face->table.gvar;
-#endif
-      hmtx = face->table.hmtx;
-      vmtx = face->table.vmtx;
-
       num_glyphs = hb_max (1u, loca_table.get_length () / (short_offset ? 2 : 4)) - 1;
       num_glyphs = hb_min (num_glyphs, face->get_num_glyphs ());
+
+      points_cache.init (num_glyphs);
     }
 
     void fini ()
     {
+      points_cache.fini ();
       loca_table.destroy ();
       glyf_table.destroy ();
     }
 
+    unsigned int get_memory_usage () const
+    { return points_cache.get_memory_usage (); }
+
+    /* Whether gvar deltas apply to points loaded for font. */
+    bool has_var_points (hb_font_t *font HB_UNUSED) const
+    {
+#ifndef HB_NO_VAR
+      return font->num_coords && font->num_coords == face->table.gvar->get_axis_count ();
+#else
+      return false;
+#endif
+    }
+
     protected:
     template<typename T>
-    bool get_points (hb_font_t *font, hb_codepoint_t gid, T consumer) const
+    bool get_points (hb_font_t *font, hb_codepoint_t gid, T consumer,
+		     points_scratch_t &scratch) const
     {
       if (gid >= num_glyphs) return false;
 
-      /* Making this alloc free is not that easy
-	 https://github.com/harfbuzz/harfbuzz/issues/2095
-	 mostly because of gvar handling in VF fonts,
-	 perhaps a separate path for non-VF fonts can be considered */
-      contour_point_vector_t all_points;
+      if (unlikely (!scratch.levels.resize (HB_MAX_NESTING_LEVEL + 1))) return false;
+      contour_point_vector_t &all_points = scratch.all_points;
+      all_points.resize (0);
 
       bool phantom_only = !consumer.is_consuming_contour_points ();
-      if (unlikely (!glyph_for_gid (gid).get_points (font, *this, all_points, phantom_only)))
+      if (unlikely (!glyph_for_gid (gid).get_points (font, *this, all_points, scratch, phantom_only)))
 	return false;
 
       if (consumer.is_consuming_contour_points ())
@@ -912,6 +1035,20 @@ struct glyf
       return true;
     }
 
+    template<typename T>
+    bool get_points (hb_font_t *font, hb_codepoint_t gid, T consumer) const
+    {
+      /* Making this alloc free is not that easy
+	 https://github.com/harfbuzz/harfbuzz/issues/2095
+	 mostly because of gvar handling in VF fonts.  Callers handling
+	 many glyphs can pass their own scratch instead. */
+      points_scratch_t scratch;
+      scratch.init ();
+      bool ret = get_points (font, gid, consumer, scratch);
+      scratch.fini ();
+      return ret;
+    }
+
 #ifndef HB_NO_VAR
     struct points_aggregator_t
     {
@@ -977,11 +1114,11 @@ struct glyf
       bool success = false;
 
       contour_point_t phantoms[PHANTOM_COUNT];
-      if (likely (font->num_coords == gvar->get_axis_count ()))
+      if (likely (font->num_coords == face->table.gvar->get_axis_count ()))
 	success = get_points (font, gid, points_aggregator_t (font, nullptr, phantoms));
 
       if (unlikely (!success))
-	return is_vertical ? vmtx->get_advance (gid) : hmtx->get_advance (gid);
+	return is_vertical ? face->table.vmtx->get_advance (gid) : face->table.hmtx->get_advance (gid);
 
       float result = is_vertical
 		   ? phantoms[PHANTOM_TOP].y - phantoms[PHANTOM_BOTTOM].y
@@ -997,7 +1134,7 @@ struct glyf
 
       contour_point_t phantoms[PHANTOM_COUNT];
       if (unlikely (!get_points (font, gid, points_aggregator_t (font, &extents, phantoms))))
-	return is_vertical ? vmtx->get_side_bearing (gid) : hmtx->get_side_bearing (gid);
+	return is_vertical ? face->table.vmtx->get_side_bearing (gid) : face->table.hmtx->get_side_bearing (gid);
 
       return is_vertical
 	   ? ceilf (phantoms[PHANTOM_TOP].y) - extents.y_bearing
@@ -1011,7 +1148,7 @@ struct glyf
       if (unlikely (gid >= num_glyphs)) return false;
 
 #ifndef HB_NO_VAR
-      if (font->num_coords && font->num_coords == gvar->get_axis_count ())
+      if (font->num_coords && font->num_coords == face->table.gvar->get_axis_count ())
 	return get_points (font, gid, points_aggregator_t (font, extents, nullptr));
 #endif
       return glyph_for_gid (gid).get_extents (font, *this, extents);
@@ -1178,20 +1315,23 @@ struct glyf
     bool
     get_path (hb_font_t *font, hb_codepoint_t gid, draw_helper_t &draw_helper) const
     { return get_points (font, gid, path_builder_t (font, draw_helper)); }
-#endif
 
-#ifndef HB_NO_VAR
-    const gvar_accelerator_t *gvar;
+    bool
+    get_path (hb_font_t *font, hb_codepoint_t gid, draw_helper_t &draw_helper,
+	      points_scratch_t &scratch) const
+    { return get_points (font, gid, path_builder_t (font, draw_helper), scratch); }
 #endif
-    const hmtx_accelerator_t *hmtx;
-    const vmtx_accelerator_t *vmtx;
+
+    /* gvar, hmtx and vmtx are looked up through this on every use, as
+     * hb_face_trim() may release them while glyf stays loaded. */
+    hb_face_t *face;
+    points_cache_t points_cache;
 
     private:
     bool short_offset;
     unsigned int num_glyphs;
     hb_blob_ptr_t<loca> loca_table;
     hb_blob_ptr_t<glyf> glyf_table;
-    hb_face_t *face;
   };
 
   struct SubsetGlyph
@@ -1202,25 +1342,18 @@ struct glyf
     hb_bytes_t dest_start;  /* region of source_glyph to copy first */
     hb_bytes_t dest_end;    /* region of source_glyph to copy second */
 
-    bool serialize (hb_serialize_context_t *c,
+    /* Copies the glyph to dest, which has room for padded_size () bytes. */
+    void serialize (char *dest,
 		    const hb_subset_plan_t *plan) const
     {
-      TRACE_SERIALIZE (this);
-
-      hb_bytes_t dest_glyph = dest_start.copy (c);
-      dest_glyph = hb_bytes_t (&dest_glyph, dest_glyph.length + dest_end.copy (c).length);
-      unsigned int pad_length = padding ();
-      DEBUG_MSG (SUBSET, nullptr, "serialize %d byte glyph, width %d pad %d", dest_glyph.length, dest_glyph.length + pad_length, pad_length);
+      unsigned int glyph_length = length ();
+      DEBUG_MSG (SUBSET, nullptr, "serialize %d byte glyph, pad %d", glyph_length, padding ());
+      if (unlikely (!glyph_length)) return;
 
-      HBUINT8 pad;
-      pad = 0;
-      while (pad_length > 0)
-      {
-	c->embed (pad);
-	pad_length--;
-      }
-
-      if (unlikely (!dest_glyph.length)) return_trace (true);
+      memcpy (dest, dest_start.arrayZ, dest_start.length);
+      if (dest_end.length)
+	memcpy (dest + dest_start.length, dest_end.arrayZ, dest_end.length);
+      hb_bytes_t dest_glyph (dest, glyph_length);
 
       /* update components gids */
       for (auto &_ : Glyph (dest_glyph).get_composite_iterator ())
@@ -1231,8 +1364,6 @@ struct glyf
       }
 
       if (plan->drop_hints) Glyph (dest_glyph).drop_hints ();
-
-      return_trace (true);
     }
 
     void drop_hints_bytes ()
@@ -118,6 +118,9 @@ struct hdmx
   {
     TRACE_SUBSET (this);
 
+    if (unlikely (!c->ensure_room (min_size + numRecords * DeviceRecord::get_size (c->plan->num_output_glyphs ()))))
+      return_trace (false);
+
     hdmx *hdmx_prime = c->serializer->start_embed <hdmx> ();
     if (unlikely (!hdmx_prime)) return_trace (false);
 
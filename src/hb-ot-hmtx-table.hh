@@ -73,10 +73,10 @@ struct hmtxvmtx
   }
 
 
-  bool subset_update_header (hb_subset_plan_t *plan,
+  bool subset_update_header (hb_subset_context_t *c,
 			     unsigned int num_hmetrics) const
   {
-    hb_blob_t *src_blob = hb_sanitize_context_t ().reference_table<H> (plan->source, H::tableTag);
+    hb_blob_t *src_blob = hb_sanitize_context_t ().reference_table<H> (c->plan->source, H::tableTag);
     hb_blob_t *dest_blob = hb_blob_copy_writable_or_fail (src_blob);
     hb_blob_destroy (src_blob);
 
@@ -88,7 +88,7 @@ struct hmtxvmtx
     H *table = (H *) hb_blob_get_data (dest_blob, &length);
     table->numberOfLongMetrics = num_hmetrics;
 
-    bool result = plan->add_table (H::tableTag, dest_blob);
+    bool result = c->add_table (H::tableTag, dest_blob);
     hb_blob_destroy (dest_blob);
 
     return result;
@@ -124,6 +124,10 @@ struct hmtxvmtx
   {
     TRACE_SUBSET (this);
 
+    /* At most one LongMetric per glyph. */
+    if (unlikely (!c->ensure_room (c->plan->num_output_glyphs () * LongMetric::static_size)))
+      return_trace (false);
+
     T *table_prime = c->serializer->start_embed <T> ();
     if (unlikely (!table_prime)) return_trace (false);
 
@@ -150,7 +154,7 @@ struct hmtxvmtx
       return_trace (false);
 
     // Amend header num hmetrics
-    if (unlikely (!subset_update_header (c->plan, num_advances)))
+    if (unlikely (!subset_update_header (c, num_advances)))
       return_trace (false);
 
     return_trace (true);
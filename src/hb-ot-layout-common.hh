@@ -1135,11 +1135,19 @@ struct Lookup
     | hb_apply (subset_offset_array (c, out->get_subtables<TSubTable> (), this, lookup_type))
     ;
 
+    if (lookupFlag & LookupFlag::UseMarkFilteringSet)
+    {
+      if (unlikely (!c->serializer->extend (out))) return_trace (false);
+      const HBUINT16 &markFilteringSet = StructAfter<HBUINT16> (subTable);
+      HBUINT16 &outMarkFilteringSet = StructAfter<HBUINT16> (out->subTable);
+      outMarkFilteringSet = markFilteringSet;
+    }
+
     return_trace (true);
   }
 
-  template <typename TSubTable>
-  bool sanitize (hb_sanitize_context_t *c) const
+  /* Sanitizes the lookup but not its subtables. */
+  bool sanitize_shallow (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
     if (!(c->check_struct (this) && subTable.sanitize (c))) return_trace (false);
@@ -1152,7 +1160,16 @@ struct Lookup
       const HBUINT16 &markFilteringSet = StructAfter<HBUINT16> (subTable);
       if (!markFilteringSet.sanitize (c)) return_trace (false);
     }
+    return_trace (true);
+  }
 
+  template <typename TSubTable>
+  bool sanitize (hb_sanitize_context_t *c) const
+  {
+    TRACE_SANITIZE (this);
+    if (unlikely (!sanitize_shallow (c))) return_trace (false);
+
+    unsigned subtables = get_subtable_count ();
     if (unlikely (!get_subtables<TSubTable> ().sanitize (c, this, get_type ())))
       return_trace (false);
 
@@ -1233,6 +1250,8 @@ struct CoverageFormat1
     return i;
   }
 
+  unsigned int get_population () const { return glyphArray.len; }
+
   template <typename Iterator,
       hb_requires (hb_is_sorted_source_of (Iterator, hb_codepoint_t))>
   bool serialize (hb_serialize_context_t *c, Iterator glyphs)
@@ -1302,6 +1321,16 @@ struct CoverageFormat2
 	 : NOT_COVERED;
   }
 
+  /* From the last range's coverage index; good enough for heuristics. */
+  unsigned int get_population () const
+  {
+    if (unlikely (!rangeRecord.len)) return 0;
+    const RangeRecord &range = rangeRecord[rangeRecord.len - 1];
+    return likely (range.first <= range.last)
+	 ? (unsigned int) range.value + (range.last - range.first) + 1
+	 : 0;
+  }
+
   template <typename Iterator,
       hb_requires (hb_is_sorted_source_of (Iterator, hb_codepoint_t))>
   bool serialize (hb_serialize_context_t *c, Iterator glyphs)
@@ -1472,6 +1501,39 @@ struct Coverage
     }
   }
 
+  unsigned int get_population () const
+  {
+    switch (u.format) {
+    case 1: return u.format1.get_population ();
+    case 2: return u.format2.get_population ();
+    default:return 0;
+    }
+  }
+
+  /* Calls func (glyph, coverage index) for every glyph in glyphs that is
+   * covered.  Looks the glyphs up one by one if there are few enough of
+   * them, instead of walking the whole coverage. */
+  template <typename func_t>
+  void intersected_apply (const hb_set_t *glyphs, func_t &&func) const
+  {
+    unsigned int population = get_population ();
+    if (glyphs->get_population () * hb_bit_storage (population) < population)
+    {
+      for (hb_codepoint_t g = HB_SET_VALUE_INVALID; glyphs->next (&g);)
+      {
+	unsigned int index = get_coverage (g);
+	if (index != NOT_COVERED)
+	  func (g, index);
+      }
+      return;
+    }
+
+    unsigned int index = 0;
+    for (iter_t it = iter (); it; ++it, index++)
+      if (glyphs->has (*it))
+	func (*it, index);
+  }
+
   template <typename Iterator,
       hb_requires (hb_is_sorted_source_of (Iterator, hb_codepoint_t))>
   bool serialize (hb_serialize_context_t *c, Iterator glyphs)
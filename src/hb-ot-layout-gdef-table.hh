@@ -424,6 +424,8 @@ struct MarkGlyphSetsFormat1
   bool covers (unsigned int set_index, hb_codepoint_t glyph_id) const
   { return (this+coverage[set_index]).get_coverage (glyph_id) != NOT_COVERED; }
 
+  unsigned int get_num_sets () const { return coverage.len; }
+
   bool subset (hb_subset_context_t *c) const
   {
     TRACE_SUBSET (this);
@@ -477,6 +479,14 @@ struct MarkGlyphSets
     }
   }
 
+  unsigned int get_num_sets () const
+  {
+    switch (u.format) {
+    case 1: return u.format1.get_num_sets ();
+    default:return 0;
+    }
+  }
+
   bool subset (hb_subset_context_t *c) const
   {
     TRACE_SUBSET (this);
@@ -640,6 +650,16 @@ struct GDEF
   bool subset (hb_subset_context_t *c) const
   {
     TRACE_SUBSET (this);
+
+    /* A ClassDef or Coverage can break up into a range per glyph once the
+     * subset punches holes into it; everything else only shrinks. */
+    unsigned num_glyph_lists = 4;
+    if (version.to_int () >= 0x00010002u)
+      num_glyph_lists += (this+markGlyphSetsDef).get_num_sets ();
+    if (unlikely (!c->ensure_room (c->source_blob->length +
+				   num_glyph_lists * (6 * c->plan->glyphset ()->get_population () + 6))))
+      return_trace (false);
+
     auto *out = c->serializer->embed (*this);
     if (unlikely (!out)) return_trace (false);
 
@@ -49,11 +49,9 @@ struct SingleSubstFormat1
   void closure (hb_closure_context_t *c) const
   {
     unsigned d = deltaGlyphID;
-    + hb_iter (this+coverage)
-    | hb_filter (*c->glyphs)
-    | hb_map ([d] (hb_codepoint_t g) { return (g + d) & 0xFFFFu; })
-    | hb_sink (c->output)
-    ;
+    (this+coverage).intersected_apply (c->glyphs,
+				       [c, d] (hb_codepoint_t g, unsigned)
+				       { c->output->add ((g + d) & 0xFFFFu); });
   }
 
   void closure_lookups (hb_closure_lookups_context_t *c) const {}
@@ -149,11 +147,9 @@ struct SingleSubstFormat2
 
   void closure (hb_closure_context_t *c) const
   {
-    + hb_zip (this+coverage, substitute)
-    | hb_filter (*c->glyphs, hb_first)
-    | hb_map (hb_second)
-    | hb_sink (c->output)
-    ;
+    (this+coverage).intersected_apply (c->glyphs,
+				       [this, c] (hb_codepoint_t, unsigned i)
+				       { if (i < substitute.len) c->output->add (substitute[i]); });
   }
 
   void closure_lookups (hb_closure_lookups_context_t *c) const {}
@@ -390,12 +386,9 @@ struct MultipleSubstFormat1
 
   void closure (hb_closure_context_t *c) const
   {
-    + hb_zip (this+coverage, sequence)
-    | hb_filter (*c->glyphs, hb_first)
-    | hb_map (hb_second)
-    | hb_map (hb_add (this))
-    | hb_apply ([c] (const Sequence &_) { _.closure (c); })
-    ;
+    (this+coverage).intersected_apply (c->glyphs,
+				       [this, c] (hb_codepoint_t, unsigned i)
+				       { (this+sequence[i]).closure (c); });
   }
 
   void closure_lookups (hb_closure_lookups_context_t *c) const {}
@@ -617,12 +610,9 @@ struct AlternateSubstFormat1
 
   void closure (hb_closure_context_t *c) const
   {
-    + hb_zip (this+coverage, alternateSet)
-    | hb_filter (c->glyphs, hb_first)
-    | hb_map (hb_second)
-    | hb_map (hb_add (this))
-    | hb_apply ([c] (const AlternateSet &_) { _.closure (c); })
-    ;
+    (this+coverage).intersected_apply (c->glyphs,
+				       [this, c] (hb_codepoint_t, unsigned i)
+				       { (this+alternateSet[i]).closure (c); });
   }
 
   void closure_lookups (hb_closure_lookups_context_t *c) const {}
@@ -988,12 +978,9 @@ struct LigatureSubstFormat1
 
   void closure (hb_closure_context_t *c) const
   {
-    + hb_zip (this+coverage, ligatureSet)
-    | hb_filter (*c->glyphs, hb_first)
-    | hb_map (hb_second)
-    | hb_map (hb_add (this))
-    | hb_apply ([c] (const LigatureSet &_) { _.closure (c); })
-    ;
+    (this+coverage).intersected_apply (c->glyphs,
+				       [this, c] (hb_codepoint_t, unsigned i)
+				       { (this+ligatureSet[i]).closure (c); });
   }
 
   void closure_lookups (hb_closure_lookups_context_t *c) const {}
@@ -1388,6 +1375,26 @@ struct SubstLookup : Lookup
     return lookup_type_is_reverse (type);
   }
 
+  /* Lookup type, looking through extension subtables. */
+  unsigned int get_effective_type () const
+  {
+    unsigned int type = get_type ();
+    if (unlikely (type == SubTable::Extension))
+      return reinterpret_cast<const ExtensionSubst &> (get_subtable (0)).get_type ();
+    return type;
+  }
+
+  /* Whether closure() substitutes every glyph on its own, so that once it
+   * has been run over a set of glyphs, running it over glyphs added later
+   * is enough. */
+  bool closure_is_per_glyph () const
+  {
+    unsigned int type = get_effective_type ();
+    return type == SubTable::Single ||
+	   type == SubTable::Multiple ||
+	   type == SubTable::Alternate;
+  }
+
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
@@ -1559,6 +1566,8 @@ struct GSUB : GSUBGPOS
 {
   static constexpr hb_tag_t tableTag = HB_OT_TAG_GSUB;
 
+  typedef SubstLookup Lookup;
+
   const SubstLookup& get_lookup (unsigned int i) const
   { return static_cast<const SubstLookup &> (GSUBGPOS::get_lookup (i)); }
 
@@ -1596,19 +1605,19 @@ struct GSUB_accelerator_t : GSUB::accelerator_t {};
 template <typename context_t>
 /*static*/ typename context_t::return_t SubstLookup::dispatch_recurse_func (context_t *c, unsigned int lookup_index)
 {
-  const SubstLookup &l = c->face->table.GSUB.get_relaxed ()->table->get_lookup (lookup_index);
+  const SubstLookup &l = c->face->table.GSUB->get_lookup (lookup_index);
   return l.dispatch (c);
 }
 
 /*static*/ inline hb_closure_lookups_context_t::return_t SubstLookup::dispatch_closure_lookups_recurse_func (hb_closure_lookups_context_t *c, unsigned this_index)
 {
-  const SubstLookup &l = c->face->table.GSUB.get_relaxed ()->table->get_lookup (this_index);
+  const SubstLookup &l = c->face->table.GSUB->get_lookup (this_index);
   return l.closure_lookups (c, this_index);
 }
 
 /*static*/ bool SubstLookup::apply_recurse_func (hb_ot_apply_context_t *c, unsigned int lookup_index)
 {
-  const SubstLookup &l = c->face->table.GSUB.get_relaxed ()->table->get_lookup (lookup_index);
+  const SubstLookup &l = c->face->table.GSUB->get_lookup (lookup_index);
   unsigned int saved_lookup_props = c->lookup_props;
   unsigned int saved_lookup_index = c->lookup_index;
   c->set_lookup_index (lookup_index);
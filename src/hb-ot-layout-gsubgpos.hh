@@ -101,6 +101,8 @@ struct hb_closure_context_t :
   hb_set_t output[1];
   recurse_func_t recurse_func;
   unsigned int nesting_level_left;
+  /* If set, glyphs newly added to glyphs are appended to it, in order. */
+  hb_vector_t<hb_codepoint_t> *added_glyphs;
 
   hb_closure_context_t (hb_face_t *face_,
 			hb_set_t *glyphs_,
@@ -110,6 +112,7 @@ struct hb_closure_context_t :
 			  glyphs (glyphs_),
 			  recurse_func (nullptr),
 			  nesting_level_left (nesting_level_left_),
+			  added_glyphs (nullptr),
 			  done_lookups (done_lookups_),
 			  lookup_count (0)
   {}
@@ -121,6 +124,12 @@ struct hb_closure_context_t :
   void flush ()
   {
     hb_set_del_range (output, face->get_num_glyphs (), hb_set_get_max (output));	/* Remove invalid glyphs. */
+    if (added_glyphs)
+    {
+      output->subtract (glyphs);
+      for (hb_codepoint_t g = HB_SET_VALUE_INVALID; output->next (&g);)
+	added_glyphs->push (g);
+    }
     hb_set_union (glyphs, output);
     hb_set_clear (output);
   }
@@ -130,6 +139,57 @@ struct hb_closure_context_t :
   unsigned int lookup_count;
 };
 
+/* Applies lookups to glyphs over and over until the closure stops growing.
+ * The first time around every lookup is applied in full; after that, the
+ * lookups that substitute glyphs one by one are only applied to the glyphs
+ * added since they last ran, read off added, to which the lookups append
+ * every glyph they add.  Once added fails to grow, it misses glyphs; every
+ * lookup is then applied in full until glyphs stops growing.
+ *
+ * Lookups provides get_count (), is_per_glyph (i), closure (i) and
+ * closure_glyphs (i, new_glyphs); the last two return false to stop, which
+ * is then returned. */
+template <typename Lookups>
+static inline bool
+hb_closure_apply_lookups (Lookups &lookups,
+			  const hb_set_t *glyphs,
+			  const hb_vector_t<hb_codepoint_t> &added)
+{
+  /* For each lookup, how much of added it had seen when it last ran. */
+  hb_vector_t<unsigned int> seen;
+  bool incremental = seen.resize (lookups.get_count ()) && !added.in_error ();
+
+  unsigned int iteration_count = 0;
+  unsigned int added_length, glyphs_length;
+  do
+  {
+    added_length = added.length;
+    glyphs_length = glyphs->get_population ();
+    for (unsigned int i = 0; i < lookups.get_count (); i++)
+    {
+      if (!iteration_count || !incremental || !lookups.is_per_glyph (i))
+      {
+	if (incremental) seen[i] = added.length;
+	if (!lookups.closure (i))
+	  return false;
+	continue;
+      }
+
+      unsigned int first_new = seen[i];
+      seen[i] = added.length;
+      if (first_new == added.length)
+	continue;
+      if (!lookups.closure_glyphs (i, added.as_array ().sub_array (first_new)))
+	return false;
+    }
+    if (unlikely (added.in_error ()))
+      incremental = false;
+  } while (iteration_count++ <= HB_CLOSURE_MAX_STAGES &&
+	   (incremental ? added_length != added.length
+			: glyphs_length != glyphs->get_population ()));
+  return true;
+}
+
 struct hb_closure_lookups_context_t :
        hb_dispatch_context_t<hb_closure_lookups_context_t>
 {
@@ -697,12 +757,13 @@ struct hb_get_subtables_context_t :
   struct hb_applicable_t
   {
     template <typename T>
-    void init (const T &obj_, hb_apply_func_t apply_func_)
+    void init (const T &obj_, hb_apply_func_t apply_func_, bool collect_digest)
     {
       obj = &obj_;
       apply_func = apply_func_;
       digest.init ();
-      obj_.get_coverage ().collect_coverage (&digest);
+      if (collect_digest)
+	obj_.get_coverage ().collect_coverage (&digest);
     }
 
     bool apply (OT::hb_ot_apply_context_t *c) const
@@ -710,6 +771,9 @@ struct hb_get_subtables_context_t :
       return digest.may_have (c->buffer->cur().codepoint) && apply_func (obj, c);
     }
 
+    hb_set_digest_t &get_digest () { return digest; }
+    const hb_set_digest_t &get_digest () const { return digest; }
+
     private:
     const void *obj;
     hb_apply_func_t apply_func;
@@ -723,15 +787,17 @@ struct hb_get_subtables_context_t :
   return_t dispatch (const T &obj)
   {
     hb_applicable_t *entry = array.push();
-    entry->init (obj, apply_to<T>);
+    entry->init (obj, apply_to<T>, collect_digests);
     return hb_empty_t ();
   }
   static return_t default_return_value () { return hb_empty_t (); }
 
-  hb_get_subtables_context_t (array_t &array_) :
-			      array (array_) {}
+  hb_get_subtables_context_t (array_t &array_, bool collect_digests_ = true) :
+			      array (array_),
+			      collect_digests (collect_digests_) {}
 
   array_t &array;
+  bool collect_digests;
 };
 
 
@@ -3168,18 +3234,51 @@ struct Extension
 
 struct hb_ot_layout_lookup_accelerator_t
 {
+  /* @cached, if not empty, holds the lookup's digest followed by those of
+   * its subtables, as written by save_digests(); it is only used if the
+   * number of subtables matches. */
   template <typename TLookup>
-  void init (const TLookup &lookup)
+  void init (const TLookup &lookup, hb_bytes_t cached = hb_bytes_t ())
   {
+    subtables.init ();
+    if (cached.length)
+    {
+      OT::hb_get_subtables_context_t c_get_subtables (subtables, false);
+      lookup.dispatch (&c_get_subtables);
+      if (likely (cached.length == (1 + subtables.length) * sizeof (hb_set_digest_t)))
+      {
+	memcpy (&digest, cached.arrayZ, sizeof (digest));
+	for (unsigned int i = 0; i < subtables.length; i++)
+	  memcpy (&subtables[i].get_digest (),
+		  cached.arrayZ + (1 + i) * sizeof (hb_set_digest_t),
+		  sizeof (hb_set_digest_t));
+	return;
+      }
+      subtables.resize (0);
+    }
+
     digest.init ();
     lookup.collect_coverage (&digest);
 
-    subtables.init ();
     OT::hb_get_subtables_context_t c_get_subtables (subtables);
     lookup.dispatch (&c_get_subtables);
   }
   void fini () { subtables.fini (); }
 
+  unsigned int get_digest_count () const { return 1 + subtables.length; }
+
+  unsigned int get_memory_usage () const { return subtables.get_allocated_size (); }
+
+  /* Writes get_digest_count() digests to @out. */
+  void save_digests (char *out) const
+  {
+    memcpy (out, &digest, sizeof (digest));
+    for (unsigned int i = 0; i < subtables.length; i++)
+      memcpy (out + (1 + i) * sizeof (hb_set_digest_t),
+	      &subtables[i].get_digest (),
+	      sizeof (hb_set_digest_t));
+  }
+
   bool may_have (hb_codepoint_t g) const
   { return digest.may_have (g); }
 
@@ -3362,12 +3461,32 @@ struct GSUBGPOS
     return_trace (true);
   }
 
+  private:
+  /* A lookup that only sanitizes its own header; see accelerator_t. */
+  struct ShallowLookup : Lookup
+  {
+    bool sanitize (hb_sanitize_context_t *c) const
+    { return sanitize_shallow (c); }
+  };
+
+  public:
+  /* Sanitizes all of the table but the lookup subtables. */
+  bool sanitize_shallow (hb_sanitize_context_t *c) const
+  { return sanitize<ShallowLookup> (c); }
+
+  /* The accelerator sanitizes the lookup subtables one lookup at a time,
+   * the first time each lookup is used, so that the first shaping does
+   * not have to wait for the lookups it doesn't apply.  Until then, the
+   * lookups of the table MUST only be accessed through get_lookup(). */
   template <typename T>
   struct accelerator_t
   {
+    typedef typename T::Lookup TLookup;
+
     void init (hb_face_t *face)
     {
-      this->table = hb_sanitize_context_t ().reference_table<T> (face);
+      this->face = face;
+      this->table = hb_sanitize_context_t ().reference_table<shallow_t> (face, T::tableTag);
       if (unlikely (this->table->is_blocklisted (this->table.get_blob (), face)))
       {
 	hb_blob_destroy (this->table.get_blob ());
@@ -3376,29 +3495,223 @@ struct GSUBGPOS
 
       this->lookup_count = table->get_lookup_count ();
 
-      this->accels = (hb_ot_layout_lookup_accelerator_t *) calloc (this->lookup_count, sizeof (hb_ot_layout_lookup_accelerator_t));
-      if (unlikely (!this->accels))
+      this->lookups = (hb_atomic_ptr_t<lookup_t> *) calloc (this->lookup_count, sizeof (hb_atomic_ptr_t<lookup_t>));
+      if (unlikely (!this->lookups))
       {
 	this->lookup_count = 0;
 	this->table.destroy ();
 	this->table = hb_blob_get_empty ();
       }
 
+      this->sanitized_table.init ();
+      this->sanitize_ops_used.set_relaxed (0);
+      this->cached.init (face->table.get_cache_section (T::tableTag, this->table.get_blob ()),
+			 this->lookup_count);
+    }
+
+    const TLookup &get_lookup (unsigned int i) const
+    {
+      const lookup_t *l = get (i);
+      return likely (l) ? *l->lookup : Null (TLookup);
+    }
+    /* @i MUST be less than lookup_count. */
+    const hb_ot_layout_lookup_accelerator_t &get_accel (unsigned int i) const
+    {
+      const lookup_t *l = get (i);
+      return likely (l) ? l->accel : Null (hb_ot_layout_lookup_accelerator_t);
+    }
+
+    /* Appends the digests of all lookups, for the face accelerator cache. */
+    bool save_cache (hb_vector_t<char> &out) const
+    {
+      if (!this->lookup_count) return false;
+
+      unsigned int start = out.length;
+      unsigned int digests_offset = cache_section_t::get_digests_offset (this->lookup_count);
+      unsigned int digest_count = 0;
+      for (unsigned int i = 0; i < this->lookup_count; i++)
+	digest_count += get_accel (i).get_digest_count ();
+      if (unlikely (!out.resize (start + digests_offset + digest_count * sizeof (hb_set_digest_t))))
+	return false;
+
+      char *p = out.arrayZ + start;
+      memcpy (p, &this->lookup_count, 4);
+      uint32_t digest_start = 0;
+      for (unsigned int i = 0; i < this->lookup_count; i++)
+      {
+	memcpy (p + 4 + 4 * i, &digest_start, 4);
+	get_accel (i).save_digests (p + digests_offset + digest_start * sizeof (hb_set_digest_t));
+	digest_start += get_accel (i).get_digest_count ();
+      }
+      memcpy (p + 4 + 4 * this->lookup_count, &digest_start, 4);
+      return true;
+    }
+
+    /* Only counts the lookups accelerated so far. */
+    unsigned int get_memory_usage () const
+    {
+      unsigned int size = this->lookup_count * sizeof (this->lookups[0]);
       for (unsigned int i = 0; i < this->lookup_count; i++)
-	this->accels[i].init (table->get_lookup (i));
+      {
+	const lookup_t *l = this->lookups[i].get ();
+	if (l)
+	  size += sizeof (*l) + l->accel.get_memory_usage ();
+      }
+      hb_blob_t *blob = this->sanitized_table.get ();
+      if (blob && !hb_object_is_inert (blob))
+	size += blob->get_memory_usage ();
+      return size;
     }
 
     void fini ()
     {
       for (unsigned int i = 0; i < this->lookup_count; i++)
-	this->accels[i].fini ();
-      free (this->accels);
+      {
+	lookup_t *l = this->lookups[i].get ();
+	if (!l) continue;
+	l->accel.fini ();
+	free (l);
+      }
+      free (this->lookups);
+      hb_blob_destroy (this->sanitized_table.get ());
       this->table.destroy ();
     }
 
     hb_blob_ptr_t<T> table;
     unsigned int lookup_count;
-    hb_ot_layout_lookup_accelerator_t *accels;
+
+    private:
+    struct shallow_t : T
+    {
+      bool sanitize (hb_sanitize_context_t *c) const
+      { return this->sanitize_shallow (c); }
+    };
+
+    struct lookup_t
+    {
+      const TLookup *lookup;
+      hb_ot_layout_lookup_accelerator_t accel;
+    };
+
+    const lookup_t *get (unsigned int i) const
+    {
+      if (unlikely (i >= this->lookup_count)) return nullptr;
+    retry:
+      lookup_t *l = this->lookups[i].get ();
+      if (likely (l)) return l;
+
+      l = (lookup_t *) calloc (1, sizeof (lookup_t));
+      if (unlikely (!l)) return nullptr;
+      if (likely (sanitize_lookup (i)))
+      {
+	l->lookup = &table->get_lookup (i);
+	l->accel.init (*l->lookup, this->cached.get_digests (i));
+      }
+      else
+      {
+	/* Needs edits, which can't be made to a table in use; take the
+	 * lookup from a copy of the table that went through the full
+	 * sanitize() instead. */
+	l->lookup = &get_sanitized_table ()->get_lookup (i);
+	l->accel.init (*l->lookup);
+      }
+
+      if (unlikely (!this->lookups[i].cmpexch (nullptr, l)))
+      {
+	l->accel.fini ();
+	free (l);
+	goto retry;
+      }
+      return l;
+    }
+
+    /* Sanitizes the subtables of lookup @i without editing them.  All
+     * lookups together get the operations budget of the table. */
+    bool sanitize_lookup (unsigned int i) const
+    {
+      hb_sanitize_context_t c;
+      c.init (this->table.get_blob ());
+      c.set_num_glyphs (hb_face_get_glyph_count (this->face));
+      c.start_processing ();
+      int max_ops = c.max_ops - this->sanitize_ops_used.get_relaxed ();
+      bool sane = false;
+      if (likely (max_ops > 0))
+      {
+	c.set_max_ops (max_ops);
+	sane = this->table->get_lookup (i).sanitize (&c) && !c.get_edit_count ();
+	this->sanitize_ops_used.add (max_ops - hb_max (c.max_ops, 0));
+      }
+      c.end_processing ();
+      return sane;
+    }
+
+    const T *get_sanitized_table () const
+    {
+    retry:
+      hb_blob_t *blob = this->sanitized_table.get ();
+      if (unlikely (!blob))
+      {
+	/* Sub-blobs are read-only, so edits go to a copy. */
+	hb_blob_t *table_blob = this->table.get_blob ();
+	hb_sanitize_context_t c;
+	c.set_num_glyphs (hb_face_get_glyph_count (this->face));
+	blob = c.sanitize_blob<T> (hb_blob_create_sub_blob (table_blob, 0, table_blob->length));
+	if (unlikely (!this->sanitized_table.cmpexch (nullptr, blob)))
+	{
+	  hb_blob_destroy (blob);
+	  goto retry;
+	}
+      }
+      return blob->as<T> ();
+    }
+
+    /* Cached lookup digests: the lookup count, then for every lookup and
+     * one past the last, the index of its first digest; then the digests,
+     * eight-byte aligned.  All in native byte order. */
+    struct cache_section_t
+    {
+      static unsigned int get_digests_offset (unsigned int lookup_count)
+      { return (4 + 4 * (lookup_count + 1) + 7) & ~7u; }
+
+      void init (hb_bytes_t bytes_, unsigned int lookup_count)
+      {
+	bytes = hb_bytes_t ();
+	count = 0;
+	if (!bytes_.length || bytes_.length < get_digests_offset (lookup_count) ||
+	    get_uint32 (bytes_, 0) != lookup_count)
+	  return;
+	count = lookup_count;
+	bytes = bytes_;
+      }
+
+      /* Empty if the section is not valid for lookup @i. */
+      hb_bytes_t get_digests (unsigned int i) const
+      {
+	if (!bytes.length) return hb_bytes_t ();
+	unsigned int first = get_uint32 (bytes, 4 + 4 * i);
+	unsigned int end = get_uint32 (bytes, 4 + 4 * (i + 1));
+	unsigned int available = (bytes.length - get_digests_offset (count)) / sizeof (hb_set_digest_t);
+	if (first >= end || end > available) return hb_bytes_t ();
+	return bytes.sub_array (get_digests_offset (count) + first * sizeof (hb_set_digest_t),
+				(end - first) * sizeof (hb_set_digest_t));
+      }
+
+      static unsigned int get_uint32 (hb_bytes_t bytes, unsigned int offset)
+      {
+	uint32_t v;
+	memcpy (&v, bytes.arrayZ + offset, 4);
+	return v;
+      }
+
+      hb_bytes_t bytes;
+      unsigned int count;
+    };
+
+    hb_face_t *face;
+    hb_atomic_ptr_t<lookup_t> *lookups;
+    hb_atomic_ptr_t<hb_blob_t> sanitized_table;
+    mutable hb_atomic_int_t sanitize_ops_used;
+    cache_section_t cached;
   };
 
   protected:
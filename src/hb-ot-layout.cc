@@ -82,6 +82,7 @@
 bool
 hb_ot_layout_has_kerning (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.kern->has_data ();
 }
 
@@ -98,6 +99,7 @@ hb_ot_layout_has_kerning (hb_face_t *face)
 bool
 hb_ot_layout_has_machine_kerning (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.kern->has_state_machine ();
 }
 
@@ -118,6 +120,7 @@ hb_ot_layout_has_machine_kerning (hb_face_t *face)
 bool
 hb_ot_layout_has_cross_kerning (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.kern->has_cross_stream ();
 }
 
@@ -126,6 +129,7 @@ hb_ot_layout_kern (const hb_ot_shape_plan_t *plan,
 		   hb_font_t *font,
 		   hb_buffer_t  *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_blob_t *blob = font->face->table.kern.get_blob ();
   const AAT::kern& kern = *blob->as<AAT::kern> ();
 
@@ -274,6 +278,7 @@ _hb_ot_layout_set_glyph_props (hb_font_t *font,
 hb_bool_t
 hb_ot_layout_has_glyph_classes (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.GDEF->table->has_glyph_classes ();
 }
 
@@ -293,6 +298,7 @@ hb_ot_layout_glyph_class_t
 hb_ot_layout_get_glyph_class (hb_face_t      *face,
 			      hb_codepoint_t  glyph)
 {
+  hb_ot_face_reader_t reader (face->table);
   return (hb_ot_layout_glyph_class_t) face->table.GDEF->table->get_glyph_class (glyph);
 }
 
@@ -313,6 +319,7 @@ hb_ot_layout_get_glyphs_in_class (hb_face_t                  *face,
 				  hb_ot_layout_glyph_class_t  klass,
 				  hb_set_t                   *glyphs /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.GDEF->table->get_glyphs_in_class (klass, glyphs);
 }
 
@@ -339,6 +346,7 @@ hb_ot_layout_get_attach_points (hb_face_t      *face,
 				unsigned int   *point_count /* IN/OUT */,
 				unsigned int   *point_array /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.GDEF->table->get_attach_points (glyph,
 						     start_offset,
 						     point_count,
@@ -366,6 +374,7 @@ hb_ot_layout_get_ligature_carets (hb_font_t      *font,
 				  unsigned int   *caret_count /* IN/OUT */,
 				  hb_position_t  *caret_array /* OUT */)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.GDEF->table->get_lig_carets (font, direction, glyph, start_offset, caret_count, caret_array);
 }
 #endif
@@ -427,6 +436,7 @@ hb_ot_layout_table_get_script_tags (hb_face_t    *face,
 				    unsigned int *script_count /* IN/OUT */,
 				    hb_tag_t     *script_tags  /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
   return g.get_script_tags (start_offset, script_count, script_tags);
@@ -453,6 +463,7 @@ hb_ot_layout_table_find_script (hb_face_t    *face,
 				hb_tag_t      script_tag,
 				unsigned int *script_index /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   static_assert ((OT::Index::NOT_FOUND_INDEX == HB_OT_LAYOUT_NO_SCRIPT_INDEX), "");
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
@@ -495,6 +506,7 @@ hb_ot_layout_table_choose_script (hb_face_t      *face,
 				  unsigned int   *script_index  /* OUT */,
 				  hb_tag_t       *chosen_script /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const hb_tag_t *t;
   for (t = script_tags; *t; t++);
   return hb_ot_layout_table_select_script (face, table_tag, t - script_tags, script_tags, script_index, chosen_script);
@@ -520,6 +532,7 @@ hb_ot_layout_table_select_script (hb_face_t      *face,
 				  unsigned int   *script_index  /* OUT */,
 				  hb_tag_t       *chosen_script /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   static_assert ((OT::Index::NOT_FOUND_INDEX == HB_OT_LAYOUT_NO_SCRIPT_INDEX), "");
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
   unsigned int i;
@@ -582,6 +595,7 @@ hb_ot_layout_table_get_feature_tags (hb_face_t    *face,
 				     unsigned int *feature_count /* IN/OUT */,
 				     hb_tag_t     *feature_tags  /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
   return g.get_feature_tags (start_offset, feature_count, feature_tags);
@@ -606,6 +620,7 @@ hb_ot_layout_table_find_feature (hb_face_t    *face,
 				 hb_tag_t      feature_tag,
 				 unsigned int *feature_index /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   static_assert ((OT::Index::NOT_FOUND_INDEX == HB_OT_LAYOUT_NO_FEATURE_INDEX), "");
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
@@ -645,6 +660,7 @@ hb_ot_layout_script_get_language_tags (hb_face_t    *face,
 				       unsigned int *language_count /* IN/OUT */,
 				       hb_tag_t     *language_tags  /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::Script &s = get_gsubgpos_table (face, table_tag).get_script (script_index);
 
   return s.get_lang_sys_tags (start_offset, language_count, language_tags);
@@ -675,6 +691,7 @@ hb_ot_layout_script_find_language (hb_face_t    *face,
 				   hb_tag_t      language_tag,
 				   unsigned int *language_index)
 {
+  hb_ot_face_reader_t reader (face->table);
   return hb_ot_layout_script_select_language (face,
 					      table_tag,
 					      script_index,
@@ -709,6 +726,7 @@ hb_ot_layout_script_select_language (hb_face_t      *face,
 				     const hb_tag_t *language_tags,
 				     unsigned int   *language_index /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   static_assert ((OT::Index::NOT_FOUND_INDEX == HB_OT_LAYOUT_DEFAULT_LANGUAGE_INDEX), "");
   const OT::Script &s = get_gsubgpos_table (face, table_tag).get_script (script_index);
   unsigned int i;
@@ -749,6 +767,7 @@ hb_ot_layout_language_get_required_feature_index (hb_face_t    *face,
 						  unsigned int  language_index,
 						  unsigned int *feature_index /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return hb_ot_layout_language_get_required_feature (face,
 						     table_tag,
 						     script_index,
@@ -782,6 +801,7 @@ hb_ot_layout_language_get_required_feature (hb_face_t    *face,
 					    unsigned int *feature_index /* OUT */,
 					    hb_tag_t     *feature_tag   /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
   const OT::LangSys &l = g.get_script (script_index).get_lang_sys (language_index);
 
@@ -817,6 +837,7 @@ hb_ot_layout_language_get_feature_indexes (hb_face_t    *face,
 					   unsigned int *feature_count   /* IN/OUT */,
 					   unsigned int *feature_indexes /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
   const OT::LangSys &l = g.get_script (script_index).get_lang_sys (language_index);
 
@@ -849,6 +870,7 @@ hb_ot_layout_language_get_feature_tags (hb_face_t    *face,
 					unsigned int *feature_count /* IN/OUT */,
 					hb_tag_t     *feature_tags  /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
   const OT::LangSys &l = g.get_script (script_index).get_lang_sys (language_index);
 
@@ -888,6 +910,7 @@ hb_ot_layout_language_find_feature (hb_face_t    *face,
 				    hb_tag_t      feature_tag,
 				    unsigned int *feature_index /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   static_assert ((OT::Index::NOT_FOUND_INDEX == HB_OT_LAYOUT_NO_FEATURE_INDEX), "");
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
   const OT::LangSys &l = g.get_script (script_index).get_lang_sys (language_index);
@@ -931,6 +954,7 @@ hb_ot_layout_feature_get_lookups (hb_face_t    *face,
 				  unsigned int *lookup_count   /* IN/OUT */,
 				  unsigned int *lookup_indexes /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return hb_ot_layout_feature_with_variations_get_lookups (face,
 							   table_tag,
 							   feature_index,
@@ -955,6 +979,7 @@ unsigned int
 hb_ot_layout_table_get_lookup_count (hb_face_t    *face,
 				     hb_tag_t      table_tag)
 {
+  hb_ot_face_reader_t reader (face->table);
   return get_gsubgpos_table (face, table_tag).get_lookup_count ();
 }
 
@@ -1123,6 +1148,7 @@ hb_ot_layout_collect_features (hb_face_t      *face,
 			       const hb_tag_t *features,
 			       hb_set_t       *feature_indexes /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   hb_collect_features_context_t c (face, table_tag, feature_indexes);
   if (!scripts)
   {
@@ -1174,6 +1200,7 @@ hb_ot_layout_collect_lookups (hb_face_t      *face,
 			      const hb_tag_t *features,
 			      hb_set_t       *lookup_indexes /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
   hb_set_t feature_indexes;
@@ -1212,6 +1239,7 @@ hb_ot_layout_lookup_collect_glyphs (hb_face_t    *face,
 				    hb_set_t     *glyphs_after,  /* OUT.  May be NULL */
 				    hb_set_t     *glyphs_output  /* OUT.  May be NULL */)
 {
+  hb_ot_face_reader_t reader (face->table);
   OT::hb_collect_glyphs_context_t c (face,
 				     glyphs_before,
 				     glyphs_input,
@@ -1222,13 +1250,13 @@ hb_ot_layout_lookup_collect_glyphs (hb_face_t    *face,
   {
     case HB_OT_TAG_GSUB:
     {
-      const OT::SubstLookup& l = face->table.GSUB->table->get_lookup (lookup_index);
+      const OT::SubstLookup& l = face->table.GSUB->get_lookup (lookup_index);
       l.collect_glyphs (&c);
       return;
     }
     case HB_OT_TAG_GPOS:
     {
-      const OT::PosLookup& l = face->table.GPOS->table->get_lookup (lookup_index);
+      const OT::PosLookup& l = face->table.GPOS->get_lookup (lookup_index);
       l.collect_glyphs (&c);
       return;
     }
@@ -1259,6 +1287,7 @@ hb_ot_layout_table_find_feature_variations (hb_face_t    *face,
 					    unsigned int  num_coords,
 					    unsigned int *variations_index /* out */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
   return g.find_variations_index (coords, num_coords, variations_index);
@@ -1290,6 +1319,7 @@ hb_ot_layout_feature_with_variations_get_lookups (hb_face_t    *face,
 						  unsigned int *lookup_count /* IN/OUT */,
 						  unsigned int *lookup_indexes /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   static_assert ((OT::FeatureVariations::NOT_FOUND_INDEX == HB_OT_LAYOUT_NO_VARIATIONS_INDEX), "");
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
@@ -1316,6 +1346,7 @@ hb_ot_layout_feature_with_variations_get_lookups (hb_face_t    *face,
 hb_bool_t
 hb_ot_layout_has_substitution (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.GSUB->table->has_data ();
 }
 
@@ -1342,11 +1373,12 @@ hb_ot_layout_lookup_would_substitute (hb_face_t            *face,
 				      unsigned int          glyphs_length,
 				      hb_bool_t             zero_context)
 {
+  hb_ot_face_reader_t reader (face->table);
   if (unlikely (lookup_index >= face->table.GSUB->lookup_count)) return false;
   OT::hb_would_apply_context_t c (face, glyphs, glyphs_length, (bool) zero_context);
 
-  const OT::SubstLookup& l = face->table.GSUB->table->get_lookup (lookup_index);
-  return l.would_apply (&c, &face->table.GSUB->accels[lookup_index]);
+  const OT::SubstLookup& l = face->table.GSUB->get_lookup (lookup_index);
+  return l.would_apply (&c, &face->table.GSUB->get_accel (lookup_index));
 }
 
 
@@ -1363,6 +1395,7 @@ void
 hb_ot_layout_substitute_start (hb_font_t    *font,
 			       hb_buffer_t  *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   _hb_ot_layout_set_glyph_props (font, buffer);
 }
 
@@ -1432,10 +1465,11 @@ hb_ot_layout_lookup_substitute_closure (hb_face_t    *face,
 					unsigned int  lookup_index,
 					hb_set_t     *glyphs /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   hb_map_t done_lookups;
   OT::hb_closure_context_t c (face, glyphs, &done_lookups);
 
-  const OT::SubstLookup& l = face->table.GSUB->table->get_lookup (lookup_index);
+  const OT::SubstLookup& l = face->table.GSUB->get_lookup (lookup_index);
 
   l.closure (&c, lookup_index);
 }
@@ -1456,27 +1490,77 @@ hb_ot_layout_lookups_substitute_closure (hb_face_t      *face,
 					 const hb_set_t *lookups,
 					 hb_set_t       *glyphs /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
+  hb_ot_layout_lookups_substitute_closure_bounded (face, lookups, glyphs, nullptr, nullptr);
+}
+
+/* The GSUB lookups a closure applies, for OT::hb_closure_apply_lookups(). */
+struct hb_gsub_closure_lookups_t
+{
+  unsigned int get_count () const { return lookup_indices.length; }
+
+  bool is_per_glyph (unsigned int i) const
+  { return gsub.get_lookup (lookup_indices[i]).closure_is_per_glyph (); }
+
+  bool closure (unsigned int i)
+  {
+    gsub.get_lookup (lookup_indices[i]).closure (c, lookup_indices[i]);
+    return !keep_going || keep_going (c->glyphs->get_population (), user_data);
+  }
+
+  bool closure_glyphs (unsigned int i, hb_array_t<const hb_codepoint_t> glyphs)
+  {
+    new_glyphs.clear ();
+    new_glyphs.add_array (glyphs.arrayZ, glyphs.length);
+    hb_set_t *old_glyphs = c->glyphs;
+    c->glyphs = &new_glyphs;
+    gsub.get_lookup (lookup_indices[i]).dispatch (c);
+    c->glyphs = old_glyphs;
+    c->flush ();
+    return !keep_going || keep_going (glyphs.length, user_data);
+  }
+
+  const OT::GSUB_accelerator_t &gsub;
+  const hb_vector_t<hb_codepoint_t> &lookup_indices;
+  OT::hb_closure_context_t *c;
+  bool (*keep_going) (unsigned int ops, void *user_data);
+  void *user_data;
+  hb_set_t new_glyphs;
+};
+
+/* Like hb_ot_layout_lookups_substitute_closure(), but calls @keep_going
+ * after every lookup applied, with the number of glyphs it was applied
+ * to; stops and returns false as soon as that returns false. */
+bool
+hb_ot_layout_lookups_substitute_closure_bounded (hb_face_t      *face,
+						 const hb_set_t *lookups,
+						 hb_set_t       *glyphs /* OUT */,
+						 bool (*keep_going) (unsigned int ops, void *user_data),
+						 void           *user_data)
+{
+  hb_ot_face_reader_t reader (face->table);
+  const OT::GSUB_accelerator_t &gsub = *face->table.GSUB;
+
+  hb_vector_t<hb_codepoint_t> lookup_indices;
+  if (lookups)
+  {
+    for (hb_codepoint_t lookup_index = HB_SET_VALUE_INVALID; hb_set_next (lookups, &lookup_index);)
+      lookup_indices.push (lookup_index);
+  }
+  else
+    for (unsigned int i = 0; i < gsub.lookup_count; i++)
+      lookup_indices.push (i);
+  if (unlikely (lookup_indices.in_error ()))
+    return true;
+
+  /* Every glyph added to the closure, in order. */
+  hb_vector_t<hb_codepoint_t> added;
   hb_map_t done_lookups;
   OT::hb_closure_context_t c (face, glyphs, &done_lookups);
-  const OT::GSUB& gsub = *face->table.GSUB->table;
+  c.added_glyphs = &added;
 
-  unsigned int iteration_count = 0;
-  unsigned int glyphs_length;
-  do
-  {
-    glyphs_length = glyphs->get_population ();
-    if (lookups)
-    {
-      for (hb_codepoint_t lookup_index = HB_SET_VALUE_INVALID; hb_set_next (lookups, &lookup_index);)
-	gsub.get_lookup (lookup_index).closure (&c, lookup_index);
-    }
-    else
-    {
-      for (unsigned int i = 0; i < gsub.get_lookup_count (); i++)
-	gsub.get_lookup (i).closure (&c, i);
-    }
-  } while (iteration_count++ <= HB_CLOSURE_MAX_STAGES &&
-	   glyphs_length != glyphs->get_population ());
+  hb_gsub_closure_lookups_t closure_lookups = {gsub, lookup_indices, &c, keep_going, user_data};
+  return OT::hb_closure_apply_lookups (closure_lookups, glyphs, added);
 }
 
 /*
@@ -1494,6 +1578,7 @@ hb_ot_layout_lookups_substitute_closure (hb_face_t      *face,
 hb_bool_t
 hb_ot_layout_has_positioning (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.GPOS->table->has_data ();
 }
 
@@ -1509,6 +1594,7 @@ hb_ot_layout_has_positioning (hb_face_t *face)
 void
 hb_ot_layout_position_start (hb_font_t *font, hb_buffer_t *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   OT::GPOS::position_start (font, buffer);
 }
 
@@ -1524,6 +1610,7 @@ hb_ot_layout_position_start (hb_font_t *font, hb_buffer_t *buffer)
 void
 hb_ot_layout_position_finish_advances (hb_font_t *font, hb_buffer_t *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   OT::GPOS::position_finish_advances (font, buffer);
 }
 
@@ -1538,6 +1625,7 @@ hb_ot_layout_position_finish_advances (hb_font_t *font, hb_buffer_t *buffer)
 void
 hb_ot_layout_position_finish_offsets (hb_font_t *font, hb_buffer_t *buffer)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   OT::GPOS::position_finish_offsets (font, buffer);
 }
 
@@ -1573,6 +1661,7 @@ hb_ot_layout_get_size_params (hb_face_t       *face,
 			      unsigned int    *range_start,       /* OUT.  May be NULL */
 			      unsigned int    *range_end          /* OUT.  May be NULL */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GPOS &gpos = *face->table.GPOS->table;
   const hb_tag_t tag = HB_TAG ('s','i','z','e');
 
@@ -1639,6 +1728,7 @@ hb_ot_layout_feature_get_name_ids (hb_face_t       *face,
 				   unsigned int    *num_named_parameters, /* OUT.  May be NULL */
 				   hb_ot_name_id_t *first_param_id        /* OUT.  May be NULL */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
 
   hb_tag_t feature_tag = g.get_feature_tag (feature_index);
@@ -1706,6 +1796,7 @@ hb_ot_layout_feature_get_characters (hb_face_t      *face,
 				     unsigned int   *char_count, /* IN/OUT.  May be NULL */
 				     hb_codepoint_t *characters  /* OUT.     May be NULL */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::GSUBGPOS &g = get_gsubgpos_table (face, table_tag);
   return g.get_feature (feature_index)
 	  .get_feature_params ()
@@ -1728,11 +1819,9 @@ struct GSUBProxy
   typedef OT::SubstLookup Lookup;
 
   GSUBProxy (hb_face_t *face) :
-    table (*face->table.GSUB->table),
-    accels (face->table.GSUB->accels) {}
+    accel (*face->table.GSUB) {}
 
-  const OT::GSUB &table;
-  const OT::hb_ot_layout_lookup_accelerator_t *accels;
+  const OT::GSUB::accelerator_t &accel;
 };
 
 struct GPOSProxy
@@ -1742,11 +1831,9 @@ struct GPOSProxy
   typedef OT::PosLookup Lookup;
 
   GPOSProxy (hb_face_t *face) :
-    table (*face->table.GPOS->table),
-    accels (face->table.GPOS->accels) {}
+    accel (*face->table.GPOS) {}
 
-  const OT::GPOS &table;
-  const OT::hb_ot_layout_lookup_accelerator_t *accels;
+  const OT::GPOS::accelerator_t &accel;
 };
 
 
@@ -1863,8 +1950,8 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
 	buffer->unsafe_to_break_all ();
       }
       apply_string<Proxy> (&c,
-			   proxy.table.get_lookup (lookup_index),
-			   proxy.accels[lookup_index]);
+			   proxy.accel.get_lookup (lookup_index),
+			   proxy.accel.get_accel (lookup_index));
       (void) buffer->message (font, "end lookup %d", lookup_index);
     }
 
@@ -1924,6 +2011,7 @@ hb_ot_layout_get_baseline (hb_font_t                   *font,
 			   hb_tag_t                     language_tag,
 			   hb_position_t               *coord        /* OUT.  May be NULL. */)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   bool result = font->face->table.BASE->get_baseline (font, baseline_tag, direction, script_tag, language_tag, coord);
 
   if (result && coord)
@@ -1983,8 +2071,9 @@ hb_ot_layout_lookup_get_glyph_alternates (hb_face_t      *face,
 					  unsigned       *alternate_count  /* IN/OUT.  May be NULL. */,
 					  hb_codepoint_t *alternate_glyphs /* OUT.     May be NULL. */)
 {
+  hb_ot_face_reader_t reader (face->table);
   hb_get_glyph_alternates_dispatch_t c (face);
-  const OT::SubstLookup &lookup = face->table.GSUB->table->get_lookup (lookup_index);
+  const OT::SubstLookup &lookup = face->table.GSUB->get_lookup (lookup_index);
   auto ret = lookup.dispatch (&c, glyph, start_offset, alternate_count, alternate_glyphs);
   if (!ret && alternate_count) *alternate_count = 0;
   return ret;
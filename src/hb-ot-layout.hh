@@ -62,6 +62,13 @@ hb_ot_layout_kern (const hb_ot_shape_plan_t *plan,
 
 /* Private API corresponding to hb-ot-layout.h: */
 
+HB_INTERNAL bool
+hb_ot_layout_lookups_substitute_closure_bounded (hb_face_t      *face,
+						 const hb_set_t *lookups,
+						 hb_set_t       *glyphs /* OUT */,
+						 bool (*keep_going) (unsigned int ops, void *user_data),
+						 void           *user_data);
+
 HB_INTERNAL bool
 hb_ot_layout_table_find_feature (hb_face_t    *face,
 				 hb_tag_t      table_tag,
@@ -159,6 +159,13 @@ struct hb_ot_map_t
   HB_INTERNAL void substitute (const struct hb_ot_shape_plan_t *plan, hb_font_t *font, hb_buffer_t *buffer) const;
   HB_INTERNAL void position (const struct hb_ot_shape_plan_t *plan, hb_font_t *font, hb_buffer_t *buffer) const;
 
+  unsigned int get_memory_usage () const
+  {
+    return features.get_allocated_size () +
+	   lookups[0].get_allocated_size () + lookups[1].get_allocated_size () +
+	   stages[0].get_allocated_size () + stages[1].get_allocated_size ();
+  }
+
   public:
   hb_tag_t chosen_script[2];
   bool found_script[2];
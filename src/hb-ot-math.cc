@@ -63,6 +63,7 @@
 hb_bool_t
 hb_ot_math_has_data (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.MATH->has_data ();
 }
 
@@ -87,6 +88,7 @@ hb_position_t
 hb_ot_math_get_constant (hb_font_t *font,
 			 hb_ot_math_constant_t constant)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MATH->get_constant(constant, font);
 }
 
@@ -106,6 +108,7 @@ hb_position_t
 hb_ot_math_get_glyph_italics_correction (hb_font_t *font,
 					 hb_codepoint_t glyph)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MATH->get_glyph_info().get_italics_correction (glyph, font);
 }
 
@@ -132,6 +135,7 @@ hb_position_t
 hb_ot_math_get_glyph_top_accent_attachment (hb_font_t *font,
 					    hb_codepoint_t glyph)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MATH->get_glyph_info().get_top_accent_attachment (glyph, font);
 }
 
@@ -150,6 +154,7 @@ hb_bool_t
 hb_ot_math_is_glyph_extended_shape (hb_face_t *face,
 				    hb_codepoint_t glyph)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.MATH->get_glyph_info().is_extended_shape (glyph);
 }
 
@@ -178,6 +183,7 @@ hb_ot_math_get_glyph_kerning (hb_font_t *font,
 			      hb_ot_math_kern_t kern,
 			      hb_position_t correction_height)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MATH->get_glyph_info().get_kerning (glyph,
 							       kern,
 							       correction_height,
@@ -215,6 +221,7 @@ hb_ot_math_get_glyph_variants (hb_font_t *font,
 			       unsigned int *variants_count, /* IN/OUT */
 			       hb_ot_math_glyph_variant_t *variants /* OUT */)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MATH->get_variants().get_glyph_variants (glyph, direction, font,
 								    start_offset,
 								    variants_count,
@@ -243,6 +250,7 @@ hb_position_t
 hb_ot_math_get_min_connector_overlap (hb_font_t *font,
 				      hb_direction_t direction)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MATH->get_variants().get_min_connector_overlap (direction, font);
 }
 
@@ -280,6 +288,7 @@ hb_ot_math_get_glyph_assembly (hb_font_t *font,
 			       hb_ot_math_glyph_part_t *parts, /* OUT */
 			       hb_position_t *italics_correction /* OUT */)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MATH->get_variants().get_glyph_parts (glyph,
 								 direction,
 								 font,
@@ -54,6 +54,7 @@ hb_ot_meta_get_entry_tags (hb_face_t        *face,
 			   unsigned int     *entries_count, /* IN/OUT.  May be NULL. */
 			   hb_ot_meta_tag_t *entries        /* OUT.     May be NULL. */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.meta->get_entries (start_offset, entries_count, entries);
 }
 
@@ -71,6 +72,7 @@ hb_ot_meta_get_entry_tags (hb_face_t        *face,
 hb_blob_t *
 hb_ot_meta_reference_entry (hb_face_t *face, hb_ot_meta_tag_t meta_tag)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.meta->reference_entry (meta_tag);
 }
 
@@ -52,6 +52,7 @@ _hb_ot_metrics_get_position_common (hb_font_t           *font,
 				    hb_ot_metrics_tag_t  metrics_tag,
 				    hb_position_t       *position     /* OUT.  May be NULL. */)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_face_t *face = font->face;
   switch ((unsigned) metrics_tag)
   {
@@ -124,6 +125,7 @@ hb_ot_metrics_get_position (hb_font_t           *font,
 			    hb_ot_metrics_tag_t  metrics_tag,
 			    hb_position_t       *position     /* OUT.  May be NULL. */)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_face_t *face = font->face;
   switch ((unsigned) metrics_tag)
   {
@@ -194,6 +196,7 @@ hb_ot_metrics_get_position (hb_font_t           *font,
 float
 hb_ot_metrics_get_variation (hb_font_t *font, hb_ot_metrics_tag_t metrics_tag)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->face->table.MVAR->get_var (metrics_tag, font->coords, font->num_coords);
 }
 
@@ -209,6 +212,7 @@ hb_ot_metrics_get_variation (hb_font_t *font, hb_ot_metrics_tag_t metrics_tag)
 hb_position_t
 hb_ot_metrics_get_x_variation (hb_font_t *font, hb_ot_metrics_tag_t metrics_tag)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->em_scalef_x (hb_ot_metrics_get_variation (font, metrics_tag));
 }
 
@@ -224,6 +228,7 @@ hb_ot_metrics_get_x_variation (hb_font_t *font, hb_ot_metrics_tag_t metrics_tag)
 hb_position_t
 hb_ot_metrics_get_y_variation (hb_font_t *font, hb_ot_metrics_tag_t metrics_tag)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   return font->em_scalef_y (hb_ot_metrics_get_variation (font, metrics_tag));
 }
 #endif
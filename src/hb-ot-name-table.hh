@@ -320,6 +320,9 @@ struct name
       this->table.destroy ();
     }
 
+    unsigned int get_memory_usage () const
+    { return this->names.get_allocated_size (); }
+
     int get_index (hb_ot_name_id_t  name_id,
 		   hb_language_t    language,
 		   unsigned int    *width=nullptr) const
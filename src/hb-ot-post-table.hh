@@ -114,14 +114,47 @@ struct post
 	   index_to_offset.length < 65535 && data < end && data + *data < end;
 	   data += 1 + *data)
 	index_to_offset.push (data - pool);
+
+      /* Use the sorted glyphs of a cache attached to the face in place;
+       * they are only ever used as glyph indices, which are checked. */
+      hb_bytes_t cached = face->table.get_cache_section (HB_OT_TAG_post, table.get_blob ());
+      if (cached.length &&
+	  cached.length == get_glyph_count () * sizeof (uint16_t) &&
+	  !((uintptr_t) cached.arrayZ & (alignof (uint16_t) - 1)))
+      {
+	gids_sorted_by_name.set_relaxed ((uint16_t *) cached.arrayZ);
+	gids_from_cache = true;
+      }
     }
     void fini ()
     {
       index_to_offset.fini ();
-      free (gids_sorted_by_name.get ());
+      if (!gids_from_cache)
+	free (gids_sorted_by_name.get ());
       table.destroy ();
     }
 
+    /* Appends the glyphs sorted by name, for the face accelerator cache. */
+    bool save_cache (hb_vector_t<char> &out) const
+    {
+      if (version != 0x00020000) return false;
+      const uint16_t *gids = get_gids_sorted_by_name ();
+      if (!gids) return false;
+      unsigned int start = out.length;
+      unsigned int length = get_glyph_count () * sizeof (uint16_t);
+      if (unlikely (!out.resize (start + length))) return false;
+      memcpy (out.arrayZ + start, gids, length);
+      return true;
+    }
+
+    unsigned int get_memory_usage () const
+    {
+      unsigned int size = index_to_offset.get_allocated_size ();
+      if (gids_sorted_by_name.get () && !gids_from_cache)
+	size += get_glyph_count () * sizeof (uint16_t);
+      return size;
+    }
+
     bool get_glyph_name (hb_codepoint_t glyph,
 			 char *buf, unsigned int buf_len) const
     {
@@ -144,6 +177,30 @@ struct post
 
       if (unlikely (!len)) return false;
 
+      const uint16_t *gids = get_gids_sorted_by_name ();
+      if (unlikely (!gids))
+	return false; /* Anything better?! */
+
+      hb_bytes_t st (name, len);
+      auto* gid = hb_bsearch (st, gids, count, sizeof (gids[0]), cmp_key, (void *) this);
+      if (gid)
+      {
+	*glyph = *gid;
+	return true;
+      }
+
+      return false;
+    }
+
+    hb_blob_ptr_t<post> table;
+
+    protected:
+
+    const uint16_t *get_gids_sorted_by_name () const
+    {
+      unsigned int count = get_glyph_count ();
+      if (unlikely (!count)) return nullptr;
+
     retry:
       uint16_t *gids = gids_sorted_by_name.get ();
 
@@ -151,7 +208,7 @@ struct post
       {
 	gids = (uint16_t *) malloc (count * sizeof (gids[0]));
 	if (unlikely (!gids))
-	  return false; /* Anything better?! */
+	  return nullptr;
 
 	for (unsigned int i = 0; i < count; i++)
 	  gids[i] = i;
@@ -163,22 +220,9 @@ struct post
 	  goto retry;
 	}
       }
-
-      hb_bytes_t st (name, len);
-      auto* gid = hb_bsearch (st, gids, count, sizeof (gids[0]), cmp_key, (void *) this);
-      if (gid)
-      {
-	*glyph = *gid;
-	return true;
-      }
-
-      return false;
+      return gids;
     }
 
-    hb_blob_ptr_t<post> table;
-
-    protected:
-
     unsigned int get_glyph_count () const
     {
       if (version == 0x00010000)
@@ -241,6 +285,7 @@ struct post
     hb_vector_t<uint32_t> index_to_offset;
     const uint8_t *pool;
     hb_atomic_ptr_t<uint16_t *> gids_sorted_by_name;
+    bool gids_from_cache;
   };
 
   bool has_data () const { return version.to_int (); }
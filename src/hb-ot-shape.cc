@@ -202,6 +202,7 @@ bool
 hb_ot_shape_plan_t::init0 (hb_face_t                     *face,
 			   const hb_shape_plan_key_t     *key)
 {
+  hb_ot_face_reader_t reader (face->table);
   map.init ();
 #ifndef HB_NO_AAT_SHAPE
   aat_map.init ();
@@ -1152,6 +1153,7 @@ _hb_ot_shape (hb_shape_plan_t    *shape_plan,
 	      const hb_feature_t *features,
 	      unsigned int        num_features)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_ot_shape_context_t c = {&shape_plan->ot, font, font->face, buffer, features, num_features};
   hb_ot_shape_internal (&c);
 
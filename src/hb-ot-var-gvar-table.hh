@@ -52,7 +52,7 @@ struct contour_point_t
 
 struct contour_point_vector_t : hb_vector_t<contour_point_t>
 {
-  void extend (const hb_array_t<contour_point_t> &a)
+  void extend (const hb_array_t<const contour_point_t> &a)
   {
     unsigned int old_len = length;
     resize (old_len + a.length);
@@ -60,21 +60,23 @@ struct contour_point_vector_t : hb_vector_t<contour_point_t>
       (*this)[old_len + i] = a[i];
   }
 
-  void transform (const float (&matrix)[4])
+  void transform (const float (&matrix)[4]) { transform (as_array (), matrix); }
+  static void transform (hb_array_t<contour_point_t> points, const float (&matrix)[4])
   {
-    for (unsigned int i = 0; i < length; i++)
+    for (unsigned int i = 0; i < points.length; i++)
     {
-      contour_point_t &p = (*this)[i];
+      contour_point_t &p = points[i];
       float x_ = p.x * matrix[0] + p.y * matrix[2];
 	   p.y = p.x * matrix[1] + p.y * matrix[3];
       p.x = x_;
     }
   }
 
-  void translate (const contour_point_t& delta)
+  void translate (const contour_point_t& delta) { translate (as_array (), delta); }
+  static void translate (hb_array_t<contour_point_t> points, const contour_point_t& delta)
   {
-    for (unsigned int i = 0; i < length; i++)
-      (*this)[i].translate (delta);
+    for (unsigned int i = 0; i < points.length; i++)
+      points[i].translate (delta);
   }
 };
 
@@ -407,16 +409,7 @@ struct gvar
   {
     TRACE_SUBSET (this);
 
-    gvar *out = c->serializer->allocate_min<gvar> ();
-    if (unlikely (!out)) return_trace (false);
-
-    out->version.major = 1;
-    out->version.minor = 0;
-    out->axisCount = axisCount;
-    out->sharedTupleCount = sharedTupleCount;
-
     unsigned int num_glyphs = c->plan->num_output_glyphs ();
-    out->glyphCount = num_glyphs;
 
     unsigned int subset_data_size = 0;
     for (hb_codepoint_t gid = 0; gid < num_glyphs; gid++)
@@ -427,6 +420,21 @@ struct gvar
     }
 
     bool long_offset = subset_data_size & ~0xFFFFu;
+
+    if (unlikely (!c->ensure_room (min_size +
+				   (long_offset ? 4 : 2) * (num_glyphs + 1) +
+				   F2DOT14::static_size * axisCount * sharedTupleCount +
+				   subset_data_size)))
+      return_trace (false);
+
+    gvar *out = c->serializer->allocate_min<gvar> ();
+    if (unlikely (!out)) return_trace (false);
+
+    out->version.major = 1;
+    out->version.minor = 0;
+    out->axisCount = axisCount;
+    out->sharedTupleCount = sharedTupleCount;
+    out->glyphCount = num_glyphs;
     out->flags = long_offset ? 1 : 0;
 
     HBUINT8 *subset_offsets = c->serializer->allocate_size<HBUINT8> ((long_offset ? 4 : 2) * (num_glyphs + 1));
@@ -498,6 +506,41 @@ struct gvar
     { table = hb_sanitize_context_t ().reference_table<gvar> (face); }
     void fini () { table.destroy (); }
 
+    /* Temporary vectors used by apply_deltas_to_points ().  Passing the
+     * same scratch to consecutive calls saves reallocating them for each
+     * glyph. */
+    struct scratch_t
+    {
+      void init ()
+      {
+	orig_points.init ();
+	deltas.init ();
+	end_points.init ();
+	shared_indices.init ();
+	private_indices.init ();
+	x_deltas.init ();
+	y_deltas.init ();
+      }
+      void fini ()
+      {
+	orig_points.fini ();
+	deltas.fini ();
+	end_points.fini ();
+	shared_indices.fini ();
+	private_indices.fini ();
+	x_deltas.fini ();
+	y_deltas.fini ();
+      }
+
+      contour_point_vector_t orig_points;
+      contour_point_vector_t deltas;
+      hb_vector_t<unsigned> end_points;
+      hb_vector_t<unsigned int> shared_indices;
+      hb_vector_t<unsigned int> private_indices;
+      hb_vector_t<int> x_deltas;
+      hb_vector_t<int> y_deltas;
+    };
+
     private:
     struct x_getter { static float get (const contour_point_t &p) { return p.x; } };
     struct y_getter { static float get (const contour_point_t &p) { return p.y; } };
@@ -530,7 +573,8 @@ struct gvar
 
     public:
     bool apply_deltas_to_points (hb_codepoint_t glyph, hb_font_t *font,
-				 const hb_array_t<contour_point_t> points) const
+				 const hb_array_t<contour_point_t> points,
+				 scratch_t *scratch = nullptr) const
     {
       /* num_coords should exactly match gvar's axisCount due to how GlyphVariationData tuples are aligned */
       if (!font->num_coords || font->num_coords != table->axisCount) return true;
@@ -539,22 +583,40 @@ struct gvar
 
       hb_bytes_t var_data_bytes = table->get_glyph_var_data_bytes (table.get_blob (), glyph);
       if (!var_data_bytes.as<GlyphVariationData> ()->has_data ()) return true;
-      hb_vector_t<unsigned int> shared_indices;
+
+      if (scratch)
+	return apply_deltas_to_points (var_data_bytes, font, points, *scratch);
+
+      scratch_t local_scratch;
+      local_scratch.init ();
+      bool ret = apply_deltas_to_points (var_data_bytes, font, points, local_scratch);
+      local_scratch.fini ();
+      return ret;
+    }
+
+    private:
+    bool apply_deltas_to_points (hb_bytes_t var_data_bytes, hb_font_t *font,
+				 const hb_array_t<contour_point_t> points,
+				 scratch_t &scratch) const
+    {
+      hb_vector_t<unsigned int> &shared_indices = scratch.shared_indices;
+      shared_indices.resize (0);
       GlyphVariationData::tuple_iterator_t iterator;
       if (!GlyphVariationData::get_tuple_iterator (var_data_bytes, table->axisCount,
 						   shared_indices, &iterator))
 	return true; /* so isn't applied at all */
 
       /* Save original points for inferred delta calculation */
-      contour_point_vector_t orig_points;
-      orig_points.resize (points.length);
+      contour_point_vector_t &orig_points = scratch.orig_points;
+      if (unlikely (!orig_points.resize (points.length))) return false;
       for (unsigned int i = 0; i < orig_points.length; i++)
 	orig_points[i] = points[i];
 
-      contour_point_vector_t deltas; /* flag is used to indicate referenced point */
-      deltas.resize (points.length);
+      contour_point_vector_t &deltas = scratch.deltas; /* flag is used to indicate referenced point */
+      if (unlikely (!deltas.resize (points.length))) return false;
 
-      hb_vector_t<unsigned> end_points;
+      hb_vector_t<unsigned> &end_points = scratch.end_points;
+      end_points.resize (0);
       for (unsigned i = 0; i < points.length; ++i)
 	if (points[i].is_end_point)
 	  end_points.push (i);
@@ -562,6 +624,9 @@ struct gvar
       int *coords = font->coords;
       unsigned num_coords = font->num_coords;
       hb_array_t<const F2DOT14> shared_tuples = (table+table->sharedTuples).as_array (table->sharedTupleCount * table->axisCount);
+      hb_vector_t<unsigned int> &private_indices = scratch.private_indices;
+      hb_vector_t<int> &x_deltas = scratch.x_deltas;
+      hb_vector_t<int> &y_deltas = scratch.y_deltas;
       do
       {
 	float scalar = iterator.current_tuple->calculate_scalar (coords, num_coords, shared_tuples);
@@ -572,7 +637,7 @@ struct gvar
 	  return false;
 
 	hb_bytes_t bytes ((const char *) p, length);
-	hb_vector_t<unsigned int> private_indices;
+	private_indices.resize (0);
 	if (iterator.current_tuple->has_private_points () &&
 	    !GlyphVariationData::unpack_points (p, private_indices, bytes))
 	  return false;
@@ -580,12 +645,10 @@ struct gvar
 
 	bool apply_to_all = (indices.length == 0);
 	unsigned int num_deltas = apply_to_all ? points.length : indices.length;
-	hb_vector_t<int> x_deltas;
-	x_deltas.resize (num_deltas);
+	if (unlikely (!x_deltas.resize (num_deltas))) return false;
 	if (!GlyphVariationData::unpack_deltas (p, x_deltas, bytes))
 	  return false;
-	hb_vector_t<int> y_deltas;
-	y_deltas.resize (num_deltas);
+	if (unlikely (!y_deltas.resize (num_deltas))) return false;
 	if (!GlyphVariationData::unpack_deltas (p, y_deltas, bytes))
 	  return false;
 
@@ -660,6 +723,7 @@ no_more_gaps:
       return true;
     }
 
+    public:
     unsigned int get_axis_count () const { return table->axisCount; }
 
     private:
@@ -63,6 +63,7 @@
 hb_bool_t
 hb_ot_var_has_data (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->has_data ();
 }
 
@@ -79,6 +80,7 @@ hb_ot_var_has_data (hb_face_t *face)
 unsigned int
 hb_ot_var_get_axis_count (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->get_axis_count ();
 }
 
@@ -103,6 +105,7 @@ hb_ot_var_get_axes (hb_face_t        *face,
 		    unsigned int     *axes_count /* IN/OUT */,
 		    hb_ot_var_axis_t *axes_array /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->get_axes_deprecated (start_offset, axes_count, axes_array);
 }
 
@@ -125,6 +128,7 @@ hb_ot_var_find_axis (hb_face_t        *face,
 		     unsigned int     *axis_index,
 		     hb_ot_var_axis_t *axis_info)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->find_axis_deprecated (axis_tag, axis_index, axis_info);
 }
 #endif
@@ -150,6 +154,7 @@ hb_ot_var_get_axis_infos (hb_face_t             *face,
 			  unsigned int          *axes_count /* IN/OUT */,
 			  hb_ot_var_axis_info_t *axes_array /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->get_axis_infos (start_offset, axes_count, axes_array);
 }
 
@@ -171,6 +176,7 @@ hb_ot_var_find_axis_info (hb_face_t             *face,
 			  hb_tag_t               axis_tag,
 			  hb_ot_var_axis_info_t *axis_info)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->find_axis_info (axis_tag, axis_info);
 }
 
@@ -192,6 +198,7 @@ hb_ot_var_find_axis_info (hb_face_t             *face,
 unsigned int
 hb_ot_var_get_named_instance_count (hb_face_t *face)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->get_instance_count ();
 }
 
@@ -211,6 +218,7 @@ hb_ot_name_id_t
 hb_ot_var_named_instance_get_subfamily_name_id (hb_face_t   *face,
 						unsigned int instance_index)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->get_instance_subfamily_name_id (instance_index);
 }
 
@@ -230,6 +238,7 @@ hb_ot_name_id_t
 hb_ot_var_named_instance_get_postscript_name_id (hb_face_t  *face,
 						unsigned int instance_index)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->get_instance_postscript_name_id (instance_index);
 }
 
@@ -254,6 +263,7 @@ hb_ot_var_named_instance_get_design_coords (hb_face_t    *face,
 					    unsigned int *coords_length, /* IN/OUT */
 					    float        *coords         /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   return face->table.fvar->get_instance_coords (instance_index, coords_length, coords);
 }
 
@@ -277,6 +287,7 @@ hb_ot_var_normalize_variations (hb_face_t            *face,
 				int                  *coords, /* OUT */
 				unsigned int          coords_length)
 {
+  hb_ot_face_reader_t reader (face->table);
   for (unsigned int i = 0; i < coords_length; i++)
     coords[i] = 0;
 
@@ -314,6 +325,7 @@ hb_ot_var_normalize_coords (hb_face_t    *face,
 			    const float *design_coords, /* IN */
 			    int *normalized_coords /* OUT */)
 {
+  hb_ot_face_reader_t reader (face->table);
   const OT::fvar &fvar = *face->table.fvar;
   for (unsigned int i = 0; i < coords_length; i++)
     normalized_coords[i] = fvar.normalize_axis_value (i, design_coords[i]);
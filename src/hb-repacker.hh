@@ -0,0 +1,666 @@
+/*
+ * Copyright © 2026  HarfBuzz contributors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_REPACKER_HH
+#define HB_REPACKER_HH
+
+#include "hb-open-type.hh"
+#include "hb-map.hh"
+#include "hb-priority-queue.hh"
+#include "hb-serialize.hh"
+#include "hb-set.hh"
+#include "hb-vector.hh"
+
+
+#ifndef HB_REPACKER_MAX_ROUNDS
+#define HB_REPACKER_MAX_ROUNDS 32
+#endif
+
+/*
+ * The objects packed by hb_serialize_context_t, as a graph that can be
+ * reordered, and partially duplicated, to get every offset in range.
+ *
+ * Vertices are kept in packing order: children before their parents, with
+ * the root last.  The final table lays them out in reverse.
+ */
+struct graph_t
+{
+  struct vertex_t
+  {
+    void fini () { obj.fini (); }
+
+    hb_serialize_context_t::object_t obj;
+    int64_t distance;
+    unsigned priority;
+    unsigned incoming_edges;
+    unsigned start;
+    unsigned end;
+
+    unsigned table_size () const { return obj.tail - obj.head; }
+
+    bool is_shared () const { return incoming_edges > 1; }
+
+    bool is_leaf () const { return !obj.links.length; }
+
+    bool raise_priority ()
+    {
+      if (priority >= 3) return false;
+      priority++;
+      return true;
+    }
+
+    /* Sort key for the shortest distance sort: raising the priority of an
+     * object pulls it towards its parent, and at the highest priority it
+     * goes right after it; ties keep discovery order. */
+    int64_t modified_distance (unsigned order) const
+    {
+      int64_t modifier = 0;
+      if (priority == 1) modifier = -(int64_t) table_size () / 2;
+      else if (priority > 1) modifier = -(int64_t) table_size ();
+
+      int64_t modified = hb_min (hb_max (distance + modifier, (int64_t) 0),
+				 (int64_t) 0x7FFFFFFFFFF);
+      if (priority >= 3) modified = 0;
+      return (modified << 18) | (0x3FFFF & order);
+    }
+  };
+
+  struct overflow_record_t
+  {
+    unsigned parent;
+    unsigned child;
+  };
+
+  /* objects is the serializer's packed object list; object 0 is nil. */
+  graph_t (const hb_vector_t<hb_serialize_context_t::object_t *> &objects)
+    : successful (true)
+  {
+    vertices_.init ();
+    buffers.init ();
+    for (unsigned i = 1; i < objects.length; i++)
+    {
+      vertex_t *v = vertices_.push ();
+      if (unlikely (vertices_.in_error ())) { successful = false; return; }
+      v->obj.head = objects[i]->head;
+      v->obj.tail = objects[i]->tail;
+      for (const hb_serialize_context_t::object_t::link_t &link : objects[i]->links)
+      {
+	if (unlikely (!link.objidx || link.objidx >= i)) { successful = false; return; }
+	hb_serialize_context_t::object_t::link_t *l = v->obj.links.push (link);
+	l->objidx = link.objidx - 1;
+      }
+      if (unlikely (v->obj.links.in_error ())) { successful = false; return; }
+    }
+  }
+
+  ~graph_t ()
+  {
+    vertices_.fini_deep ();
+    for (unsigned i = 0; i < buffers.length; i++)
+      free (buffers[i]);
+    buffers.fini ();
+  }
+
+  bool in_error () const { return !successful || vertices_.in_error (); }
+
+  unsigned root_idx () const { return vertices_.length - 1; }
+
+  const vertex_t &vertex (unsigned i) const { return vertices_[i]; }
+  unsigned vertex_count () const { return vertices_.length; }
+
+  /*
+   * Topologically sorts the graph, visiting vertices in breadth first
+   * order.  Vertices unreachable from the root are dropped.
+   */
+  void sort_kahn ()
+  {
+    sort ([] (const vertex_t &v HB_UNUSED, unsigned order) -> int64_t
+	  { return order; });
+  }
+
+  /*
+   * Topologically sorts the graph, placing each vertex as close as
+   * possible to the root, where the distance to a vertex is the size of
+   * the vertices on the shortest path to it.  32-bit offsets count as
+   * very long, so whatever only they point to goes last.
+   */
+  void sort_shortest_distance ()
+  {
+    if (in_error ()) return;
+    compute_distances ();
+    sort ([] (const vertex_t &v, unsigned order) -> int64_t
+	  { return v.modified_distance (order); });
+  }
+
+  /*
+   * Lays out the vertices in order and checks every offset.  Returns
+   * whether any is out of range, filling in overflows if not null.
+   */
+  bool will_overflow (hb_vector_t<overflow_record_t> *overflows = nullptr)
+  {
+    if (overflows) overflows->resize (0);
+    update_positions ();
+
+    for (int parent_idx = vertices_.length - 1; parent_idx >= 0; parent_idx--)
+    {
+      for (const hb_serialize_context_t::object_t::link_t &link : vertices_[parent_idx].obj.links)
+      {
+	if (is_valid_offset (compute_offset (parent_idx, link), link))
+	  continue;
+
+	if (!overflows) return true;
+
+	overflow_record_t *r = overflows->push ();
+	r->parent = parent_idx;
+	r->child = link.objidx;
+      }
+    }
+
+    if (!overflows) return false;
+    if (unlikely (overflows->in_error ())) successful = false;
+    return overflows->length;
+  }
+
+  /*
+   * Tries to fix the given overflows: shared children get a copy of their
+   * own, and unshared leaves are pulled closer to their parent.  Returns
+   * whether anything changed.
+   */
+  bool resolve (const hb_vector_t<overflow_record_t> &overflows)
+  {
+    bool changed = false;
+    unsigned old_root = root_idx ();
+    hb_set_t priority_bumped_parents;
+    for (const overflow_record_t &r : overflows)
+    {
+      /* Duplicating moves the root; nothing else changes place. */
+      unsigned parent = r.parent == old_root ? root_idx () : r.parent;
+      if (vertices_[r.child].is_shared () && duplicate (parent, r.child))
+      {
+	changed = true;
+	continue;
+      }
+
+      if (vertices_[r.child].is_leaf () && !priority_bumped_parents.has (parent))
+      {
+	priority_bumped_parents.add (parent);
+	if (raise_childrens_priority (parent))
+	  changed = true;
+      }
+    }
+    return changed && !in_error ();
+  }
+
+  /*
+   * Points every lookup of a GSUB / GPOS graph at extension subtables of
+   * type extension_type, so the actual subtables are reached through
+   * 32-bit offsets and can be placed after everything else.  Lookups that
+   * already are extensions are left alone.
+   */
+  bool promote_extensions (unsigned extension_type)
+  {
+    if (in_error ()) return false;
+
+    /* GSUB / GPOS header: version, then offsets to the script, feature
+     * and lookup lists. */
+    const unsigned lookup_list_position = 8;
+    unsigned lookup_list = (unsigned) -1;
+    for (const hb_serialize_context_t::object_t::link_t &link : vertices_[root_idx ()].obj.links)
+      if (link.position == lookup_list_position && !link.is_wide)
+	lookup_list = link.objidx;
+    if (lookup_list == (unsigned) -1) return false;
+
+    hb_set_t lookups;
+    for (const hb_serialize_context_t::object_t::link_t &link : vertices_[lookup_list].obj.links)
+      lookups.add (link.objidx);
+
+    bool promoted = false;
+    for (hb_codepoint_t lookup : lookups.iter ())
+    {
+      /* Lookup: lookupType, lookupFlag, subTableCount, subtable offsets. */
+      if (vertices_[lookup].table_size () < 6 || vertices_[lookup].is_leaf ())
+	continue;
+      OT::HBUINT16 *lookup_type = (OT::HBUINT16 *) vertices_[lookup].obj.head;
+      unsigned type = *lookup_type;
+      if (type == extension_type)
+	continue;
+
+      for (unsigned i = 0; i < vertices_[lookup].obj.links.length; i++)
+      {
+	unsigned ext = add_extension (type, vertices_[lookup].obj.links[i].objidx);
+	if (unlikely (in_error ())) return false;
+	vertices_[lookup].obj.links[i].objidx = ext;
+      }
+      *lookup_type = extension_type;
+      promoted = true;
+    }
+    return promoted;
+  }
+
+  /* Packs the graph, in its current order, into a new blob. */
+  hb_blob_t *serialize () const
+  {
+    if (in_error ()) return nullptr;
+
+    unsigned size = 0;
+    for (const vertex_t &v : vertices_)
+      size += v.table_size ();
+
+    hb_vector_t<char> buf;
+    if (unlikely (!buf.resize (size))) return nullptr;
+
+    hb_serialize_context_t c ((void *) buf, size);
+    c.start_serialize<void> ();
+    for (const vertex_t &v : vertices_)
+    {
+      c.push ();
+      unsigned table_size = v.table_size ();
+      char *start = c.allocate_size<char> (table_size);
+      if (unlikely (!start)) return nullptr;
+      memcpy (start, v.obj.head, table_size);
+      for (const hb_serialize_context_t::object_t::link_t &link : v.obj.links)
+	serialize_link (link, start, &c);
+      c.pop_pack (false);
+    }
+    c.end_serialize ();
+
+    if (unlikely (c.in_error ())) return nullptr;
+    return c.copy_blob ();
+  }
+
+  private:
+
+  template <typename sort_key_func_t>
+  void sort (sort_key_func_t &&sort_key)
+  {
+    if (in_error ()) return;
+    if (vertices_.length <= 1) return;
+
+    update_incoming_edge_count ();
+
+    hb_vector_t<unsigned> remaining;
+    hb_vector_t<unsigned> id_map;
+    hb_vector_t<vertex_t> sorted;
+    if (unlikely (!remaining.resize (vertices_.length) ||
+		  !id_map.resize (vertices_.length) ||
+		  !sorted.resize (vertices_.length)))
+    {
+      successful = false;
+      return;
+    }
+    for (unsigned i = 0; i < vertices_.length; i++)
+      remaining[i] = vertices_[i].incoming_edges;
+
+    hb_priority_queue_t queue;
+    unsigned order = 0;
+    queue.insert (sort_key (vertices_[root_idx ()], order++), root_idx ());
+    unsigned new_id = vertices_.length;
+    while (!queue.is_empty ())
+    {
+      unsigned next_id = queue.pop_minimum ().second;
+      new_id--;
+      id_map[next_id] = new_id;
+      sorted[new_id] = hb_move (vertices_[next_id]);
+
+      for (const hb_serialize_context_t::object_t::link_t &link : sorted[new_id].obj.links)
+	if (!--remaining[link.objidx])
+	  queue.insert (sort_key (vertices_[link.objidx], order++), link.objidx);
+    }
+    if (unlikely (queue.in_error ()))
+    {
+      successful = false;
+      return;
+    }
+
+    /* Whatever was not reached is not referenced by the table; drop it. */
+    unsigned unreachable = new_id;
+    for (unsigned i = unreachable; i < sorted.length; i++)
+    {
+      vertex_t &v = sorted[i];
+      for (unsigned j = 0; j < v.obj.links.length; j++)
+	v.obj.links[j].objidx = id_map[v.obj.links[j].objidx] - unreachable;
+      if (unreachable)
+	sorted[i - unreachable] = hb_move (v);
+    }
+    sorted.shrink (sorted.length - unreachable);
+
+    vertices_.fini_deep ();
+    vertices_ = hb_move (sorted);
+  }
+
+  void update_incoming_edge_count ()
+  {
+    for (unsigned i = 0; i < vertices_.length; i++)
+      vertices_[i].incoming_edges = 0;
+
+    /* Only count edges from vertices reachable from the root. */
+    hb_vector_t<bool> reachable;
+    hb_vector_t<unsigned> stack;
+    if (unlikely (!reachable.resize (vertices_.length))) { successful = false; return; }
+    reachable[root_idx ()] = true;
+    stack.push (root_idx ());
+    while (stack.length)
+    {
+      unsigned i = stack[stack.length - 1];
+      stack.pop ();
+      for (const hb_serialize_context_t::object_t::link_t &link : vertices_[i].obj.links)
+      {
+	vertices_[link.objidx].incoming_edges++;
+	if (reachable[link.objidx]) continue;
+	reachable[link.objidx] = true;
+	stack.push (link.objidx);
+      }
+    }
+    if (unlikely (stack.in_error ())) successful = false;
+  }
+
+  void compute_distances ()
+  {
+    for (unsigned i = 0; i < vertices_.length; i++)
+      vertices_[i].distance = hb_int_max (int64_t);
+
+    hb_vector_t<bool> visited;
+    if (unlikely (!visited.resize (vertices_.length))) { successful = false; return; }
+
+    hb_priority_queue_t queue;
+    vertices_[root_idx ()].distance = 0;
+    queue.insert (0, root_idx ());
+    while (!queue.is_empty ())
+    {
+      unsigned next_idx = queue.pop_minimum ().second;
+      if (visited[next_idx]) continue;
+      visited[next_idx] = true;
+
+      int64_t next_distance = vertices_[next_idx].distance;
+      for (const hb_serialize_context_t::object_t::link_t &link : vertices_[next_idx].obj.links)
+      {
+	if (visited[link.objidx]) continue;
+
+	vertex_t &child = vertices_[link.objidx];
+	int64_t child_weight = child.table_size () +
+			       ((int64_t) 1 << (link.is_wide ? 32 : 16));
+	int64_t child_distance = next_distance + child_weight;
+	if (child_distance < child.distance)
+	{
+	  child.distance = child_distance;
+	  queue.insert (child_distance, link.objidx);
+	}
+      }
+    }
+    if (unlikely (queue.in_error ())) successful = false;
+  }
+
+  void update_positions ()
+  {
+    unsigned current_pos = 0;
+    for (int i = vertices_.length - 1; i >= 0; i--)
+    {
+      vertices_[i].start = current_pos;
+      current_pos += vertices_[i].table_size ();
+      vertices_[i].end = current_pos;
+    }
+  }
+
+  int64_t compute_offset (unsigned parent_idx,
+			  const hb_serialize_context_t::object_t::link_t &link) const
+  {
+    const vertex_t &parent = vertices_[parent_idx];
+    const vertex_t &child = vertices_[link.objidx];
+    int64_t offset = 0;
+    switch ((hb_serialize_context_t::whence_t) link.whence)
+    {
+    case hb_serialize_context_t::Head:     offset = (int64_t) child.start - parent.start; break;
+    case hb_serialize_context_t::Tail:     offset = (int64_t) child.start - parent.end; break;
+    case hb_serialize_context_t::Absolute: offset = child.start; break;
+    }
+    return offset - link.bias;
+  }
+
+  static bool is_valid_offset (int64_t offset,
+			       const hb_serialize_context_t::object_t::link_t &link)
+  {
+    if (link.is_signed)
+    {
+      if (link.is_wide)
+	return offset >= -((int64_t) 1 << 31) && offset < ((int64_t) 1 << 31);
+      return offset >= -(1 << 15) && offset < (1 << 15);
+    }
+    if (link.is_wide)
+      return offset >= 0 && offset < ((int64_t) 1 << 32);
+    return offset >= 0 && offset < (1 << 16);
+  }
+
+  /* Appends a vertex, keeping the root last; returns its index. */
+  unsigned new_vertex ()
+  {
+    vertices_.push ();
+    if (unlikely (vertices_.in_error ()))
+    {
+      successful = false;
+      return 0;
+    }
+    unsigned idx = vertices_.length - 2;
+    vertex_t root = hb_move (vertices_[idx]);
+    vertices_[idx] = hb_move (vertices_[idx + 1]);
+    vertices_[idx + 1] = hb_move (root);
+    return idx;
+  }
+
+  /* Gives parent its own copy of child.  The copy shares child's
+   * children. */
+  bool duplicate (unsigned parent_idx, unsigned child_idx)
+  {
+    unsigned links_to_child = 0;
+    for (const hb_serialize_context_t::object_t::link_t &link : vertices_[parent_idx].obj.links)
+      if (link.objidx == child_idx) links_to_child++;
+    if (!links_to_child || vertices_[child_idx].incoming_edges <= links_to_child)
+      return false;
+
+    DEBUG_MSG (SUBSET_REPACK, nullptr, "Duplicating %d => %d", parent_idx, child_idx);
+
+    bool parent_is_root = parent_idx == root_idx ();
+    unsigned clone_idx = new_vertex ();
+    if (unlikely (in_error ())) return false;
+    if (parent_is_root) parent_idx = root_idx ();
+
+    vertex_t &child = vertices_[child_idx];
+    vertex_t &clone = vertices_[clone_idx];
+    clone.obj.head = child.obj.head;
+    clone.obj.tail = child.obj.tail;
+    clone.obj.links = child.obj.links;
+    if (unlikely (clone.obj.links.in_error ()))
+    {
+      successful = false;
+      return false;
+    }
+    clone.incoming_edges = links_to_child;
+    child.incoming_edges -= links_to_child;
+    for (const hb_serialize_context_t::object_t::link_t &link : clone.obj.links)
+      vertices_[link.objidx].incoming_edges++;
+
+    hb_vector_t<hb_serialize_context_t::object_t::link_t> &links = vertices_[parent_idx].obj.links;
+    for (unsigned i = 0; i < links.length; i++)
+      if (links[i].objidx == child_idx)
+	links[i].objidx = clone_idx;
+    return true;
+  }
+
+  bool raise_childrens_priority (unsigned parent_idx)
+  {
+    DEBUG_MSG (SUBSET_REPACK, nullptr, "Raising priority of all children of %d", parent_idx);
+    bool made_change = false;
+    for (const hb_serialize_context_t::object_t::link_t &link : vertices_[parent_idx].obj.links)
+      made_change |= vertices_[link.objidx].raise_priority ();
+    return made_change;
+  }
+
+  /* Adds an ExtensionFormat1 subtable pointing at subtable. */
+  unsigned add_extension (unsigned lookup_type, unsigned subtable)
+  {
+    /* format, extensionLookupType, 32-bit extensionOffset. */
+    const unsigned size = 8;
+    char *data = (char *) calloc (1, size);
+    buffers.push (data);
+    if (unlikely (!data || buffers.in_error ()))
+    {
+      free (data);
+      successful = false;
+      return 0;
+    }
+    * (OT::HBUINT16 *) data = 1;
+    * (OT::HBUINT16 *) (data + 2) = lookup_type;
+
+    unsigned ext = new_vertex ();
+    if (unlikely (in_error ())) return 0;
+
+    vertex_t &v = vertices_[ext];
+    v.obj.head = data;
+    v.obj.tail = data + size;
+    hb_serialize_context_t::object_t::link_t *link = v.obj.links.push ();
+    if (unlikely (v.obj.links.in_error ()))
+    {
+      successful = false;
+      return 0;
+    }
+    link->is_wide = true;
+    link->is_signed = false;
+    link->whence = hb_serialize_context_t::Head;
+    link->position = 4;
+    link->bias = 0;
+    link->objidx = subtable;
+    v.incoming_edges = 1;
+    return ext;
+  }
+
+  static void serialize_link (const hb_serialize_context_t::object_t::link_t &link,
+			      char *head,
+			      hb_serialize_context_t *c)
+  {
+    hb_serialize_context_t::whence_t whence = (hb_serialize_context_t::whence_t) link.whence;
+    char *offset = head + link.position;
+    if (link.is_wide)
+    {
+      memset (offset, 0, 4);
+      if (link.is_signed)
+	c->add_link (* (OT::HBINT32 *) offset, link.objidx + 1, whence, link.bias);
+      else
+	c->add_link (* (OT::HBUINT32 *) offset, link.objidx + 1, whence, link.bias);
+    }
+    else
+    {
+      memset (offset, 0, 2);
+      if (link.is_signed)
+	c->add_link (* (OT::HBINT16 *) offset, link.objidx + 1, whence, link.bias);
+      else
+	c->add_link (* (OT::HBUINT16 *) offset, link.objidx + 1, whence, link.bias);
+    }
+  }
+
+  private:
+  bool successful;
+  hb_vector_t<vertex_t> vertices_;
+  /* Storage for the vertices the graph makes up itself. */
+  hb_vector_t<char *> buffers;
+};
+
+static inline bool
+_hb_repack_graph (graph_t *graph, unsigned max_rounds)
+{
+  hb_vector_t<graph_t::overflow_record_t> overflows;
+  unsigned round = 0;
+  while (!graph->in_error () && graph->will_overflow (&overflows))
+  {
+    if (round++ >= max_rounds) return false;
+    DEBUG_MSG (SUBSET_REPACK, nullptr, "Overflow resolution round %u; %u overflows.",
+	       round, overflows.length);
+    if (!graph->resolve (overflows)) return false;
+    graph->sort_shortest_distance ();
+  }
+  return !graph->in_error ();
+}
+
+/*
+ * Roughly the memory hb_resolve_overflows() needs for packed: the graph,
+ * a sorted copy of it, and the repacked table.
+ */
+static inline unsigned
+hb_resolve_overflows_memory_usage (const hb_vector_t<hb_serialize_context_t::object_t *> &packed)
+{
+  unsigned size = 0;
+  for (unsigned i = 1; i < packed.length; i++)
+    size += 2 * (sizeof (graph_t::vertex_t) + sizeof (unsigned) +
+		 packed[i]->links.get_size ()) +
+	    (packed[i]->tail - packed[i]->head);
+  return size;
+}
+
+/*
+ * Lays out the objects of a serializer that ran into offset overflows
+ * again, trying to get every offset in range: first by reordering them,
+ * then by duplicating shared objects and, for GSUB and GPOS, by moving
+ * lookup subtables behind extension subtables.
+ *
+ * Returns the repacked table, or nullptr if the overflows could not be
+ * resolved.
+ */
+static inline hb_blob_t *
+hb_resolve_overflows (const hb_vector_t<hb_serialize_context_t::object_t *> &packed,
+		      hb_tag_t table_tag,
+		      unsigned max_rounds = HB_REPACKER_MAX_ROUNDS)
+{
+  {
+    graph_t sorted_graph (packed);
+    sorted_graph.sort_kahn ();
+    if (sorted_graph.in_error ()) return nullptr;
+    if (!sorted_graph.will_overflow ())
+      return sorted_graph.serialize ();
+
+    sorted_graph.sort_shortest_distance ();
+    if (_hb_repack_graph (&sorted_graph, max_rounds))
+      return sorted_graph.serialize ();
+  }
+
+  /* ExtensionSubst / ExtensionPos lookup types. */
+  unsigned extension_type;
+  switch (table_tag)
+  {
+  case HB_OT_TAG_GSUB: extension_type = 7; break;
+  case HB_OT_TAG_GPOS: extension_type = 9; break;
+  default: return nullptr;
+  }
+
+  DEBUG_MSG (SUBSET_REPACK, nullptr, "Promoting lookups to extension lookups.");
+  graph_t promoted_graph (packed);
+  promoted_graph.sort_kahn ();
+  if (!promoted_graph.promote_extensions (extension_type))
+    return nullptr;
+  promoted_graph.sort_shortest_distance ();
+  if (_hb_repack_graph (&promoted_graph, max_rounds))
+    return promoted_graph.serialize ();
+
+  return nullptr;
+}
+
+
+#endif /* HB_REPACKER_HH */
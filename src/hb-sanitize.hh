@@ -97,7 +97,25 @@
  * The same argument can be made re GSUB/GPOS/GDEF, but there, the table
  * structure is so complicated that by checking all offsets at sanitize() time,
  * we make the code much simpler in other methods, as offsets and referenced
- * objects do not need to be validated at each use site.
+ * objects do not need to be validated at each use site.  The face's GSUB/GPOS
+ * accelerators still defer that cost to when a lookup is first used: they
+ * sanitize the subtables one lookup at a time.
+ *
+ *
+ * === Trusted tables ===
+ *
+ * For fonts that are loaded over and over, such as system fonts, walking the
+ * big tables every time is wasted work.  A face given a trusted accelerator
+ * cache (see hb_face_set_trusted_accelerator_cache()) looks up the tables it
+ * loads in the cache, which records those that sanitized without edits when
+ * the cache was built, along with their length and hash.  reference_table()
+ * returns such a table without sanitizing it if it still matches.  Faces
+ * without a trusted cache, and tables that don't match, are sanitized as
+ * usual.
+ *
+ * Faces made from the same blob with hb_face_create(), such as the faces of
+ * a font collection, also share which tables passed sanitize unedited, so a
+ * table they have in common is only sanitized once.
  */
 
 /* This limits sanitizing time on really broken fonts. */
@@ -117,6 +135,29 @@
 #define HB_SANITIZE_MAX_SUTABLES 0x4000
 #endif
 
+/* Whether @table is known to pass sanitize as @type with @num_glyphs: from
+ * the face's trusted cache, or because a face made from the same blob did
+ * sanitize it already, as recorded by hb_face_table_set_sanitized().  See
+ * hb-face.cc. */
+HB_INTERNAL bool
+hb_face_table_is_sanitized (const hb_face_t *face,
+			    hb_tag_t tag,
+			    hb_blob_t *table,
+			    unsigned int num_glyphs,
+			    const void *type);
+HB_INTERNAL void
+hb_face_table_set_sanitized (const hb_face_t *face,
+			     hb_tag_t tag,
+			     hb_blob_t *table,
+			     unsigned int num_glyphs,
+			     const void *type);
+
+/* A distinct address per table type, to tell them apart at runtime. */
+template <typename Type>
+struct hb_sanitize_type_id_t { static const char id; };
+template <typename Type>
+const char hb_sanitize_type_id_t<Type>::id = 0;
+
 struct hb_sanitize_context_t :
        hb_dispatch_context_t<hb_sanitize_context_t, bool, HB_DEBUG_SANITIZE>
 {
@@ -126,7 +167,8 @@ struct hb_sanitize_context_t :
 	writable (false), edit_count (0),
 	blob (nullptr),
 	num_glyphs (65536),
-	num_glyphs_set (false) {}
+	num_glyphs_set (false),
+	edited (false) {}
 
   const char *get_name () { return "SANITIZE"; }
   template <typename T, typename F>
@@ -159,6 +201,7 @@ struct hb_sanitize_context_t :
   {
     this->blob = hb_blob_reference (b);
     this->writable = false;
+    this->edited = false;
   }
 
   void set_num_glyphs (unsigned int num_glyphs_)
@@ -337,6 +380,7 @@ struct hb_sanitize_context_t :
       if (edit_count)
       {
 	DEBUG_MSG_FUNC (SANITIZE, start, "passed first round with %d edits; going for second round", edit_count);
+	edited = true;
 
 	/* sanitize again to ensure no toe-stepping */
 	edit_count = 0;
@@ -383,9 +427,23 @@ struct hb_sanitize_context_t :
   {
     if (!num_glyphs_set)
       set_num_glyphs (hb_face_get_glyph_count (face));
-    return sanitize_blob<Type> (hb_face_reference_table (face, tableTag));
+    const void *type = &hb_sanitize_type_id_t<Type>::id;
+    hb_blob_t *table = hb_face_reference_table (face, tableTag);
+    if (hb_face_table_is_sanitized (face, tableTag, table, num_glyphs, type))
+    {
+      DEBUG_MSG (SANITIZE, table->data, "%c%c%c%c trusted", HB_UNTAG (tableTag));
+      hb_blob_make_immutable (table);
+      return table;
+    }
+    table = sanitize_blob<Type> (table);
+    if (!edited)
+      hb_face_table_set_sanitized (face, tableTag, table, num_glyphs, type);
+    return table;
   }
 
+  /* Whether the last sanitize_blob() call had to modify the blob. */
+  bool was_edited () const { return edited; }
+
   const char *start, *end;
   mutable int max_ops, max_subtables;
   private:
@@ -394,6 +452,7 @@ struct hb_sanitize_context_t :
   hb_blob_t *blob;
   unsigned int num_glyphs;
   bool  num_glyphs_set;
+  bool  edited;
 };
 
 struct hb_sanitize_with_object_t
@@ -62,12 +62,39 @@ struct hb_serialize_context_t
 	  && 0 == hb_memcmp (head, o.head, tail - head)
 	  && links.as_bytes () == o.links.as_bytes ();
     }
-    uint32_t hash () const
+    uint32_t hash () const { return hash_value; }
+
+    /* Hashes the finished object for packed_map.  The length goes in first,
+     * so objects of different sizes mostly end up in different buckets
+     * without ever being compared. */
+    void update_hash ()
     {
-      return hb_bytes_t (head, tail - head).hash () ^
-	     links.as_bytes ().hash ();
+      uint32_t h = (uint32_t) (tail - head) * 2654435761u;
+      h = hash_bytes (h, hb_bytes_t (head, tail - head));
+      h = hash_bytes (h, links.as_bytes ());
+      hash_value = h ^ (h >> 16);
     }
 
+    private:
+    /* Word at a time; much cheaper than hb_bytes_t::hash() on the large
+     * objects CFF and GPOS subsetting produce. */
+    static uint32_t hash_bytes (uint32_t h, hb_bytes_t bytes)
+    {
+      const char *p = bytes.arrayZ;
+      unsigned int n = bytes.length;
+      for (; n >= 4; p += 4, n -= 4)
+      {
+	uint32_t v;
+	memcpy (&v, p, 4);
+	h = (h ^ v) * 16777619u;
+      }
+      for (; n; p++, n--)
+	h = (h ^ (uint8_t) *p) * 16777619u;
+      return h;
+    }
+
+    public:
+
     struct link_t
     {
       bool is_wide: 1;
@@ -82,6 +109,7 @@ struct hb_serialize_context_t
     char *tail;
     hb_vector_t<link_t> links;
     object_t *next;
+    uint32_t hash_value;
   };
 
   struct snapshot_t
@@ -123,6 +151,10 @@ struct hb_serialize_context_t
   {
     this->successful = true;
     this->ran_out_of_room = false;
+    this->offset_overflow = false;
+    this->share_budget = (unsigned) -1;
+    this->memory_budget = (unsigned) -1;
+    this->memory_used = 0;
     this->head = this->start;
     this->tail = this->end;
     this->debug_depth = 0;
@@ -131,6 +163,44 @@ struct hb_serialize_context_t
     this->packed.push (nullptr);
   }
 
+  /* Moves serialization to a different buffer.  Only possible while
+   * nothing has been serialized yet. */
+  bool relocate (void *start_, unsigned int size)
+  {
+    if (unlikely (in_error () ||
+		  head != start || tail != end ||
+		  packed.length > 1))
+      return false;
+
+    start = (char *) start_;
+    end = start + size;
+    head = start;
+    tail = end;
+    for (object_t *obj = current; obj; obj = obj->next)
+    {
+      obj->head = head;
+      obj->tail = tail;
+    }
+    return true;
+  }
+
+  /* Caps how many bytes of packed objects are hashed and compared looking
+   * for duplicates; objects packed after the budget runs out are not
+   * shared.  Trades output size for serialization time.  0 disables
+   * sharing; the default is unlimited. */
+  void set_share_budget (unsigned int budget)
+  { share_budget = budget; }
+
+  /* Caps the bytes of bookkeeping kept for the packed objects: the objects
+   * themselves, their links, and the packed list and map.  Packing more is
+   * an error.  The default is unlimited. */
+  void set_memory_budget (unsigned int budget)
+  { memory_budget = budget; }
+
+  /* Bytes of bookkeeping kept for the packed objects so far. */
+  unsigned int get_memory_usage () const
+  { return memory_used; }
+
   bool check_success (bool success)
   { return this->successful && (success || (err_other_error (), false)); }
 
@@ -199,6 +269,7 @@ struct hb_serialize_context_t
       obj->head = head;
       obj->tail = tail;
       obj->next = current;
+      obj->hash_value = 0;
       current = obj;
     }
     return start_embed<Type> ();
@@ -218,6 +289,7 @@ struct hb_serialize_context_t
   /* Set share to false when an object is unlikely sharable with others
    * so not worth an attempt, or a contiguous table is serialized as
    * multiple consecutive objects in the reverse order so can't be shared.
+   * Objects are also not shared once the share budget is used up.
    */
   objidx_t pop_pack (bool share=true)
   {
@@ -237,9 +309,14 @@ struct hb_serialize_context_t
       return 0;
     }
 
+    if (share && len > share_budget)
+      share = false;
+
     objidx_t objidx;
     if (share)
     {
+      share_budget -= len;
+      obj->update_hash ();
       objidx = packed_map.get (obj);
       if (objidx)
       {
@@ -248,6 +325,19 @@ struct hb_serialize_context_t
       }
     }
 
+    /* The map is kept at most two-thirds full. */
+    unsigned size = sizeof (object_t) + obj->links.get_allocated_size () +
+		    sizeof (object_t *) +
+		    (share ? 2 * sizeof (decltype (packed_map)::item_t) : 0);
+    if (unlikely (size > memory_budget - memory_used))
+    {
+      DEBUG_MSG (SERIALIZE, this->start, "memory budget of %u bytes used up", memory_budget);
+      err_other_error ();
+      obj->fini ();
+      return 0;
+    }
+    memory_used += size;
+
     tail -= len;
     memmove (tail, obj->head, len);
 
@@ -399,6 +489,7 @@ struct hb_serialize_context_t
 
   /* Following two functions exist to allow setting breakpoint on. */
   void err_ran_out_of_room () { this->ran_out_of_room = true; }
+  void err_offset_overflow () { this->offset_overflow = true; this->successful = false; }
   void err_other_error () { this->successful = false; }
 
   template <typename Type>
@@ -525,14 +616,22 @@ struct hb_serialize_context_t
   {
     auto &off = * ((BEInt<T, sizeof (T)> *) (parent->head + link.position));
     assert (0 == off);
-    check_assign (off, offset);
+    off = offset;
+    if (unlikely ((long long) off != (long long) offset))
+      err_offset_overflow ();
   }
 
+  public:
+  /* The packed objects, for the repacker; object 0 is the nil object. */
+  const hb_vector_t<object_t *>& object_graph () const
+  { return packed; }
+
   public: /* TODO Make private. */
   char *start, *head, *tail, *end;
   unsigned int debug_depth;
   bool successful;
   bool ran_out_of_room;
+  bool offset_overflow;
 
   private:
 
@@ -547,6 +646,13 @@ struct hb_serialize_context_t
 
   /* Map view of packed objects. */
   hb_hashmap_t<const object_t *, objidx_t, nullptr, 0> packed_map;
+
+  /* Bytes pop_pack() may still hash looking for objects to share. */
+  unsigned int share_budget;
+
+  /* Bytes of bookkeeping pop_pack() may keep, and has kept. */
+  unsigned int memory_budget;
+  unsigned int memory_used;
 };
 
 
@@ -467,6 +467,7 @@ struct hb_set_t
     if (!resize (count))
       return;
     population = other->population;
+    if (!count) return;
     memcpy ((void *) pages, (const void *) other->pages, count * pages.item_size);
     memcpy ((void *) page_map, (const void *) other->page_map, count * page_map.item_size);
   }
@@ -786,6 +787,8 @@ struct hb_set_t
     population = pop;
     return pop;
   }
+  unsigned int get_allocated_size () const
+  { return page_map.get_allocated_size () + pages.get_allocated_size (); }
   hb_codepoint_t get_min () const
   {
     unsigned int count = pages.length;
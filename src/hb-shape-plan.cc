@@ -383,6 +383,17 @@ hb_shape_plan_get_shaper (hb_shape_plan_t *shape_plan)
   return shape_plan->key.shaper_name;
 }
 
+unsigned int
+hb_shape_plan_t::get_memory_usage () const
+{
+  unsigned int size = sizeof (*this) +
+		      key.num_user_features * sizeof (key.user_features[0]);
+#ifndef HB_NO_OT_SHAPE
+  size += ot.map.get_memory_usage ();
+#endif
+  return size;
+}
+
 
 static bool
 _hb_shape_plan_execute_internal (hb_shape_plan_t    *shape_plan,
@@ -64,6 +64,9 @@ struct hb_shape_plan_key_t
 
 struct hb_shape_plan_t
 {
+  /* The plan object and its map; not the data of complex shapers. */
+  HB_INTERNAL unsigned int get_memory_usage () const;
+
   hb_object_header_t header;
   hb_face_t *face_unsafe; /* We don't carry a reference to face. */
   hb_shape_plan_key_t key;
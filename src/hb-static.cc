@@ -57,9 +57,11 @@ const unsigned char _hb_Null_AAT_Lookup[2] = {0xFF, 0xFF};
 unsigned int
 hb_face_t::load_num_glyphs () const
 {
+  /* Not reference_table(), which looks up sanitize results in the face;
+   * that is library-internal, and this file is also linked into tests. */
   hb_sanitize_context_t c = hb_sanitize_context_t ();
   c.set_num_glyphs (0); /* So we don't recurse ad infinitum. */
-  hb_blob_t *maxp_blob = c.reference_table<OT::maxp> (this);
+  hb_blob_t *maxp_blob = c.sanitize_blob<OT::maxp> (hb_face_reference_table (this, OT::maxp::tableTag));
   const OT::maxp *maxp_table = maxp_blob->as<OT::maxp> ();
 
   unsigned int ret = maxp_table->get_num_glyphs ();
@@ -71,8 +73,11 @@ hb_face_t::load_num_glyphs () const
 unsigned int
 hb_face_t::load_upem () const
 {
-  unsigned int ret = table.head->get_upem ();
+  hb_sanitize_context_t c = hb_sanitize_context_t ();
+  hb_blob_t *head_blob = c.sanitize_blob<OT::head> (hb_face_reference_table (this, OT::head::tableTag));
+  unsigned int ret = head_blob->as<OT::head> ()->get_upem ();
   upem.set_relaxed (ret);
+  hb_blob_destroy (head_blob);
   return ret;
 }
 
@@ -88,25 +93,205 @@ hb_user_data_array_t::set (hb_user_data_key_t *key,
   if (!key)
     return false;
 
-  if (replace) {
-    if (!data && !destroy) {
-      items.remove (key, lock);
-      return true;
+  bool remove = replace && !data && !destroy;
+
+  lock.lock ();
+
+  items_t *array = items.get_relaxed ();
+  unsigned int count = array ? array->length.get_relaxed () : 0;
+  hb_user_data_item_t *item = nullptr;
+  for (unsigned int i = 0; i < count; i++)
+    if (array->arrayZ[i].key == key)
+    {
+      item = &array->arrayZ[i];
+      break;
+    }
+
+  if (item && item->present)
+  {
+    if (!replace)
+    {
+      lock.unlock ();
+      return false;
     }
+    void *old_data = item->data.get_relaxed ();
+    hb_destroy_func_t old_destroy = item->destroy;
+    item->data.set (data);
+    item->destroy = destroy;
+    item->present = !remove;
+    reclaim ();
+    lock.unlock ();
+    if (old_destroy)
+      old_destroy (old_data);
+    return true;
   }
-  hb_user_data_item_t item = {key, data, destroy};
-  bool ret = !!items.replace_or_insert (item, lock, (bool) replace);
 
-  return ret;
+  if (remove)
+  {
+    reclaim ();
+    lock.unlock ();
+    return true;
+  }
+
+  if (item)
+  {
+    /* Removed earlier; the item is still ours. */
+    item->destroy = destroy;
+    item->present = true;
+    item->data.set (data);
+    reclaim ();
+    lock.unlock ();
+    return true;
+  }
+
+  if (array && count < array->allocated)
+  {
+    item = &array->arrayZ[count];
+    item->key = key;
+    item->data.set_relaxed (data);
+    item->destroy = destroy;
+    item->present = true;
+    array->length.set (count + 1);
+    reclaim ();
+    lock.unlock ();
+    return true;
+  }
+
+  /* Full; move the items that are present to a new array, which drops the
+   * removed ones.  Readers may still be scanning the old one, so retire it. */
+  unsigned int live = 0;
+  for (unsigned int i = 0; i < count; i++)
+    live += array->arrayZ[i].present;
+  unsigned int allocated = hb_max (8u, 2 * (live + 1));
+  items_t *new_array = (items_t *) calloc (1, sizeof (items_t) +
+					      (allocated - HB_VAR_ARRAY) * sizeof (hb_user_data_item_t));
+  if (unlikely (!new_array))
+  {
+    lock.unlock ();
+    return false;
+  }
+  unsigned int j = 0;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    const hb_user_data_item_t &old = array->arrayZ[i];
+    if (!old.present) continue;
+    hb_user_data_item_t &copy = new_array->arrayZ[j++];
+    copy.key = old.key;
+    copy.data.set_relaxed (old.data.get_relaxed ());
+    copy.destroy = old.destroy;
+    copy.present = true;
+  }
+  item = &new_array->arrayZ[j++];
+  item->key = key;
+  item->data.set_relaxed (data);
+  item->destroy = destroy;
+  item->present = true;
+  new_array->length.set_relaxed (j);
+  new_array->allocated = allocated;
+  items.set (new_array);
+  if (array)
+  {
+    array->next_retired = retired;
+    array->drained = 0;
+    retired = array;
+  }
+  reclaim ();
+
+  lock.unlock ();
+  return true;
 }
 
 void *
 hb_user_data_array_t::get (hb_user_data_key_t *key)
 {
-  hb_user_data_item_t item = {nullptr, nullptr, nullptr};
+  void *data = nullptr;
+  unsigned int phase = readers.enter ();
+  if (const items_t *array = items.get ())
+  {
+    unsigned int count = array->length.get ();
+    for (unsigned int i = 0; i < count; i++)
+      if (array->arrayZ[i].key == key)
+      {
+	data = array->arrayZ[i].data.get ();
+	break;
+      }
+  }
+  readers.leave (phase);
+  return data;
+}
 
-  return items.find (key, &item, lock) ? item.data : nullptr;
+/* Frees the retired arrays no reader can be scanning anymore.  Called with
+ * the lock held, after every change.  Lookups are short, so should retired
+ * arrays pile up, wait for the readers instead of keeping more. */
+void
+hb_user_data_array_t::reclaim ()
+{
+  unsigned int kept;
+  do
+  {
+    if (!retired)
+      return;
+
+    unsigned int drained = readers.flip ();
+    kept = 0;
+    items_t **p = &retired;
+    while (items_t *array = *p)
+    {
+      array->drained |= drained;
+      if (array->drained == 3)
+      {
+	*p = array->next_retired;
+	free (array);
+      }
+      else
+      {
+	p = &array->next_retired;
+	kept++;
+      }
+    }
+  }
+  while (kept > HB_USER_DATA_MAX_RETIRED);
 }
 
+void
+hb_user_data_array_t::fini ()
+{
+  /* Destroy callbacks may call back into us, so don't hold the lock while
+   * running them.  Nobody else is looking anymore, so drop each item from
+   * the end as we go, like popping. */
+  lock.lock ();
+  for (;;)
+  {
+    items_t *array = items.get_relaxed ();
+    unsigned int count = array ? array->length.get_relaxed () : 0;
+    while (count && !array->arrayZ[count - 1].present)
+      count--;
+    if (!count)
+    {
+      if (array)
+	array->length.set_relaxed (0);
+      break;
+    }
+    hb_user_data_item_t *item = &array->arrayZ[count - 1];
+    void *old_data = item->data.get_relaxed ();
+    hb_destroy_func_t old_destroy = item->destroy;
+    array->length.set_relaxed (count - 1);
+    lock.unlock ();
+    if (old_destroy)
+      old_destroy (old_data);
+    lock.lock ();
+  }
+  lock.unlock ();
+
+  free (items.get_relaxed ());
+  items.init ();
+  while (retired)
+  {
+    items_t *next = retired->next_retired;
+    free (retired);
+    retired = next;
+  }
+  lock.fini ();
+}
 
 #endif
@@ -84,6 +84,7 @@ typedef enum {
 float
 hb_style_get_value (hb_font_t *font, hb_tag_t tag)
 {
+  hb_ot_face_reader_t reader (font->face->table);
   hb_style_tag_t style_tag = (hb_style_tag_t) tag;
   hb_face_t *face = font->face;
 
@@ -0,0 +1,315 @@
+/*
+ * Copyright © 2026  HarfBuzz contributors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_SUBSET_ACCELERATOR_HH
+#define HB_SUBSET_ACCELERATOR_HH
+
+#include "hb.hh"
+
+#include "hb-map.hh"
+#include "hb-set.hh"
+#include "hb-mutex.hh"
+
+#include "hb-ot-cmap-table.hh"
+#include "hb-ot-glyf-table.hh"
+#include "hb-ot-layout-gdef-table.hh"
+#include "hb-ot-layout-gpos-table.hh"
+#include "hb-ot-layout-gsub-table.hh"
+#include "hb-ot-cff1-table.hh"
+#include "hb-ot-color-colr-table.hh"
+
+
+#ifndef HB_SUBSET_CLOSURE_CACHE_SIZE
+#define HB_SUBSET_CLOSURE_CACHE_SIZE 8
+#endif
+
+/*
+ * Everything plan creation needs from the source face that does not
+ * depend on the subset input.  A plan either builds a temporary one, or
+ * uses the one hb_subset_preprocess() attached to the face, in which case
+ * the cmap is also flattened and GSUB closures are remembered so they can
+ * be shared between plans.
+ */
+struct hb_subset_accelerator_t
+{
+  static const hb_user_data_key_t *user_data_key ()
+  {
+    static hb_user_data_key_t key;
+    return &key;
+  }
+
+  static hb_subset_accelerator_t *create (hb_face_t *face)
+  {
+    hb_subset_accelerator_t *accel = (hb_subset_accelerator_t *) calloc (1, sizeof (hb_subset_accelerator_t));
+    if (unlikely (!accel)) return nullptr;
+    accel->init (face, true, true);
+    return accel;
+  }
+
+  static void destroy (void *data)
+  {
+    hb_subset_accelerator_t *accel = (hb_subset_accelerator_t *) data;
+    if (!accel) return;
+    accel->fini ();
+    free (accel);
+  }
+
+  static const hb_subset_accelerator_t *get (const hb_face_t *face)
+  {
+    return (const hb_subset_accelerator_t *)
+	   hb_face_get_user_data (face, (hb_user_data_key_t *) user_data_key ());
+  }
+
+  void init (hb_face_t *face, bool cached_, bool layout)
+  {
+    cached = cached_;
+
+    cmap.init (face);
+    glyf.init (face);
+#ifndef HB_NO_SUBSET_CFF
+    cff.init (face);
+#endif
+    colr.init (face);
+
+    unicodes.init ();
+    unicode_to_gid.init ();
+    gsub_lookups.init ();
+    gpos_lookups.init ();
+    lock.init ();
+    closures.init ();
+    next_closure = 0;
+
+    if (!layout)
+    {
+      gsub = hb_blob_get_empty ();
+      gpos = hb_blob_get_empty ();
+      gdef = hb_blob_get_empty ();
+    }
+    else
+    {
+      gsub = hb_sanitize_context_t ().reference_table<OT::GSUB> (face);
+      gpos = hb_sanitize_context_t ().reference_table<OT::GPOS> (face);
+      gdef = hb_sanitize_context_t ().reference_table<OT::GDEF> (face);
+#ifndef HB_NO_SUBSET_LAYOUT
+      hb_ot_layout_collect_lookups (face, HB_OT_TAG_GSUB, nullptr, nullptr, nullptr, &gsub_lookups);
+      hb_ot_layout_collect_lookups (face, HB_OT_TAG_GPOS, nullptr, nullptr, nullptr, &gpos_lookups);
+#endif
+    }
+
+    if (cached)
+    {
+      hb_set_t all_unicodes;
+      cmap.collect_unicodes (&all_unicodes, UINT_MAX);
+      for (hb_codepoint_t cp : all_unicodes.iter ())
+      {
+	hb_codepoint_t gid;
+	if (!cmap.get_nominal_glyph (cp, &gid)) continue;
+	unicodes.add (cp);
+	unicode_to_gid.set (cp, gid);
+      }
+    }
+
+    /* Sets compute their population lazily; do it now, before the sets
+     * are shared between threads. */
+    unicodes.get_population ();
+    gsub_lookups.get_population ();
+    gpos_lookups.get_population ();
+  }
+
+  void fini ()
+  {
+    gdef.destroy ();
+    gpos.destroy ();
+    gsub.destroy ();
+    for (unsigned i = 0; i < closures.length; i++)
+      closures[i].fini ();
+    closures.fini ();
+    lock.fini ();
+    gpos_lookups.fini ();
+    gsub_lookups.fini ();
+    unicode_to_gid.fini ();
+    unicodes.fini ();
+
+    colr.fini ();
+#ifndef HB_NO_SUBSET_CFF
+    cff.fini ();
+#endif
+    glyf.fini ();
+    cmap.fini ();
+  }
+
+  /* Adds the glyphs mapped from @input_unicodes to @glyphs and records
+   * the mapped code points in @plan_unicodes. */
+  void map_unicodes (const hb_set_t *input_unicodes,
+		     hb_set_t       *plan_unicodes,
+		     hb_map_t       *codepoint_to_glyph,
+		     hb_set_t       *glyphs) const
+  {
+    if (cached && input_unicodes->get_population () > unicodes.get_population ())
+    {
+      /* Faster to walk the (smaller) cmap than the request. */
+      for (hb_codepoint_t cp : unicodes.iter ())
+	if (input_unicodes->has (cp))
+	  add_mapping (cp, unicode_to_gid.get (cp), plan_unicodes, codepoint_to_glyph, glyphs);
+      return;
+    }
+
+    hb_codepoint_t cp = HB_SET_VALUE_INVALID;
+    while (input_unicodes->next (&cp))
+    {
+      hb_codepoint_t gid;
+      if (!get_nominal_glyph (cp, &gid))
+      {
+	DEBUG_MSG(SUBSET, nullptr, "Drop U+%04X; no gid", cp);
+	continue;
+      }
+      add_mapping (cp, gid, plan_unicodes, codepoint_to_glyph, glyphs);
+    }
+  }
+
+#ifndef HB_NO_SUBSET_LAYOUT
+  /* Closes @glyphs over GSUB, and returns the closed-over lookups in
+   * @lookup_indices.  Results are shared through the face when cached.
+   * Returns false if @keep_going stopped the closure. */
+  bool gsub_closure (hb_face_t *face,
+		     hb_set_t  *glyphs,
+		     hb_set_t  *lookup_indices,
+		     bool (*keep_going) (unsigned int ops, void *user_data) = nullptr,
+		     void      *user_data = nullptr) const
+  {
+    if (cached && lookup_closure (glyphs, lookup_indices))
+      return true;
+
+    hb_set_t input;
+    if (cached) input.set (glyphs);
+
+    lookup_indices->set (&gsub_lookups);
+    if (!hb_ot_layout_lookups_substitute_closure_bounded (face, lookup_indices, glyphs,
+							  keep_going, user_data))
+      return false;
+    gsub->closure_lookups (face, glyphs, lookup_indices);
+
+    if (cached && !input.in_error () && !glyphs->in_error () && !lookup_indices->in_error ())
+      remember_closure (&input, glyphs, lookup_indices);
+    return true;
+  }
+#endif
+
+  private:
+  bool get_nominal_glyph (hb_codepoint_t cp, hb_codepoint_t *gid) const
+  {
+    if (!cached) return cmap.get_nominal_glyph (cp, gid);
+    *gid = unicode_to_gid.get (cp);
+    return *gid != HB_MAP_VALUE_INVALID;
+  }
+
+  static void add_mapping (hb_codepoint_t  cp,
+			   hb_codepoint_t  gid,
+			   hb_set_t       *plan_unicodes,
+			   hb_map_t       *codepoint_to_glyph,
+			   hb_set_t       *glyphs)
+  {
+    plan_unicodes->add (cp);
+    codepoint_to_glyph->set (cp, gid);
+    glyphs->add (gid);
+  }
+
+  struct closure_t
+  {
+    void init () { input.init (); glyphs.init (); lookups.init (); }
+    void fini () { input.fini (); glyphs.fini (); lookups.fini (); }
+
+    hb_set_t input;
+    hb_set_t glyphs;
+    hb_set_t lookups;
+  };
+
+  bool lookup_closure (hb_set_t *glyphs, hb_set_t *lookup_indices) const
+  {
+    hb_lock_t l (lock);
+    for (const closure_t &closure : closures)
+      if (closure.input.is_equal (glyphs))
+      {
+	glyphs->set (&closure.glyphs);
+	lookup_indices->set (&closure.lookups);
+	return true;
+      }
+    return false;
+  }
+
+  void remember_closure (const hb_set_t *input,
+			 const hb_set_t *glyphs,
+			 const hb_set_t *lookup_indices) const
+  {
+    hb_lock_t l (lock);
+    closure_t *closure;
+    if (closures.length < HB_SUBSET_CLOSURE_CACHE_SIZE)
+    {
+      closure = closures.push ();
+      if (unlikely (closures.in_error ())) return;
+      closure->init ();
+    }
+    else
+    {
+      closure = &closures[next_closure];
+      next_closure = (next_closure + 1) % HB_SUBSET_CLOSURE_CACHE_SIZE;
+    }
+    closure->input.set (input);
+    closure->glyphs.set (glyphs);
+    closure->lookups.set (lookup_indices);
+    if (unlikely (closure->input.in_error () ||
+		  closure->glyphs.in_error () ||
+		  closure->lookups.in_error ()))
+      closure->input.clear (); /* An empty input never matches a real plan. */
+  }
+
+  public:
+  bool cached;
+
+  OT::cmap::accelerator_t cmap;
+  OT::glyf::accelerator_t glyf;
+#ifndef HB_NO_SUBSET_CFF
+  OT::cff1::accelerator_t cff;
+#endif
+  OT::COLR::accelerator_t colr;
+  hb_blob_ptr_t<OT::GSUB> gsub;
+  hb_blob_ptr_t<OT::GPOS> gpos;
+  hb_blob_ptr_t<OT::GDEF> gdef;
+
+  /* Every lookup index reachable from the script / feature lists. */
+  hb_set_t gsub_lookups;
+  hb_set_t gpos_lookups;
+
+  /* Flattened cmap; only filled in when cached. */
+  hb_set_t unicodes;
+  hb_map_t unicode_to_gid;
+
+  private:
+  mutable hb_mutex_t lock;
+  mutable hb_vector_t<closure_t> closures;
+  mutable unsigned next_closure;
+};
+
+
+#endif /* HB_SUBSET_ACCELERATOR_HH */
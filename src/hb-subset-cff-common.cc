@@ -224,4 +224,402 @@ hb_serialize_cff_fdselect (hb_serialize_context_t *c,
 }
 
 
+/*
+ * Subroutinizer
+ *
+ * A flattened charstring is a sequence of tokens: an operator along with
+ * its operands.  Runs of path tokens that repeat across charstrings are
+ * moved into new global subroutines, greedily, the runs saving the most
+ * bytes first.  Hint operators, vsindex, endchar and the first operator
+ * of each charstring, which may carry the advance width, stay where they
+ * are; the operand stack is empty between tokens, so the runs can be
+ * replaced by a subroutine call as is.  Subroutines don't call each other.
+ */
+
+/* Longest run of tokens considered for a subroutine. */
+#ifndef HB_CFF_SUBR_MAX_TOKENS
+#define HB_CFF_SUBR_MAX_TOKENS 32
+#endif
+
+#define CFF_MAX_SUBRS 65535u
+
+struct cff_subroutinizer_t
+{
+  static constexpr unsigned NOT_MOVABLE = (unsigned) -1;
+  static constexpr unsigned UNCLAIMED = (unsigned) -1;
+  static constexpr unsigned COVERED = (unsigned) -2;
+  /* What a call costs at most: a two byte subroutine number and callgsubr. */
+  static constexpr unsigned CALL_SIZE = 3;
+  /* What a subroutine costs besides its tokens: return and an INDEX offset. */
+  static constexpr unsigned SUBR_OVERHEAD = 1 + 3;
+
+  struct token_t
+  {
+    unsigned int glyph;
+    unsigned int start;
+    unsigned int length;
+    unsigned int id;	/* Same for identical movable tokens. */
+    unsigned int run;	/* Movable tokens from this one to the end of its run. */
+  };
+
+  struct candidate_t
+  {
+    static int cmp (const void *pa, const void *pb)
+    {
+      const candidate_t *a = (const candidate_t *) pa;
+      const candidate_t *b = (const candidate_t *) pb;
+      if (a->savings != b->savings) return a->savings > b->savings ? -1 : 1;
+      if (a->num_tokens != b->num_tokens) return a->num_tokens > b->num_tokens ? -1 : 1;
+      return a->first < b->first ? -1 : a->first > b->first ? 1 : 0;
+    }
+
+    unsigned int first;		/* Into occurrences. */
+    unsigned int count;
+    unsigned int num_tokens;
+    int savings;
+  };
+
+  struct subr_t
+  {
+    unsigned int token;		/* First token of one of its runs. */
+    unsigned int num_tokens;
+    unsigned int uses;
+  };
+
+  cff_subroutinizer_t (str_buff_vec_t &charstrings_, bool is_cff2_)
+    : charstrings (charstrings_), is_cff2 (is_cff2_) {}
+
+  static bool is_path_op (op_code_t op)
+  {
+    switch (op)
+    {
+    case OpCode_rmoveto: case OpCode_hmoveto: case OpCode_vmoveto:
+    case OpCode_rlineto: case OpCode_hlineto: case OpCode_vlineto:
+    case OpCode_rrcurveto: case OpCode_rcurveline: case OpCode_rlinecurve:
+    case OpCode_vvcurveto: case OpCode_hhcurveto:
+    case OpCode_vhcurveto: case OpCode_hvcurveto:
+    case OpCode_hflex: case OpCode_flex: case OpCode_hflex1: case OpCode_flex1:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  const unsigned char *token_bytes (const token_t &t) const
+  { return charstrings[t.glyph].arrayZ + t.start; }
+
+  unsigned int run_size (unsigned int first, unsigned int num_tokens) const
+  {
+    unsigned int size = 0;
+    for (unsigned int i = 0; i < num_tokens; i++)
+      size += tokens[first + i].length;
+    return size;
+  }
+
+  static int savings (unsigned int count, unsigned int size)
+  {
+    unsigned int saved = size > CALL_SIZE ? size - CALL_SIZE : 0;
+    return (int) (count * saved) - (int) (size + SUBR_OVERHEAD);
+  }
+
+  static int cmp_token (const void *pa, const void *pb, void *arg)
+  {
+    const cff_subroutinizer_t *c = (const cff_subroutinizer_t *) arg;
+    unsigned int a = * (const unsigned int *) pa;
+    unsigned int b = * (const unsigned int *) pb;
+    const token_t &ta = c->tokens[a];
+    const token_t &tb = c->tokens[b];
+    if (ta.length != tb.length) return ta.length < tb.length ? -1 : 1;
+    int r = memcmp (c->token_bytes (ta), c->token_bytes (tb), ta.length);
+    if (r) return r;
+    return a < b ? -1 : a > b ? 1 : 0;
+  }
+
+  static int cmp_run (const void *pa, const void *pb, void *arg)
+  {
+    const cff_subroutinizer_t *c = (const cff_subroutinizer_t *) arg;
+    unsigned int a = * (const unsigned int *) pa;
+    unsigned int b = * (const unsigned int *) pb;
+    for (unsigned int i = 0; i < c->num_tokens; i++)
+      if (c->tokens[a + i].id != c->tokens[b + i].id)
+	return c->tokens[a + i].id < c->tokens[b + i].id ? -1 : 1;
+    return a < b ? -1 : a > b ? 1 : 0;
+  }
+
+  bool collect_tokens (const hb_vector_t<cs_token_vec_t> &ops)
+  {
+    for (unsigned int g = 0; g < charstrings.length; g++)
+    {
+      const cs_token_vec_t &glyph_ops = ops[g];
+      /* Only charstrings made up of their recorded operators entirely
+       * can be rewritten. */
+      if (!glyph_ops.length || glyph_ops.tail ().end != charstrings[g].length)
+	continue;
+      unsigned int start = 0;
+      for (unsigned int i = 0; i < glyph_ops.length; i++)
+      {
+	token_t *t = tokens.push ();
+	t->glyph = g;
+	t->start = start;
+	t->length = glyph_ops[i].end - start;
+	t->id = i && t->length && is_path_op (glyph_ops[i].op) ? 0 : NOT_MOVABLE;
+	t->run = 0;
+	start = glyph_ops[i].end;
+      }
+    }
+    if (unlikely (tokens.in_error ())) return false;
+
+    /* Number identical movable tokens alike. */
+    hb_vector_t<unsigned int> order;
+    for (unsigned int i = 0; i < tokens.length; i++)
+      if (tokens[i].id != NOT_MOVABLE)
+	order.push (i);
+    if (unlikely (order.in_error ())) return false;
+    hb_qsort (order.arrayZ, order.length, sizeof (order[0]), cmp_token, this);
+    unsigned int id = 0;
+    for (unsigned int i = 0; i < order.length; i++)
+    {
+      if (i)
+      {
+	const token_t &prev = tokens[order[i - 1]];
+	const token_t &cur = tokens[order[i]];
+	if (prev.length != cur.length ||
+	    memcmp (token_bytes (prev), token_bytes (cur), cur.length))
+	  id++;
+      }
+      tokens[order[i]].id = id;
+    }
+
+    for (unsigned int i = tokens.length; i; i--)
+    {
+      token_t &t = tokens[i - 1];
+      if (t.id == NOT_MOVABLE) continue;
+      bool same_glyph = i < tokens.length && tokens[i].glyph == t.glyph;
+      t.run = same_glyph ? tokens[i].run + 1 : 1;
+    }
+    return true;
+  }
+
+  /* Every run of up to HB_CFF_SUBR_MAX_TOKENS movable tokens that occurs
+   * often enough to be worth a subroutine. */
+  bool collect_candidates ()
+  {
+    hb_vector_t<unsigned int> starts;
+    for (num_tokens = 1; num_tokens <= HB_CFF_SUBR_MAX_TOKENS; num_tokens++)
+    {
+      starts.resize (0);
+      for (unsigned int i = 0; i < tokens.length; i++)
+	if (tokens[i].run >= num_tokens)
+	  starts.push (i);
+      if (unlikely (starts.in_error ())) return false;
+      hb_qsort (starts.arrayZ, starts.length, sizeof (starts[0]), cmp_run, this);
+
+      /* A run that doesn't repeat can't be part of a longer one that does. */
+      bool repeats = false;
+      for (unsigned int i = 0; i < starts.length;)
+      {
+	unsigned int j = i + 1;
+	while (j < starts.length && same_run (starts[i], starts[j]))
+	  j++;
+	unsigned int count = j - i;
+	if (count > 1)
+	{
+	  repeats = true;
+	  int s = savings (count, run_size (starts[i], num_tokens));
+	  if (s > 0)
+	  {
+	    candidate_t *c = candidates.push ();
+	    c->first = occurrences.length;
+	    c->count = count;
+	    c->num_tokens = num_tokens;
+	    c->savings = s;
+	    for (unsigned int k = i; k < j; k++)
+	      occurrences.push (starts[k]);
+	  }
+	}
+	i = j;
+      }
+      if (!repeats) break;
+    }
+    return !candidates.in_error () && !occurrences.in_error ();
+  }
+
+  bool same_run (unsigned int a, unsigned int b) const
+  {
+    for (unsigned int i = 0; i < num_tokens; i++)
+      if (tokens[a + i].id != tokens[b + i].id)
+	return false;
+    return true;
+  }
+
+  /* Turns candidates into subroutines, most savings first, as long as
+   * enough of their runs are still free. */
+  bool choose_subrs ()
+  {
+    candidates.qsort (candidate_t::cmp);
+    if (unlikely (!claims.resize (tokens.length))) return false;
+    for (unsigned int i = 0; i < claims.length; i++)
+      claims[i] = UNCLAIMED;
+
+    for (unsigned int c = 0; c < candidates.length && subrs.length < CFF_MAX_SUBRS; c++)
+    {
+      const candidate_t &candidate = candidates[c];
+      num_tokens = candidate.num_tokens;
+      hb_array_t<const unsigned int> runs = occurrences.as_array ().sub_array (candidate.first, candidate.count);
+
+      unsigned int count = 0;
+      unsigned int next_free = 0;
+      for (unsigned int start : runs)
+	if (start >= next_free && is_free (start))
+	{
+	  count++;
+	  next_free = start + num_tokens;
+	}
+      if (count < 2 || savings (count, run_size (runs[0], num_tokens)) <= 0)
+	continue;
+
+      unsigned int subr = subrs.length;
+      subr_t *s = subrs.push ();
+      if (unlikely (subrs.in_error ())) return false;
+      s->token = HB_SET_VALUE_INVALID;
+      s->num_tokens = num_tokens;
+      s->uses = count;
+      next_free = 0;
+      for (unsigned int start : runs)
+	if (start >= next_free && is_free (start))
+	{
+	  if (s->token == HB_SET_VALUE_INVALID) s->token = start;
+	  claims[start] = subr;
+	  for (unsigned int i = 1; i < num_tokens; i++)
+	    claims[start + i] = COVERED;
+	  next_free = start + num_tokens;
+	}
+    }
+    return true;
+  }
+
+  bool is_free (unsigned int start) const
+  {
+    for (unsigned int i = 0; i < num_tokens; i++)
+      if (claims[start + i] != UNCLAIMED)
+	return false;
+    return true;
+  }
+
+  /* Most used subroutines get the numbers that encode shortest. */
+  static unsigned int subr_index (unsigned int rank, unsigned int count)
+  {
+    if (count < 1240 || count >= 33900) return rank; /* Bias 107 or 32768. */
+    /* Bias 1131: indices 1024..1238 are one byte away from it. */
+    if (rank < 215) return 1024 + rank;
+    if (rank < 1239) return rank - 215;
+    return rank;
+  }
+
+  static unsigned int subr_bias (unsigned int count)
+  { return count < 1240 ? 107 : count < 33900 ? 1131 : 32768; }
+
+  static int cmp_uses (const void *pa, const void *pb, void *arg)
+  {
+    const subr_t *subrs = (const subr_t *) arg;
+    unsigned int a = * (const unsigned int *) pa;
+    unsigned int b = * (const unsigned int *) pb;
+    if (subrs[a].uses != subrs[b].uses) return subrs[a].uses > subrs[b].uses ? -1 : 1;
+    return a < b ? -1 : a > b ? 1 : 0;
+  }
+
+  bool encode (str_buff_vec_t &subr_strs)
+  {
+    unsigned int count = subrs.length;
+    hb_vector_t<unsigned int> by_uses;
+    hb_vector_t<unsigned int> indices;
+    if (unlikely (!by_uses.resize (count) || !indices.resize (count) ||
+		  !subr_strs.resize (count)))
+      return false;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      by_uses[i] = i;
+      subr_strs[i].init ();
+    }
+    hb_qsort (by_uses.arrayZ, count, sizeof (by_uses[0]), cmp_uses, subrs.arrayZ);
+    for (unsigned int rank = 0; rank < count; rank++)
+      indices[by_uses[rank]] = subr_index (rank, count);
+    int bias = subr_bias (count);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+      const subr_t &subr = subrs[i];
+      str_encoder_t encoder (subr_strs[indices[i]]);
+      const token_t &first = tokens[subr.token];
+      encoder.copy_str (byte_str_t (token_bytes (first), run_size (subr.token, subr.num_tokens)));
+      if (!is_cff2)
+	encoder.encode_op (OpCode_return);
+      if (unlikely (encoder.is_error ())) return false;
+    }
+
+    for (unsigned int i = 0; i < tokens.length;)
+    {
+      unsigned int glyph = tokens[i].glyph;
+      unsigned int end = i;
+      bool calls = false;
+      for (; end < tokens.length && tokens[end].glyph == glyph; end++)
+	calls = calls || claims[end] != UNCLAIMED;
+      if (!calls)
+      {
+	i = end;
+	continue;
+      }
+
+      str_buff_t buff;
+      str_encoder_t encoder (buff);
+      for (; i < end; i++)
+      {
+	unsigned int claim = claims[i];
+	if (claim == COVERED) continue;
+	if (claim == UNCLAIMED)
+	{
+	  encoder.copy_str (byte_str_t (token_bytes (tokens[i]), tokens[i].length));
+	  continue;
+	}
+	encoder.encode_int ((int) indices[claim] - bias);
+	encoder.encode_op (OpCode_callgsubr);
+      }
+      if (unlikely (encoder.is_error ())) return false;
+      charstrings[glyph] = hb_move (buff);
+    }
+    return true;
+  }
+
+  str_buff_vec_t &charstrings;
+  bool is_cff2;
+
+  hb_vector_t<token_t> tokens;
+  hb_vector_t<candidate_t> candidates;
+  hb_vector_t<unsigned int> occurrences;
+  hb_vector_t<unsigned int> claims;	/* Subroutine each token starts, if any. */
+  hb_vector_t<subr_t> subrs;
+  unsigned int num_tokens;	/* Run length cmp_run () and is_free () look at. */
+};
+
+/**
+ * hb_subroutinize_cff_charstrings
+ * Move runs of operators that repeat across flattened charstrings into
+ * new global subroutines.  tokens has the operators of each charstring,
+ * as recorded by subr_flattener_t.
+ **/
+bool
+hb_subroutinize_cff_charstrings (str_buff_vec_t &charstrings /* IN/OUT */,
+				 const hb_vector_t<cs_token_vec_t> &tokens,
+				 bool is_cff2,
+				 str_buff_vec_t &subrs /* OUT */)
+{
+  if (unlikely (tokens.length != charstrings.length)) return false;
+  cff_subroutinizer_t c (charstrings, is_cff2);
+  return c.collect_tokens (tokens) &&
+	 c.collect_candidates () &&
+	 c.choose_subrs () &&
+	 c.encode (subrs);
+}
+
+
 #endif
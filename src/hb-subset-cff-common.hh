@@ -44,7 +44,8 @@ struct str_encoder_t
 
   void encode_byte (unsigned char b)
   {
-    if (unlikely (buff.push (b) == &Crap (unsigned char)))
+    buff.push (b);
+    if (unlikely (buff.in_error ()))
       set_error ();
   }
 
@@ -225,12 +226,41 @@ struct cff_private_dict_op_serializer_t : op_serializer_t
   const bool  drop_hints;
 };
 
+/* Where an operator, along with its operands, ends in a flattened
+ * charstring. */
+struct cs_token_t
+{
+  unsigned int end;
+  op_code_t op;
+};
+typedef hb_vector_t<cs_token_t> cs_token_vec_t;
+
 struct flatten_param_t
 {
+  void end_op (op_code_t op)
+  {
+    if (!tokens) return;
+    cs_token_t *token = tokens->push ();
+    token->end = flatStr.length;
+    token->op = op;
+  }
+
+  /* Hintmask bytes belong to the operator just flushed. */
+  void extend_op ()
+  {
+    if (tokens && tokens->length)
+      tokens->tail ().end = flatStr.length;
+  }
+
   str_buff_t     &flatStr;
   bool	drop_hints;
+  cs_token_vec_t *tokens;
 };
 
+#ifndef HB_CFF_FLATTEN_GLYPHS_PER_TASK
+#define HB_CFF_FLATTEN_GLYPHS_PER_TASK 64
+#endif
+
 template <typename ACC, typename ENV, typename OPSET, op_code_t endchar_op=OpCode_Invalid>
 struct subr_flattener_t
 {
@@ -238,34 +268,126 @@ struct subr_flattener_t
 		    const hb_subset_plan_t *plan_)
 		   : acc (acc_), plan (plan_) {}
 
-  bool flatten (str_buff_vec_t &flat_charstrings)
+  /* If tokens is not null, it is filled with the operators of each
+   * flattened charstring, for hb_subroutinize_cff_charstrings(). */
+  bool flatten (str_buff_vec_t &flat_charstrings,
+		hb_vector_t<cs_token_vec_t> *tokens = nullptr)
   {
-    if (!flat_charstrings.resize (plan->num_output_glyphs ()))
+    unsigned int num_glyphs = plan->num_output_glyphs ();
+    if (!flat_charstrings.resize (num_glyphs))
       return false;
-    for (unsigned int i = 0; i < plan->num_output_glyphs (); i++)
+    for (unsigned int i = 0; i < num_glyphs; i++)
       flat_charstrings[i].init ();
-    for (unsigned int i = 0; i < plan->num_output_glyphs (); i++)
+    if (tokens)
     {
-      hb_codepoint_t  glyph;
-      if (!plan->old_gid_for_new_gid (i, &glyph))
-      {
-	/* add an endchar only charstring for a missing glyph if CFF1 */
-	if (endchar_op != OpCode_Invalid) flat_charstrings[i].push (endchar_op);
-	continue;
-      }
-      const byte_str_t str = (*acc.charStrings)[glyph];
-      unsigned int fd = acc.fdSelect->get_fd (glyph);
-      if (unlikely (fd >= acc.fdCount))
-	return false;
-      cs_interpreter_t<ENV, OPSET, flatten_param_t> interp;
-      interp.env.init (str, acc, fd);
-      flatten_param_t  param = { flat_charstrings[i], plan->drop_hints };
-      if (unlikely (!interp.interpret (param)))
+      if (!tokens->resize (num_glyphs))
 	return false;
+      for (unsigned int i = 0; i < num_glyphs; i++)
+	(*tokens)[i].init ();
     }
+
+#ifdef HB_SUBSET_THREADS
+    if (plan->num_threads > 1 && num_glyphs > HB_CFF_FLATTEN_GLYPHS_PER_TASK)
+      return flatten_parallel (flat_charstrings, tokens);
+#endif
+    for (unsigned int i = 0; i < num_glyphs; i++)
+      if (unlikely (!flatten_glyph (i, flat_charstrings[i], tokens ? &(*tokens)[i] : nullptr)))
+	return false;
     return true;
   }
 
+  /* Glyphs are independent of each other; this only reads the font and
+   * the plan. */
+  bool flatten_glyph (unsigned int new_gid, str_buff_t &flatStr, cs_token_vec_t *tokens) const
+  {
+    flatten_param_t  param = { flatStr, plan->drop_hints, tokens };
+    hb_codepoint_t  glyph;
+    if (!plan->old_gid_for_new_gid (new_gid, &glyph))
+    {
+      /* add an endchar only charstring for a missing glyph if CFF1 */
+      if (endchar_op != OpCode_Invalid)
+      {
+	flatStr.push (endchar_op);
+	param.end_op (endchar_op);
+      }
+      return true;
+    }
+    const byte_str_t str = (*acc.charStrings)[glyph];
+    unsigned int fd = acc.fdSelect->get_fd (glyph);
+    if (unlikely (fd >= acc.fdCount))
+      return false;
+    cs_interpreter_t<ENV, OPSET, flatten_param_t> interp;
+    interp.env.init (str, acc, fd);
+    return interp.interpret (param);
+  }
+
+#ifdef HB_SUBSET_THREADS
+  /* Glyphs are handed out to threads in runs of
+   * HB_CFF_FLATTEN_GLYPHS_PER_TASK. */
+  struct flatten_tasks_t
+  {
+    void run ()
+    {
+      for (;;)
+      {
+	unsigned int start = next.inc () * HB_CFF_FLATTEN_GLYPHS_PER_TASK;
+	if (start >= charstrings->length || failed.get_relaxed ()) return;
+	unsigned int end = hb_min (start + HB_CFF_FLATTEN_GLYPHS_PER_TASK, charstrings->length);
+	for (unsigned int i = start; i < end; i++)
+	  if (unlikely (!flattener->flatten_glyph (i, (*charstrings)[i], tokens ? &(*tokens)[i] : nullptr)))
+	  {
+	    failed.set_relaxed (1);
+	    return;
+	  }
+      }
+    }
+
+    static void *worker (void *data)
+    {
+      ((flatten_tasks_t *) data)->run ();
+      return nullptr;
+    }
+
+    const subr_flattener_t *flattener;
+    str_buff_vec_t *charstrings;
+    hb_vector_t<cs_token_vec_t> *tokens;
+    hb_atomic_int_t next;
+    hb_atomic_int_t failed;
+  };
+
+  bool flatten_parallel (str_buff_vec_t &flat_charstrings,
+			 hb_vector_t<cs_token_vec_t> *tokens) const
+  {
+    flatten_tasks_t shared;
+    shared.flattener = this;
+    shared.charstrings = &flat_charstrings;
+    shared.tokens = tokens;
+    shared.next.set_relaxed (0);
+    shared.failed.set_relaxed (0);
+
+    unsigned int num_tasks = (flat_charstrings.length + HB_CFF_FLATTEN_GLYPHS_PER_TASK - 1) / HB_CFF_FLATTEN_GLYPHS_PER_TASK;
+    unsigned int num_workers = hb_min (plan->num_threads, num_tasks) - 1;
+    hb_vector_t<pthread_t> threads;
+    for (unsigned int i = 0; i < num_workers; i++)
+    {
+      pthread_t thread;
+      if (pthread_create (&thread, nullptr, flatten_tasks_t::worker, &shared))
+	break; /* Carry on with the threads we have. */
+      threads.push (thread);
+      if (unlikely (threads.in_error ()))
+      {
+	pthread_join (thread, nullptr);
+	break;
+      }
+    }
+    shared.run ();
+    for (unsigned int i = 0; i < threads.length; i++)
+      pthread_join (threads[i], nullptr);
+
+    return !shared.failed.get_relaxed ();
+  }
+#endif
+
   const ACC &acc;
   const hb_subset_plan_t *plan;
 };
@@ -965,6 +1087,35 @@ struct subr_subsetter_t
   typedef typename SUBRS::count_type subr_count_type;
 };
 
+/* Upper bound on the size of an INDEX holding @strs. */
+static inline unsigned
+str_index_size_bound (const str_buff_vec_t &strs)
+{ return HBUINT32::static_size + 1 + (strs.length + 1) * 4 + strs.total_size (); }
+
+/* Upper bound on the size of a serialized CFF / CFF2 subset.  Everything
+ * besides the charstrings and subroutines comes out no larger than in the
+ * source, except for offsets re-encoded at full width and a charset /
+ * FDSelect that may end up in a less compact format. */
+template <typename ACC, typename PLAN>
+static inline unsigned
+subset_size_bound (unsigned table_size, const ACC &acc, const PLAN &plan, unsigned num_glyphs)
+{
+  int64_t source_size = table_size;
+  source_size -= acc.charStrings->get_size ();
+  source_size -= acc.globalSubrs->get_size ();
+  for (unsigned i = 0; i < acc.privateDicts.length; i++)
+    source_size -= acc.privateDicts[i].localSubrs->get_size ();
+
+  uint64_t size = hb_max (source_size, (int64_t) 0);
+  size += str_index_size_bound (plan.subset_charstrings);
+  size += str_index_size_bound (plan.subset_globalsubrs);
+  for (unsigned i = 0; i < plan.subset_localsubrs.length; i++)
+    size += str_index_size_bound (plan.subset_localsubrs[i]);
+  size += 3 * (uint64_t) num_glyphs + 1024;
+
+  return hb_min (size, (uint64_t) UINT_MAX);
+}
+
 } /* namespace CFF */
 
 HB_INTERNAL bool
@@ -977,6 +1128,12 @@ hb_plan_subset_cff_fdselect (const hb_subset_plan_t *plan,
 			    hb_vector_t<CFF::code_pair_t> &fdselect_ranges /* OUT */,
 			    hb_inc_bimap_t &fdmap /* OUT */);
 
+HB_INTERNAL bool
+hb_subroutinize_cff_charstrings (CFF::str_buff_vec_t &charstrings /* IN/OUT */,
+				 const hb_vector_t<CFF::cs_token_vec_t> &tokens,
+				 bool is_cff2,
+				 CFF::str_buff_vec_t &subrs /* OUT */);
+
 HB_INTERNAL bool
 hb_serialize_cff_fdselect (hb_serialize_context_t *c,
 			  unsigned int num_glyphs,
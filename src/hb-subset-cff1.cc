@@ -241,6 +241,7 @@ struct cff1_cs_opset_flatten_t : cff1_cs_opset_t<cff1_cs_opset_flatten_t, flatte
   {
     str_encoder_t  encoder (param.flatStr);
     encoder.encode_op (op);
+    param.end_op (op);
   }
 
   static void flush_width (cff1_cs_interp_env_t &env, flatten_param_t& param)
@@ -258,6 +259,7 @@ struct cff1_cs_opset_flatten_t : cff1_cs_opset_t<cff1_cs_opset_flatten_t, flatte
       str_encoder_t  encoder (param.flatStr);
       for (unsigned int i = 0; i < env.hintmask_size; i++)
 	encoder.encode_byte (env.str_ref[i]);
+      param.extend_op ();
     }
   }
 
@@ -546,7 +548,7 @@ struct cff_subset_plan {
     num_glyphs = plan->num_output_glyphs ();
     orig_fdcount = acc.fdCount;
     drop_hints = plan->drop_hints;
-    desubroutinize = plan->desubroutinize;
+    desubroutinize = plan->desubroutinize || plan->resubroutinize;
 
     /* check whether the subset renumbers any glyph IDs */
     gid_renum = false;
@@ -612,7 +614,14 @@ struct cff_subset_plan {
       /* Flatten global & local subrs */
       subr_flattener_t<const OT::cff1::accelerator_subset_t, cff1_cs_interp_env_t, cff1_cs_opset_flatten_t, OpCode_endchar>
 		    flattener(acc, plan);
-      if (!flattener.flatten (subset_charstrings))
+      hb_vector_t<cs_token_vec_t> tokens;
+      bool ret = flattener.flatten (subset_charstrings, plan->resubroutinize ? &tokens : nullptr);
+
+      /* Extract new global subrs from the flattened charstrings */
+      if (ret && plan->resubroutinize)
+	ret = hb_subroutinize_cff_charstrings (subset_charstrings, tokens, false, subset_globalsubrs);
+      tokens.fini_deep ();
+      if (!ret)
 	return false;
     }
     else
@@ -916,6 +925,9 @@ _hb_subset_cff1 (const OT::cff1::accelerator_subset_t  &acc,
     return false;
   }
 
+  if (unlikely (!c->ensure_room (subset_size_bound (c->source_blob->length, acc, cff_plan, c->plan->num_output_glyphs ()))))
+    return false;
+
   return _serialize_cff1 (c->serializer, cff_plan, acc, c->plan->num_output_glyphs ());
 }
 
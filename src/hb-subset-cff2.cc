@@ -159,6 +159,7 @@ struct cff2_cs_opset_flatten_t : cff2_cs_opset_t<cff2_cs_opset_flatten_t, flatte
       default:
 	str_encoder_t  encoder (param.flatStr);
 	encoder.encode_op (op);
+	param.end_op (op);
     }
   }
 
@@ -263,14 +264,21 @@ struct cff2_subset_plan {
     orig_fdcount = acc.fdArray->count;
 
     drop_hints = plan->drop_hints;
-    desubroutinize = plan->desubroutinize;
+    desubroutinize = plan->desubroutinize || plan->resubroutinize;
 
     if (desubroutinize)
     {
       /* Flatten global & local subrs */
       subr_flattener_t<const OT::cff2::accelerator_subset_t, cff2_cs_interp_env_t, cff2_cs_opset_flatten_t>
 		    flattener(acc, plan);
-      if (!flattener.flatten (subset_charstrings))
+      hb_vector_t<cs_token_vec_t> tokens;
+      bool ret = flattener.flatten (subset_charstrings, plan->resubroutinize ? &tokens : nullptr);
+
+      /* Extract new global subrs from the flattened charstrings */
+      if (ret && plan->resubroutinize)
+	ret = hb_subroutinize_cff_charstrings (subset_charstrings, tokens, true, subset_globalsubrs);
+      tokens.fini_deep ();
+      if (!ret)
 	return false;
     }
     else
@@ -467,6 +475,8 @@ _hb_subset_cff2 (const OT::cff2::accelerator_subset_t  &acc,
   cff2_subset_plan cff2_plan;
 
   if (unlikely (!cff2_plan.create (acc, c->plan))) return false;
+  if (unlikely (!c->ensure_room (subset_size_bound (c->source_blob->length, acc, cff2_plan, c->plan->num_output_glyphs ()))))
+    return false;
   return _serialize_cff2 (c->serializer, cff2_plan, acc, c->plan->num_output_glyphs ());
 }
 
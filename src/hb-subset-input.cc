@@ -51,8 +51,16 @@ hb_subset_input_create_or_fail ()
   input->drop_tables = hb_set_create ();
   input->drop_hints = false;
   input->desubroutinize = false;
+  input->resubroutinize = false;
   input->retain_gids = false;
   input->name_legacy = false;
+  input->num_threads = 1;
+  input->dedup_budget = (unsigned int) -1;
+  input->memory_limit = (unsigned int) -1;
+  input->op_budget = (unsigned int) -1;
+  input->progress_func = nullptr;
+  input->progress_data = nullptr;
+  input->progress_destroy = nullptr;
 
   hb_tag_t default_drop_tables[] = {
     // Layout disabled by default
@@ -120,6 +128,9 @@ hb_subset_input_destroy (hb_subset_input_t *subset_input)
   hb_set_destroy (subset_input->name_languages);
   hb_set_destroy (subset_input->drop_tables);
 
+  if (subset_input->progress_destroy)
+    subset_input->progress_destroy (subset_input->progress_data);
+
   free (subset_input);
 }
 
@@ -191,6 +202,37 @@ hb_subset_input_get_desubroutinize (hb_subset_input_t *subset_input)
   return subset_input->desubroutinize;
 }
 
+/**
+ * hb_subset_input_set_resubroutinize:
+ * @subset_input: a subset_input.
+ * @resubroutinize: If true CFF/CFF2 charstrings are desubroutinized,
+ * then sequences of operators shared by the retained glyphs are moved
+ * into new global subroutines.
+ *
+ * This keeps subsets compact without carrying along the source font's
+ * subroutines for glyphs that were dropped.  Hints are never moved into
+ * subroutines.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_resubroutinize (hb_subset_input_t *subset_input,
+				    hb_bool_t resubroutinize)
+{
+  subset_input->resubroutinize = resubroutinize;
+}
+
+/**
+ * hb_subset_input_get_resubroutinize:
+ * Returns: value of resubroutinize.
+ * Since: REPLACEME
+ **/
+HB_EXTERN hb_bool_t
+hb_subset_input_get_resubroutinize (hb_subset_input_t *subset_input)
+{
+  return subset_input->resubroutinize;
+}
+
 /**
  * hb_subset_input_set_retain_gids:
  * @subset_input: a subset_input.
@@ -227,3 +269,159 @@ hb_subset_input_get_name_legacy (hb_subset_input_t *subset_input)
 {
   return subset_input->name_legacy;
 }
+
+/**
+ * hb_subset_input_set_num_threads:
+ * @subset_input: a subset_input.
+ * @num_threads: maximum number of threads to subset tables with.
+ *
+ * Lets hb_subset() subset independent tables concurrently, on up to
+ * @num_threads threads including the calling one; CFF/CFF2 charstrings
+ * are also desubroutinized on that many threads.  The result is the
+ * same as subsetting them one after another.  Values of 0 and 1, the
+ * default, subset on the calling thread only, as do builds without
+ * thread support.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_num_threads (hb_subset_input_t *subset_input,
+				 unsigned int num_threads)
+{
+  subset_input->num_threads = num_threads;
+}
+
+/**
+ * hb_subset_input_get_num_threads:
+ * Returns: value of num_threads.
+ * Since: REPLACEME
+ **/
+HB_EXTERN unsigned int
+hb_subset_input_get_num_threads (hb_subset_input_t *subset_input)
+{
+  return subset_input->num_threads;
+}
+
+/**
+ * hb_subset_input_set_dedup_budget:
+ * @subset_input: a subset_input.
+ * @dedup_budget: bytes per table to search for duplicate subtables.
+ *
+ * Identical subtables in a subset table are normally stored only once,
+ * which takes hashing and comparing every subtable written.  This caps
+ * the bytes of each table that are searched that way; subtables written
+ * after the budget is used up are not shared.  Lower budgets subset
+ * faster but may produce larger fonts.  0 turns deduplication off; the
+ * default is unlimited.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_dedup_budget (hb_subset_input_t *subset_input,
+				  unsigned int dedup_budget)
+{
+  subset_input->dedup_budget = dedup_budget;
+}
+
+/**
+ * hb_subset_input_get_dedup_budget:
+ * Returns: value of dedup_budget.
+ * Since: REPLACEME
+ **/
+HB_EXTERN unsigned int
+hb_subset_input_get_dedup_budget (hb_subset_input_t *subset_input)
+{
+  return subset_input->dedup_budget;
+}
+
+/**
+ * hb_subset_input_set_memory_limit:
+ * @subset_input: a subset_input.
+ * @memory_limit: bytes the subset may hold.
+ *
+ * Limits the memory a subset holds: the glyph closure, the buffers
+ * subset tables are serialized into, the serializer's bookkeeping of the
+ * objects it packs, the graph repacking works on, and the finished
+ * tables held until the subset is done.  A subset that would go over the
+ * limit fails, returning the empty face.  The closure is measured once
+ * it is computed; the rest is accounted for before it is allocated.
+ * Other, smaller, working memory is not counted.  The default is
+ * unlimited.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_memory_limit (hb_subset_input_t *subset_input,
+				  unsigned int memory_limit)
+{
+  subset_input->memory_limit = memory_limit;
+}
+
+/**
+ * hb_subset_input_get_memory_limit:
+ * Returns: value of memory_limit.
+ * Since: REPLACEME
+ **/
+HB_EXTERN unsigned int
+hb_subset_input_get_memory_limit (hb_subset_input_t *subset_input)
+{
+  return subset_input->memory_limit;
+}
+
+/**
+ * hb_subset_input_set_op_budget:
+ * @subset_input: a subset_input.
+ * @op_budget: glyph closure work allowed.
+ *
+ * Caps the work done closing the requested glyphs over GSUB: every
+ * glyph each lookup is applied to counts as one op.  A subset that uses
+ * up the budget fails, returning the empty face.  The default is
+ * unlimited.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_op_budget (hb_subset_input_t *subset_input,
+			       unsigned int op_budget)
+{
+  subset_input->op_budget = op_budget;
+}
+
+/**
+ * hb_subset_input_get_op_budget:
+ * Returns: value of op_budget.
+ * Since: REPLACEME
+ **/
+HB_EXTERN unsigned int
+hb_subset_input_get_op_budget (hb_subset_input_t *subset_input)
+{
+  return subset_input->op_budget;
+}
+
+/**
+ * hb_subset_input_set_progress_func:
+ * @subset_input: a subset_input.
+ * @func: (closure user_data) (destroy destroy) (scope notified): the
+ * callback, or %NULL.
+ * @user_data: data to pass to @func.
+ * @destroy: function to call when @user_data is not needed anymore.
+ *
+ * Sets a callback that is told how subsetting progresses, and can cancel
+ * it; see #hb_subset_progress_func_t.  A cancelled subset returns the
+ * empty face.  This can be used to enforce a deadline.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_progress_func (hb_subset_input_t         *subset_input,
+				   hb_subset_progress_func_t  func,
+				   void                      *user_data,
+				   hb_destroy_func_t          destroy)
+{
+  if (subset_input->progress_destroy)
+    subset_input->progress_destroy (subset_input->progress_data);
+
+  subset_input->progress_func = func;
+  subset_input->progress_data = user_data;
+  subset_input->progress_destroy = destroy;
+}
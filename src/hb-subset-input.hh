@@ -46,8 +46,18 @@ struct hb_subset_input_t
 
   bool drop_hints;
   bool desubroutinize;
+  bool resubroutinize;
   bool retain_gids;
   bool name_legacy;
+  unsigned int num_threads;
+  unsigned int dedup_budget;
+  unsigned int memory_limit;
+  unsigned int op_budget;
+
+  hb_subset_progress_func_t progress_func;
+  void *progress_data;
+  hb_destroy_func_t progress_destroy;
+
   /* TODO
    *
    * features
@@ -25,16 +25,10 @@
  */
 
 #include "hb-subset-plan.hh"
+#include "hb-subset-accelerator.hh"
 #include "hb-map.hh"
 #include "hb-set.hh"
 
-#include "hb-ot-cmap-table.hh"
-#include "hb-ot-glyf-table.hh"
-#include "hb-ot-layout-gdef-table.hh"
-#include "hb-ot-layout-gpos-table.hh"
-#include "hb-ot-layout-gsub-table.hh"
-#include "hb-ot-cff1-table.hh"
-#include "hb-ot-color-colr-table.hh"
 #include "hb-ot-var-fvar-table.hh"
 #include "hb-ot-stat-table.hh"
 
@@ -66,103 +60,80 @@ _remap_indexes (const hb_set_t *indexes,
 
 }
 
-static inline void
-_gsub_closure_glyphs_lookups_features (hb_face_t *face,
+static bool
+_closure_keep_going (unsigned int ops, void *user_data)
+{
+  hb_subset_plan_t *plan = (hb_subset_plan_t *) user_data;
+  return plan->consume_ops (ops) && plan->progress (HB_OT_TAG_GSUB);
+}
+
+static inline bool
+_gsub_closure_glyphs_lookups_features (hb_subset_plan_t *plan,
+				       const hb_subset_accelerator_t *accel,
 				       hb_set_t *gids_to_retain,
 				       hb_map_t *gsub_lookups,
 				       hb_map_t *gsub_features)
 {
   hb_set_t lookup_indices;
-  hb_ot_layout_collect_lookups (face,
-				HB_OT_TAG_GSUB,
-				nullptr,
-				nullptr,
-				nullptr,
-				&lookup_indices);
-  hb_ot_layout_lookups_substitute_closure (face,
-					   &lookup_indices,
-					   gids_to_retain);
-  hb_blob_ptr_t<OT::GSUB> gsub = hb_sanitize_context_t ().reference_table<OT::GSUB> (face);
-  gsub->closure_lookups (face,
-			 gids_to_retain,
-			 &lookup_indices);
+  if (!accel->gsub_closure (plan->source, gids_to_retain, &lookup_indices,
+			    _closure_keep_going, plan))
+  {
+    DEBUG_MSG (SUBSET, nullptr, "GSUB closure stopped: out of ops or cancelled.");
+    return false;
+  }
   _remap_indexes (&lookup_indices, gsub_lookups);
 
   //closure features
   hb_set_t feature_indices;
-  gsub->closure_features (gsub_lookups, &feature_indices);
+  accel->gsub->closure_features (gsub_lookups, &feature_indices);
   _remap_indexes (&feature_indices, gsub_features);
-  gsub.destroy ();
+  return true;
 }
 
 static inline void
 _gpos_closure_lookups_features (hb_face_t      *face,
+				const hb_subset_accelerator_t *accel,
 				const hb_set_t *gids_to_retain,
 				hb_map_t       *gpos_lookups,
 				hb_map_t       *gpos_features)
 {
   hb_set_t lookup_indices;
-  hb_ot_layout_collect_lookups (face,
-				HB_OT_TAG_GPOS,
-				nullptr,
-				nullptr,
-				nullptr,
+  lookup_indices.set (&accel->gpos_lookups);
+  accel->gpos->closure_lookups (face,
+				gids_to_retain,
 				&lookup_indices);
-  hb_blob_ptr_t<OT::GPOS> gpos = hb_sanitize_context_t ().reference_table<OT::GPOS> (face);
-  gpos->closure_lookups (face,
-			 gids_to_retain,
-			 &lookup_indices);
   _remap_indexes (&lookup_indices, gpos_lookups);
 
   //closure features
   hb_set_t feature_indices;
-  gpos->closure_features (gpos_lookups, &feature_indices);
+  accel->gpos->closure_features (gpos_lookups, &feature_indices);
   _remap_indexes (&feature_indices, gpos_features);
-  gpos.destroy ();
 }
 #endif
 
 #ifndef HB_NO_VAR
 static inline void
   _collect_layout_variation_indices (hb_face_t *face,
+				     const hb_subset_accelerator_t *accel,
 				     const hb_set_t *glyphset,
 				     const hb_map_t *gpos_lookups,
 				     hb_set_t  *layout_variation_indices,
 				     hb_map_t  *layout_variation_idx_map)
 {
-  hb_blob_ptr_t<OT::GDEF> gdef = hb_sanitize_context_t ().reference_table<OT::GDEF> (face);
-  hb_blob_ptr_t<OT::GPOS> gpos = hb_sanitize_context_t ().reference_table<OT::GPOS> (face);
-
-  if (!gdef->has_data ())
-  {
-    gdef.destroy ();
-    gpos.destroy ();
+  const OT::GDEF &gdef = *accel->gdef;
+  if (!gdef.has_data ())
     return;
-  }
+
   OT::hb_collect_variation_indices_context_t c (layout_variation_indices, glyphset, gpos_lookups);
-  gdef->collect_variation_indices (&c);
+  gdef.collect_variation_indices (&c);
 
   if (hb_ot_layout_has_positioning (face))
-    gpos->collect_variation_indices (&c);
-
-  gdef->remap_layout_variation_indices (layout_variation_indices, layout_variation_idx_map);
+    accel->gpos->collect_variation_indices (&c);
 
-  gdef.destroy ();
-  gpos.destroy ();
+  gdef.remap_layout_variation_indices (layout_variation_indices, layout_variation_idx_map);
 }
 #endif
 
-static inline void
-_cmap_closure (hb_face_t           *face,
-	       const hb_set_t      *unicodes,
-	       hb_set_t            *glyphset)
-{
-  OT::cmap::accelerator_t cmap;
-  cmap.init (face);
-  cmap.table->closure_glyphs (unicodes, glyphset);
-  cmap.fini ();
-}
-
 static inline void
 _remove_invalid_gids (hb_set_t *glyphs,
 		      unsigned int num_glyphs)
@@ -177,51 +148,28 @@ _remove_invalid_gids (hb_set_t *glyphs,
 
 static void
 _populate_gids_to_retain (hb_subset_plan_t* plan,
+			  const hb_subset_accelerator_t *accel,
 			  const hb_set_t *unicodes,
 			  const hb_set_t *input_glyphs_to_retain,
 			  bool close_over_gsub,
 			  bool close_over_gpos,
 			  bool close_over_gdef)
 {
-  OT::cmap::accelerator_t cmap;
-  OT::glyf::accelerator_t glyf;
-#ifndef HB_NO_SUBSET_CFF
-  OT::cff1::accelerator_t cff;
-#endif
-  OT::COLR::accelerator_t colr;
-  cmap.init (plan->source);
-  glyf.init (plan->source);
-#ifndef HB_NO_SUBSET_CFF
-  cff.init (plan->source);
-#endif
-  colr.init (plan->source);
-
   plan->_glyphset_gsub->add (0); // Not-def
   hb_set_union (plan->_glyphset_gsub, input_glyphs_to_retain);
 
-  hb_codepoint_t cp = HB_SET_VALUE_INVALID;
-  while (unicodes->next (&cp))
-  {
-    hb_codepoint_t gid;
-    if (!cmap.get_nominal_glyph (cp, &gid))
-    {
-      DEBUG_MSG(SUBSET, nullptr, "Drop U+%04X; no gid", cp);
-      continue;
-    }
-    plan->unicodes->add (cp);
-    plan->codepoint_to_glyph->set (cp, gid);
-    plan->_glyphset_gsub->add (gid);
-  }
+  accel->map_unicodes (unicodes, plan->unicodes, plan->codepoint_to_glyph, plan->_glyphset_gsub);
 
-  _cmap_closure (plan->source, plan->unicodes, plan->_glyphset_gsub);
+  accel->cmap.table->closure_glyphs (plan->unicodes, plan->_glyphset_gsub);
 
 #ifndef HB_NO_SUBSET_LAYOUT
-  if (close_over_gsub)
-    // closure all glyphs/lookups/features needed for GSUB substitutions.
-    _gsub_closure_glyphs_lookups_features (plan->source, plan->_glyphset_gsub, plan->gsub_lookups, plan->gsub_features);
+  if (close_over_gsub &&
+      // closure all glyphs/lookups/features needed for GSUB substitutions.
+      !plan->check_success (_gsub_closure_glyphs_lookups_features (plan, accel, plan->_glyphset_gsub, plan->gsub_lookups, plan->gsub_features)))
+    return;
 
   if (close_over_gpos)
-    _gpos_closure_lookups_features (plan->source, plan->_glyphset_gsub, plan->gpos_lookups, plan->gpos_features);
+    _gpos_closure_lookups_features (plan->source, accel, plan->_glyphset_gsub, plan->gpos_lookups, plan->gpos_features);
 #endif
   _remove_invalid_gids (plan->_glyphset_gsub, plan->source->get_num_glyphs ());
 
@@ -230,27 +178,21 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
   hb_codepoint_t gid = HB_SET_VALUE_INVALID;
   while (plan->_glyphset_gsub->next (&gid))
   {
-    glyf.add_gid_and_children (gid, plan->_glyphset);
+    accel->glyf.add_gid_and_children (gid, plan->_glyphset);
 #ifndef HB_NO_SUBSET_CFF
-    if (cff.is_valid ())
-      _add_cff_seac_components (cff, gid, plan->_glyphset);
+    if (accel->cff.is_valid ())
+      _add_cff_seac_components (accel->cff, gid, plan->_glyphset);
 #endif
-    if (colr.is_valid ())
-      colr.closure_glyphs (gid, plan->_glyphset);
+    if (accel->colr.is_valid ())
+      accel->colr.closure_glyphs (gid, plan->_glyphset);
   }
 
   _remove_invalid_gids (plan->_glyphset, plan->source->get_num_glyphs ());
 
 #ifndef HB_NO_VAR
   if (close_over_gdef)
-    _collect_layout_variation_indices (plan->source, plan->_glyphset, plan->gpos_lookups, plan->layout_variation_indices, plan->layout_variation_idx_map);
-#endif
-
-#ifndef HB_NO_SUBSET_CFF
-  cff.fini ();
+    _collect_layout_variation_indices (plan->source, accel, plan->_glyphset, plan->gpos_lookups, plan->layout_variation_indices, plan->layout_variation_idx_map);
 #endif
-  glyf.fini ();
-  cmap.fini ();
 }
 
 static void
@@ -300,6 +242,64 @@ _nameid_closure (hb_face_t *face,
 #endif
 }
 
+/**
+ * hb_subset_preprocess:
+ * @source: a #hb_face_t object.
+ *
+ * Precomputes the parts of subset planning that only depend on @source:
+ * the cmap is flattened into a map, the layout tables are sanitized and
+ * their lookups collected once, and GSUB closures computed by subsequent
+ * hb_subset() calls are remembered on the face, so that plans for the
+ * same glyphs do not need to be recomputed.
+ *
+ * The precomputed data is attached to @source itself, which is
+ * returned for convenience.  This is worth doing when @source will be
+ * subset many times; it is safe to subset a preprocessed face from
+ * multiple threads.
+ *
+ * Return value: (transfer full): a new reference to @source.
+ *
+ * Since: REPLACEME
+ **/
+hb_face_t *
+hb_subset_preprocess (hb_face_t *source)
+{
+  hb_ot_face_reader_t reader (source->table);
+  if (hb_subset_accelerator_t::get (source))
+    return hb_face_reference (source);
+
+  hb_subset_accelerator_t *accel = hb_subset_accelerator_t::create (source);
+  if (unlikely (!accel))
+    return hb_face_reference (source);
+
+  if (!hb_face_set_user_data (source,
+			      (hb_user_data_key_t *) hb_subset_accelerator_t::user_data_key (),
+			      accel,
+			      hb_subset_accelerator_t::destroy,
+			      false))
+    /* Lost a race with another thread, or out of memory. */
+    hb_subset_accelerator_t::destroy (accel);
+
+  return hb_face_reference (source);
+}
+
+static unsigned int
+_closure_memory_usage (const hb_subset_plan_t *plan)
+{
+  return plan->unicodes->get_allocated_size () +
+	 plan->_glyphset->get_allocated_size () +
+	 plan->_glyphset_gsub->get_allocated_size () +
+	 plan->codepoint_to_glyph->get_allocated_size () +
+	 plan->glyph_map->get_allocated_size () +
+	 plan->reverse_glyph_map->get_allocated_size () +
+	 plan->gsub_lookups->get_allocated_size () +
+	 plan->gpos_lookups->get_allocated_size () +
+	 plan->gsub_features->get_allocated_size () +
+	 plan->gpos_features->get_allocated_size () +
+	 plan->layout_variation_indices->get_allocated_size () +
+	 plan->layout_variation_idx_map->get_allocated_size ();
+}
+
 /**
  * hb_subset_plan_create:
  * Computes a plan for subsetting the supplied face according
@@ -314,6 +314,7 @@ hb_subset_plan_t *
 hb_subset_plan_create (hb_face_t         *face,
 		       hb_subset_input_t *input)
 {
+  hb_ot_face_reader_t reader (face->table);
   hb_subset_plan_t *plan;
   if (unlikely (!(plan = hb_object_create<hb_subset_plan_t> ())))
     return const_cast<hb_subset_plan_t *> (&Null (hb_subset_plan_t));
@@ -321,8 +322,17 @@ hb_subset_plan_create (hb_face_t         *face,
   plan->successful = true;
   plan->drop_hints = input->drop_hints;
   plan->desubroutinize = input->desubroutinize;
+  plan->resubroutinize = input->resubroutinize;
   plan->retain_gids = input->retain_gids;
   plan->name_legacy = input->name_legacy;
+  plan->dedup_budget = input->dedup_budget;
+  plan->num_threads = input->num_threads;
+  plan->memory_limit = input->memory_limit;
+  plan->memory_used = 0;
+  plan->memory_lock.init ();
+  plan->ops_left = input->op_budget;
+  plan->progress_func = input->progress_func;
+  plan->progress_data = input->progress_data;
   plan->unicodes = hb_set_create ();
   plan->name_ids = hb_set_reference (input->name_ids);
   _nameid_closure (face, plan->name_ids);
@@ -344,12 +354,25 @@ hb_subset_plan_create (hb_face_t         *face,
   plan->layout_variation_indices = hb_set_create ();
   plan->layout_variation_idx_map = hb_map_create ();
 
+  bool close_over_gsub = !input->drop_tables->has (HB_OT_TAG_GSUB);
+  bool close_over_gpos = !input->drop_tables->has (HB_OT_TAG_GPOS);
+  bool close_over_gdef = !input->drop_tables->has (HB_OT_TAG_GDEF);
+
+  const hb_subset_accelerator_t *accel = hb_subset_accelerator_t::get (face);
+  hb_subset_accelerator_t local_accel;
+  if (!accel)
+  {
+    local_accel.init (face, false, close_over_gsub || close_over_gpos || close_over_gdef);
+    accel = &local_accel;
+  }
+
   _populate_gids_to_retain (plan,
+			    accel,
 			    input->unicodes,
 			    input->glyphs,
-			    !input->drop_tables->has (HB_OT_TAG_GSUB),
-			    !input->drop_tables->has (HB_OT_TAG_GPOS),
-			    !input->drop_tables->has (HB_OT_TAG_GDEF));
+			    close_over_gsub,
+			    close_over_gpos,
+			    close_over_gdef);
 
   _create_old_gid_to_new_gid_map (face,
 				  input->retain_gids,
@@ -358,6 +381,12 @@ hb_subset_plan_create (hb_face_t         *face,
 				  plan->reverse_glyph_map,
 				  &plan->_num_output_glyphs);
 
+  if (accel == &local_accel)
+    local_accel.fini ();
+
+  /* The closure is held until the subset is done. */
+  plan->check_success (plan->reserve_memory (_closure_memory_usage (plan)));
+
   return plan;
 }
 
@@ -389,6 +418,7 @@ hb_subset_plan_destroy (hb_subset_plan_t *plan)
   hb_map_destroy (plan->gpos_features);
   hb_set_destroy (plan->layout_variation_indices);
   hb_map_destroy (plan->layout_variation_idx_map);
+  plan->memory_lock.fini ();
 
 
   free (plan);
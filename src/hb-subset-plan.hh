@@ -34,6 +34,12 @@
 
 #include "hb-map.hh"
 #include "hb-set.hh"
+#include "hb-mutex.hh"
+
+#if !defined(HB_NO_MT) && defined(HAVE_PTHREAD)
+#include <pthread.h>
+#define HB_SUBSET_THREADS 1
+#endif
 
 struct hb_subset_plan_t
 {
@@ -42,9 +48,27 @@ struct hb_subset_plan_t
   bool successful : 1;
   bool drop_hints : 1;
   bool desubroutinize : 1;
+  bool resubroutinize : 1;
   bool retain_gids : 1;
   bool name_legacy : 1;
 
+  // Bytes of each table to search for duplicate subtables.
+  unsigned int dedup_budget;
+
+  // Threads a single table may use, including the calling one.
+  unsigned int num_threads;
+
+  // Bytes the subset may hold, and how many it holds now.
+  unsigned int memory_limit;
+  unsigned int memory_used;
+  hb_mutex_t memory_lock;
+
+  // Glyph closure ops left.
+  unsigned int ops_left;
+
+  hb_subset_progress_func_t progress_func;
+  void *progress_data;
+
   // For each cp that we'd like to retain maps to the corresponding gid.
   hb_set_t *unicodes;
 
@@ -98,6 +122,54 @@ struct hb_subset_plan_t
     return successful;
   }
 
+  /* Accounts for @size more bytes held by the subset.  Returns false,
+   * accounting for nothing, if that would go over the memory limit. */
+  bool reserve_memory (unsigned int size)
+  {
+    if (memory_limit == (unsigned int) -1) return true;
+    hb_lock_t l (memory_lock);
+    if (unlikely (size > memory_limit - memory_used))
+    {
+      DEBUG_MSG (SUBSET, nullptr, "memory limit reached: %u + %u > %u bytes",
+		 memory_used, size, memory_limit);
+      return false;
+    }
+    memory_used += size;
+    return true;
+  }
+
+  /* Bytes the subset may still hold. */
+  unsigned int get_memory_left ()
+  {
+    if (memory_limit == (unsigned int) -1) return (unsigned int) -1;
+    hb_lock_t l (memory_lock);
+    return memory_limit - memory_used;
+  }
+
+  void release_memory (unsigned int size)
+  {
+    if (memory_limit == (unsigned int) -1) return;
+    hb_lock_t l (memory_lock);
+    memory_used -= hb_min (size, memory_used);
+  }
+
+  /* Uses up @ops of the closure budget. */
+  bool consume_ops (unsigned int ops)
+  {
+    if (unlikely (ops > ops_left))
+    {
+      ops_left = 0;
+      return false;
+    }
+    ops_left -= ops;
+    return true;
+  }
+
+  /* Tells the progress callback that @table_tag is being worked on;
+   * false if it cancelled the subset. */
+  bool progress (hb_tag_t table_tag)
+  { return !progress_func || progress_func (table_tag, progress_data); }
+
   /*
    * The set of input glyph ids which will be retained in the subset.
    * Does NOT include ids kept due to retain_gids. You probably want to use
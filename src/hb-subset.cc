@@ -28,6 +28,7 @@
 #include "hb-open-type.hh"
 
 #include "hb-subset.hh"
+#include "hb-repacker.hh"
 
 #include "hb-open-file.hh"
 #include "hb-ot-cmap-table.hh"
@@ -52,9 +53,29 @@
 #include "hb-ot-var-hvar-table.hh"
 
 
+static bool
+_table_size_scales_with_glyphs (hb_tag_t tag)
+{
+  switch (tag)
+  {
+  /* Subsetting these only drops records; anything kept is not
+   * proportional to the number of glyphs. */
+  case HB_OT_TAG_name:
+  case HB_OT_TAG_GDEF:
+  case HB_OT_TAG_GSUB:
+  case HB_OT_TAG_GPOS:
+    return false;
+  default:
+    return true;
+  }
+}
+
 static unsigned
-_plan_estimate_subset_table_size (hb_subset_plan_t *plan, unsigned table_len)
+_plan_estimate_subset_table_size (hb_subset_plan_t *plan, hb_tag_t tag, unsigned table_len)
 {
+  if (!_table_size_scales_with_glyphs (tag))
+    return 512 + table_len;
+
   unsigned src_glyphs = plan->source->get_num_glyphs ();
   unsigned dst_glyphs = plan->glyphset ()->get_population ();
 
@@ -66,7 +87,7 @@ _plan_estimate_subset_table_size (hb_subset_plan_t *plan, unsigned table_len)
 
 template<typename TableType>
 static bool
-_subset (hb_subset_plan_t *plan)
+_subset (hb_subset_plan_t *plan, hb_subset_table_list_t *tables)
 {
   bool result = false;
   hb_blob_t *source_blob = hb_sanitize_context_t ().reference_table<TableType> (plan->source);
@@ -76,44 +97,88 @@ _subset (hb_subset_plan_t *plan)
   if (source_blob->data)
   {
     hb_vector_t<char> buf;
-    /* TODO Not all tables are glyph-related.  'name' table size for example should not be
-     * affected by number of glyphs.  Accommodate that. */
-    unsigned buf_size = _plan_estimate_subset_table_size (plan, source_blob->length);
+    /* Subsetters that can bound their output size grow the buffer through
+     * hb_subset_context_t::ensure_room(); for the rest this is a guess, and
+     * running out of room means starting over. */
+    unsigned buf_size = _plan_estimate_subset_table_size (plan, tag, source_blob->length);
     DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c initial estimated table size: %u bytes.", HB_UNTAG (tag), buf_size);
+    if (unlikely (!plan->reserve_memory (buf_size)))
+    {
+      hb_blob_destroy (source_blob);
+      return false;
+    }
     if (unlikely (!buf.alloc (buf_size)))
     {
       DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c failed to allocate %u bytes.", HB_UNTAG (tag), buf_size);
+      plan->release_memory (buf_size);
       hb_blob_destroy (source_blob);
       return false;
     }
+    /* The serializer buffer is accounted for as its size, which
+     * hb_subset_context_t::ensure_room() may change. */
   retry:
     hb_serialize_context_t serializer ((void *) buf, buf_size);
+    serializer.set_share_budget (plan->dedup_budget);
+    serializer.set_memory_budget (plan->get_memory_left ());
     serializer.start_serialize<TableType> ();
-    hb_subset_context_t c (source_blob, plan, &serializer, tag);
+    hb_subset_context_t c (source_blob, plan, &serializer, tag, tables, &buf);
     bool needed = table->subset (&c);
     if (serializer.ran_out_of_room)
     {
-      buf_size += (buf_size >> 1) + 32;
+      unsigned old_size = serializer.end - serializer.start;
+      buf_size = old_size + (old_size >> 1) + 32;
       DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c ran out of room; reallocating to %u bytes.", HB_UNTAG (tag), buf_size);
+      if (unlikely (!plan->reserve_memory (buf_size - old_size)))
+      {
+	plan->release_memory (old_size);
+	hb_blob_destroy (source_blob);
+	return false;
+      }
       if (unlikely (!buf.alloc (buf_size)))
       {
 	DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c failed to reallocate %u bytes.", HB_UNTAG (tag), buf_size);
+	plan->release_memory (buf_size);
 	hb_blob_destroy (source_blob);
 	return false;
       }
       goto retry;
     }
     serializer.end_serialize ();
+    /* The serializer's bookkeeping, which it kept within what was left of
+     * the limit, is held along with its buffer until the table is done. */
+    unsigned buf_reserved = serializer.end - serializer.start;
+    bool fits = plan->reserve_memory (serializer.get_memory_usage ());
+    if (likely (fits))
+      buf_reserved += serializer.get_memory_usage ();
 
-    result = !serializer.in_error ();
+    hb_blob_t *dest_blob = nullptr;
+    if (unlikely (!fits))
+      DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c serializer bookkeeping is over the memory limit.", HB_UNTAG (tag));
+    else if (serializer.offset_overflow && needed)
+    {
+      DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c has offset overflows; repacking.", HB_UNTAG (tag));
+      unsigned graph_size = hb_resolve_overflows_memory_usage (serializer.object_graph ());
+      if (plan->reserve_memory (graph_size))
+      {
+	dest_blob = hb_resolve_overflows (serializer.object_graph (), tag);
+	plan->release_memory (graph_size);
+      }
+      result = dest_blob;
+    }
+    else
+    {
+      result = !serializer.in_error ();
+      if (result && needed)
+	dest_blob = serializer.copy_blob ();
+    }
 
     if (result)
     {
       if (needed)
       {
-	hb_blob_t *dest_blob = serializer.copy_blob ();
 	DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c final subset table size: %u bytes.", HB_UNTAG (tag), dest_blob->length);
-	result = c.plan->add_table (tag, dest_blob);
+	/* The finished table is held until the whole subset is done. */
+	result = plan->reserve_memory (dest_blob->length) && c.add_table (tag, dest_blob);
 	hb_blob_destroy (dest_blob);
       }
       else
@@ -121,6 +186,7 @@ _subset (hb_subset_plan_t *plan)
 	DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c::subset table subsetted to empty.", HB_UNTAG (tag));
       }
     }
+    plan->release_memory (buf_reserved);
   }
   else
     DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c::subset sanitize failed on source table.", HB_UNTAG (tag));
@@ -178,56 +244,208 @@ _should_drop_table (hb_subset_plan_t *plan, hb_tag_t tag)
   }
 }
 
+/* Subsets one source table; the resulting tables are added to the plan's
+ * face, or to tables if not null. */
 static bool
-_subset_table (hb_subset_plan_t *plan, hb_tag_t tag)
+_subset_table (hb_subset_plan_t *plan, hb_tag_t tag,
+	       hb_subset_table_list_t *tables = nullptr)
 {
   DEBUG_MSG (SUBSET, nullptr, "subset %c%c%c%c", HB_UNTAG (tag));
+  if (unlikely (!plan->progress (tag)))
+  {
+    DEBUG_MSG (SUBSET, nullptr, "subset cancelled before %c%c%c%c", HB_UNTAG (tag));
+    return false;
+  }
   switch (tag)
   {
-  case HB_OT_TAG_glyf: return _subset<const OT::glyf> (plan);
-  case HB_OT_TAG_hdmx: return _subset<const OT::hdmx> (plan);
-  case HB_OT_TAG_name: return _subset<const OT::name> (plan);
+  case HB_OT_TAG_glyf: return _subset<const OT::glyf> (plan, tables);
+  case HB_OT_TAG_hdmx: return _subset<const OT::hdmx> (plan, tables);
+  case HB_OT_TAG_name: return _subset<const OT::name> (plan, tables);
   case HB_OT_TAG_head:
     if (_is_table_present (plan->source, HB_OT_TAG_glyf) && !_should_drop_table (plan, HB_OT_TAG_glyf))
       return true; /* skip head, handled by glyf */
-    return _subset<const OT::head> (plan);
+    return _subset<const OT::head> (plan, tables);
   case HB_OT_TAG_hhea: return true; /* skip hhea, handled by hmtx */
-  case HB_OT_TAG_hmtx: return _subset<const OT::hmtx> (plan);
+  case HB_OT_TAG_hmtx: return _subset<const OT::hmtx> (plan, tables);
   case HB_OT_TAG_vhea: return true; /* skip vhea, handled by vmtx */
-  case HB_OT_TAG_vmtx: return _subset<const OT::vmtx> (plan);
-  case HB_OT_TAG_maxp: return _subset<const OT::maxp> (plan);
-  case HB_OT_TAG_sbix: return _subset<const OT::sbix> (plan);
+  case HB_OT_TAG_vmtx: return _subset<const OT::vmtx> (plan, tables);
+  case HB_OT_TAG_maxp: return _subset<const OT::maxp> (plan, tables);
+  case HB_OT_TAG_sbix: return _subset<const OT::sbix> (plan, tables);
   case HB_OT_TAG_loca: return true; /* skip loca, handled by glyf */
-  case HB_OT_TAG_cmap: return _subset<const OT::cmap> (plan);
-  case HB_OT_TAG_OS2 : return _subset<const OT::OS2 > (plan);
-  case HB_OT_TAG_post: return _subset<const OT::post> (plan);
-  case HB_OT_TAG_COLR: return _subset<const OT::COLR> (plan);
-  case HB_OT_TAG_CBLC: return _subset<const OT::CBLC> (plan);
+  case HB_OT_TAG_cmap: return _subset<const OT::cmap> (plan, tables);
+  case HB_OT_TAG_OS2 : return _subset<const OT::OS2 > (plan, tables);
+  case HB_OT_TAG_post: return _subset<const OT::post> (plan, tables);
+  case HB_OT_TAG_COLR: return _subset<const OT::COLR> (plan, tables);
+  case HB_OT_TAG_CBLC: return _subset<const OT::CBLC> (plan, tables);
   case HB_OT_TAG_CBDT: return true; /* skip CBDT, handled by CBLC */
 
 #ifndef HB_NO_SUBSET_CFF
-  case HB_OT_TAG_cff1: return _subset<const OT::cff1> (plan);
-  case HB_OT_TAG_cff2: return _subset<const OT::cff2> (plan);
-  case HB_OT_TAG_VORG: return _subset<const OT::VORG> (plan);
+  case HB_OT_TAG_cff1: return _subset<const OT::cff1> (plan, tables);
+  case HB_OT_TAG_cff2: return _subset<const OT::cff2> (plan, tables);
+  case HB_OT_TAG_VORG: return _subset<const OT::VORG> (plan, tables);
 #endif
 
 #ifndef HB_NO_SUBSET_LAYOUT
-  case HB_OT_TAG_GDEF: return _subset<const OT::GDEF> (plan);
-  case HB_OT_TAG_GSUB: return _subset<const OT::GSUB> (plan);
-  case HB_OT_TAG_GPOS: return _subset<const OT::GPOS> (plan);
-  case HB_OT_TAG_gvar: return _subset<const OT::gvar> (plan);
-  case HB_OT_TAG_HVAR: return _subset<const OT::HVAR> (plan);
-  case HB_OT_TAG_VVAR: return _subset<const OT::VVAR> (plan);
+  case HB_OT_TAG_GDEF: return _subset<const OT::GDEF> (plan, tables);
+  case HB_OT_TAG_GSUB: return _subset<const OT::GSUB> (plan, tables);
+  case HB_OT_TAG_GPOS: return _subset<const OT::GPOS> (plan, tables);
+  case HB_OT_TAG_gvar: return _subset<const OT::gvar> (plan, tables);
+  case HB_OT_TAG_HVAR: return _subset<const OT::HVAR> (plan, tables);
+  case HB_OT_TAG_VVAR: return _subset<const OT::VVAR> (plan, tables);
 #endif
 
   default:
     hb_blob_t *source_table = hb_face_reference_table (plan->source, tag);
-    bool result = plan->add_table (tag, source_table);
+    bool result = tables ? tables->add (tag, source_table) : plan->add_table (tag, source_table);
     hb_blob_destroy (source_table);
     return result;
   }
 }
 
+#ifdef HB_SUBSET_THREADS
+/* Source tables handed out to worker threads in order.  Each keeps the
+ * tables it produces to itself, and the calling thread adds them to the
+ * face afterwards in the same order the serial loop would have. */
+struct hb_subset_table_tasks_t
+{
+  struct task_t
+  {
+    hb_tag_t tag;
+    bool success;
+    hb_subset_table_list_t tables;
+  };
+
+  void run ()
+  {
+    for (;;)
+    {
+      unsigned int i = next.inc ();
+      if (i >= tasks.length || failed.get_relaxed ()) return;
+      task_t &task = tasks[i];
+      task.success = _subset_table (plan, task.tag, &task.tables);
+      if (unlikely (!task.success)) failed.set_relaxed (1);
+    }
+  }
+
+  static void *worker (void *data)
+  {
+    ((hb_subset_table_tasks_t *) data)->run ();
+    return nullptr;
+  }
+
+  hb_subset_plan_t *plan;
+  hb_array_t<task_t> tasks;
+  hb_atomic_int_t next;
+  hb_atomic_int_t failed;
+};
+
+/* Tables only read the plan, except for hb_set_t caching its population;
+ * compute those upfront so that threads don't race on them. */
+static void
+_plan_prepare_for_threads (hb_subset_plan_t *plan)
+{
+  plan->unicodes->get_population ();
+  plan->name_ids->get_population ();
+  plan->name_languages->get_population ();
+  plan->glyphs_requested->get_population ();
+  plan->drop_tables->get_population ();
+  plan->_glyphset->get_population ();
+  plan->_glyphset_gsub->get_population ();
+  plan->layout_variation_indices->get_population ();
+}
+
+static bool
+_subset_tables_parallel (hb_subset_plan_t *plan,
+			 hb_array_t<const hb_tag_t> tags,
+			 unsigned int num_threads,
+			 hb_subset_table_list_t *tables)
+{
+  hb_vector_t<hb_subset_table_tasks_t::task_t> tasks;
+  if (unlikely (!tasks.resize (tags.length))) return false;
+  for (unsigned int i = 0; i < tags.length; i++)
+  {
+    tasks[i].tag = tags[i];
+    tasks[i].success = false;
+    tasks[i].tables.init ();
+  }
+
+  _plan_prepare_for_threads (plan);
+
+  hb_subset_table_tasks_t shared;
+  shared.plan = plan;
+  shared.tasks = tasks.as_array ();
+  shared.next.set_relaxed (0);
+  shared.failed.set_relaxed (0);
+
+  hb_vector_t<pthread_t> threads;
+  unsigned int num_workers = hb_min (num_threads, tags.length) - 1;
+  for (unsigned int i = 0; i < num_workers; i++)
+  {
+    pthread_t thread;
+    if (pthread_create (&thread, nullptr, hb_subset_table_tasks_t::worker, &shared))
+      break; /* Carry on with the threads we have. */
+    threads.push (thread);
+    if (unlikely (threads.in_error ()))
+    {
+      pthread_join (thread, nullptr);
+      break;
+    }
+  }
+  shared.run ();
+  for (unsigned int i = 0; i < threads.length; i++)
+    pthread_join (threads[i], nullptr);
+
+  bool success = true;
+  for (unsigned int i = 0; i < tasks.length && success; i++)
+  {
+    success = tasks[i].success;
+    for (unsigned int j = 0; j < tasks[i].tables.items.length && success; j++)
+    {
+      const hb_subset_table_list_t::item_t &item = tasks[i].tables.items[j];
+      success = tables ? tables->add (item.tag, item.blob) : plan->add_table (item.tag, item.blob);
+    }
+  }
+
+  for (unsigned int i = 0; i < tasks.length; i++)
+    tasks[i].tables.fini ();
+  return success;
+}
+#endif
+
+/* Subsets every table the plan keeps; the results are added to the plan's
+ * face, or to tables if not null. */
+static bool
+_subset_tables (hb_subset_plan_t *plan,
+		unsigned int num_threads,
+		hb_subset_table_list_t *tables = nullptr)
+{
+  hb_set_t tags_set;
+  hb_vector_t<hb_tag_t> tags;
+  hb_tag_t table_tags[32];
+  unsigned offset = 0, num_tables = ARRAY_LENGTH (table_tags);
+  while ((hb_face_get_table_tags (plan->source, offset, &num_tables, table_tags), num_tables))
+  {
+    for (unsigned i = 0; i < num_tables; ++i)
+    {
+      hb_tag_t tag = table_tags[i];
+      if (_should_drop_table (plan, tag) && !tags_set.has (tag)) continue;
+      tags_set.add (tag);
+      tags.push (tag);
+    }
+    offset += num_tables;
+  }
+
+  if (unlikely (tags.in_error ())) return false;
+#ifdef HB_SUBSET_THREADS
+  if (num_threads > 1 && tags.length > 1)
+    return _subset_tables_parallel (plan, tags.as_array (), num_threads, tables);
+#endif
+  bool success = true;
+  for (unsigned i = 0; i < tags.length && success; i++)
+    success = _subset_table (plan, tags[i], tables);
+  return success;
+}
+
 /**
  * hb_subset:
  * @source: font face data to be subset.
@@ -239,31 +457,77 @@ hb_face_t *
 hb_subset (hb_face_t *source, hb_subset_input_t *input)
 {
   if (unlikely (!input || !source)) return hb_face_get_empty ();
+  hb_ot_face_reader_t reader (source->table);
 
   hb_subset_plan_t *plan = hb_subset_plan_create (source, input);
   if (unlikely (plan->in_error ()))
-    return hb_face_get_empty ();
-
-  hb_set_t tags_set;
-  bool success = true;
-  hb_tag_t table_tags[32];
-  unsigned offset = 0, num_tables = ARRAY_LENGTH (table_tags);
-  while ((hb_face_get_table_tags (source, offset, &num_tables, table_tags), num_tables))
   {
-    for (unsigned i = 0; i < num_tables; ++i)
-    {
-      hb_tag_t tag = table_tags[i];
-      if (_should_drop_table (plan, tag) && !tags_set.has (tag)) continue;
-      tags_set.add (tag);
-      success = _subset_table (plan, tag);
-      if (unlikely (!success)) goto end;
-    }
-    offset += num_tables;
+    hb_subset_plan_destroy (plan);
+    return hb_face_get_empty ();
   }
-end:
 
+  bool success = _subset_tables (plan, input->num_threads);
   hb_face_t *result = success ? hb_face_reference (plan->dest) : hb_face_get_empty ();
 
   hb_subset_plan_destroy (plan);
   return result;
 }
+
+/**
+ * hb_subset_write:
+ * @source: font face data to be subset.
+ * @input: input to use for the subsetting.
+ * @write_func: (closure user_data) (scope call): called with the bytes of
+ * the subset font, in order.
+ * @user_data: data to pass to @write_func.
+ *
+ * Subsets a font like hb_subset() does, but instead of returning a face,
+ * writes the resulting font file to @write_func.  The bytes written are the
+ * same as those of hb_face_reference_blob() on the face hb_subset() returns,
+ * without the whole font ever being copied into one buffer.
+ *
+ * If subsetting fails or @write_func returns false, writing stops and false
+ * is returned; some of the font may have been written already.
+ *
+ * Return value: true if the whole font was written.
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_subset_write (hb_face_t              *source,
+		 hb_subset_input_t      *input,
+		 hb_subset_write_func_t  write_func,
+		 void                   *user_data)
+{
+  if (unlikely (!input || !source || !write_func)) return false;
+  hb_ot_face_reader_t reader (source->table);
+
+  hb_subset_plan_t *plan = hb_subset_plan_create (source, input);
+  if (unlikely (plan->in_error ()))
+  {
+    hb_subset_plan_destroy (plan);
+    return false;
+  }
+
+  hb_subset_table_list_t tables;
+  tables.init ();
+  bool success = _subset_tables (plan, input->num_threads, &tables);
+  /* Only the subset tables are needed from here on. */
+  hb_subset_plan_destroy (plan);
+
+  if (success)
+  {
+    bool is_cff = false;
+    for (unsigned int i = 0; i < tables.items.length; i++)
+      if (tables.items[i].tag == HB_OT_TAG_cff1 || tables.items[i].tag == HB_OT_TAG_cff2)
+	is_cff = true;
+    hb_tag_t sfnt_tag = is_cff ? OT::OpenTypeFontFile::CFFTag : OT::OpenTypeFontFile::TrueTypeTag;
+
+    success = OT::OpenTypeFontFace::write (sfnt_tag, tables.items.as_array (),
+					   [&] (const char *data, unsigned int length) -> bool
+					   { return write_func (data, length, user_data); });
+  }
+
+  tables.fini ();
+  return success;
+}
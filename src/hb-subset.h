@@ -75,6 +75,12 @@ hb_subset_input_set_desubroutinize (hb_subset_input_t *subset_input,
 HB_EXTERN hb_bool_t
 hb_subset_input_get_desubroutinize (hb_subset_input_t *subset_input);
 
+HB_EXTERN void
+hb_subset_input_set_resubroutinize (hb_subset_input_t *subset_input,
+				    hb_bool_t resubroutinize);
+HB_EXTERN hb_bool_t
+hb_subset_input_get_resubroutinize (hb_subset_input_t *subset_input);
+
 HB_EXTERN void
 hb_subset_input_set_retain_gids (hb_subset_input_t *subset_input,
 				 hb_bool_t retain_gids);
@@ -87,10 +93,83 @@ hb_subset_input_set_name_legacy (hb_subset_input_t *subset_input,
 HB_EXTERN hb_bool_t
 hb_subset_input_get_name_legacy (hb_subset_input_t *subset_input);
 
+HB_EXTERN void
+hb_subset_input_set_num_threads (hb_subset_input_t *subset_input,
+				 unsigned int num_threads);
+HB_EXTERN unsigned int
+hb_subset_input_get_num_threads (hb_subset_input_t *subset_input);
+
+HB_EXTERN void
+hb_subset_input_set_dedup_budget (hb_subset_input_t *subset_input,
+				  unsigned int dedup_budget);
+HB_EXTERN unsigned int
+hb_subset_input_get_dedup_budget (hb_subset_input_t *subset_input);
+
+HB_EXTERN void
+hb_subset_input_set_memory_limit (hb_subset_input_t *subset_input,
+				  unsigned int memory_limit);
+HB_EXTERN unsigned int
+hb_subset_input_get_memory_limit (hb_subset_input_t *subset_input);
+
+HB_EXTERN void
+hb_subset_input_set_op_budget (hb_subset_input_t *subset_input,
+			       unsigned int op_budget);
+HB_EXTERN unsigned int
+hb_subset_input_get_op_budget (hb_subset_input_t *subset_input);
+
+/**
+ * hb_subset_progress_func_t:
+ * @table_tag: the table about to be worked on.
+ * @user_data: user data passed to hb_subset_input_set_progress_func().
+ *
+ * A callback made while a font is being subset: before each table is
+ * subset, with that table's tag, and regularly while glyphs are closed
+ * over GSUB, with %HB_OT_TAG_GSUB.  When tables are subset on several
+ * threads it may be called from any of them, concurrently.
+ *
+ * Return value: true to continue, false to cancel the subset.
+ *
+ * Since: REPLACEME
+ **/
+typedef hb_bool_t (*hb_subset_progress_func_t) (hb_tag_t  table_tag,
+						void     *user_data);
+
+HB_EXTERN void
+hb_subset_input_set_progress_func (hb_subset_input_t         *subset_input,
+				   hb_subset_progress_func_t  func,
+				   void                      *user_data,
+				   hb_destroy_func_t          destroy);
+
+HB_EXTERN hb_face_t *
+hb_subset_preprocess (hb_face_t *source);
+
 /* hb_subset () */
 HB_EXTERN hb_face_t *
 hb_subset (hb_face_t *source, hb_subset_input_t *input);
 
+/**
+ * hb_subset_write_func_t:
+ * @data: the next bytes of the font file.
+ * @length: the number of bytes in @data.
+ * @user_data: user data passed to hb_subset_write().
+ *
+ * A callback receiving the subset font file piece by piece.  @data is only
+ * valid for the duration of the call.
+ *
+ * Return value: true to continue, false to stop writing.
+ *
+ * Since: REPLACEME
+ **/
+typedef hb_bool_t (*hb_subset_write_func_t) (const char   *data,
+					     unsigned int  length,
+					     void         *user_data);
+
+HB_EXTERN hb_bool_t
+hb_subset_write (hb_face_t              *source,
+		 hb_subset_input_t      *input,
+		 hb_subset_write_func_t  write_func,
+		 void                   *user_data);
+
 
 HB_END_DECLS
 
@@ -36,6 +36,36 @@
 #include "hb-subset-input.hh"
 #include "hb-subset-plan.hh"
 
+/* Tables produced while subsetting one source table, in order; used to
+ * hold them back when tables are subset in parallel. */
+struct hb_subset_table_list_t
+{
+  struct item_t
+  {
+    hb_tag_t tag;
+    hb_blob_t *blob;
+  };
+
+  void init () { items.init (); }
+  void fini ()
+  {
+    for (unsigned int i = 0; i < items.length; i++)
+      hb_blob_destroy (items[i].blob);
+    items.fini ();
+  }
+
+  bool add (hb_tag_t tag, hb_blob_t *blob)
+  {
+    item_t *item = items.push ();
+    if (unlikely (items.in_error ())) return false;
+    item->tag = tag;
+    item->blob = hb_blob_reference (blob);
+    return true;
+  }
+
+  hb_vector_t<item_t> items;
+};
+
 struct hb_subset_context_t :
        hb_dispatch_context_t<hb_subset_context_t, bool, HB_DEBUG_SUBSET>
 {
@@ -54,19 +84,59 @@ struct hb_subset_context_t :
   dispatch (const T &obj, Ts&&... ds) HB_AUTO_RETURN
   ( _dispatch (obj, hb_prioritize, hb_forward<Ts> (ds)...) )
 
+  /* Adds a finished table to the subset face, or to tables if set. */
+  bool add_table (hb_tag_t tag, hb_blob_t *blob)
+  { return tables ? tables->add (tag, blob) : plan->add_table (tag, blob); }
+
+  /* Subsetters that know an upper bound on their output size call this
+   * before serializing anything, so that the serializer never runs out
+   * of room and the table does not have to be subset again. */
+  bool ensure_room (unsigned int size)
+  {
+    if (unlikely (serializer->in_error ())) return false;
+    if (size <= (unsigned) (serializer->tail - serializer->head)) return true;
+    if (!buffer) return true; /* Leave it to the caller to retry. */
+
+    DEBUG_MSG (SUBSET, nullptr, "OT::%c%c%c%c growing buffer to %u bytes.", HB_UNTAG (table_tag), size);
+    unsigned int old_size = serializer->end - serializer->start;
+    hb_vector_t<char> bigger;
+    if (unlikely (!plan->reserve_memory (size)))
+      return serializer->check_success (false);
+    if (unlikely (!bigger.alloc (size)))
+    {
+      plan->release_memory (size);
+      return serializer->check_success (false);
+    }
+    if (!serializer->relocate (bigger.arrayZ, size))
+    {
+      plan->release_memory (size);
+      return true;
+    }
+
+    plan->release_memory (old_size);
+    *buffer = hb_move (bigger);
+    return true;
+  }
+
   hb_blob_t *source_blob;
   hb_subset_plan_t *plan;
   hb_serialize_context_t *serializer;
   hb_tag_t table_tag;
+  hb_subset_table_list_t *tables;
+  hb_vector_t<char> *buffer;
 
   hb_subset_context_t (hb_blob_t *source_blob_,
 		       hb_subset_plan_t *plan_,
 		       hb_serialize_context_t *serializer_,
-		       hb_tag_t table_tag_) :
+		       hb_tag_t table_tag_,
+		       hb_subset_table_list_t *tables_ = nullptr,
+		       hb_vector_t<char> *buffer_ = nullptr) :
 		        source_blob (source_blob_),
 			plan (plan_),
 			serializer (serializer_),
-			table_tag (table_tag_) {}
+			table_tag (table_tag_),
+			tables (tables_),
+			buffer (buffer_) {}
 };
 
 
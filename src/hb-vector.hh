@@ -126,6 +126,8 @@ struct hb_vector_t
 
   explicit operator bool () const { return length; }
   unsigned get_size () const { return length * item_size; }
+  /* Heap memory held, spare capacity included. */
+  unsigned get_allocated_size () const { return allocated > 0 ? allocated * item_size : 0; }
 
   /* Sink interface. */
   template <typename T>
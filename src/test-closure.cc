@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2026  HarfBuzz contributors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+#include "hb-ot-layout-gsubgpos.hh"
+
+/* Single substitutions, applied in order; once added holds fail_after
+ * glyphs, growing it fails. */
+struct single_lookups_t
+{
+  unsigned int get_count () const { return ARRAY_LENGTH (substs); }
+
+  bool is_per_glyph (unsigned int i) const { return true; }
+
+  bool closure (unsigned int i)
+  {
+    full_count++;
+    if (glyphs->has (substs[i].first))
+      add (substs[i].second);
+    return true;
+  }
+
+  bool closure_glyphs (unsigned int i, hb_array_t<const hb_codepoint_t> new_glyphs)
+  {
+    for (hb_codepoint_t g : new_glyphs)
+      if (g == substs[i].first)
+	add (substs[i].second);
+    return true;
+  }
+
+  void add (hb_codepoint_t g)
+  {
+    if (glyphs->has (g)) return;
+    glyphs->add (g);
+    if (added->length == fail_after)
+      added->alloc (INT_MAX);
+    added->push (g);
+  }
+
+  hb_set_t *glyphs;
+  hb_vector_t<hb_codepoint_t> *added;
+  unsigned int fail_after;
+  unsigned int full_count;
+  hb_pair_t<hb_codepoint_t, hb_codepoint_t> substs[3];
+};
+
+static void
+test_closure (unsigned int fail_after)
+{
+  hb_set_t glyphs;
+  hb_vector_t<hb_codepoint_t> added;
+  /* Closing over 1 takes a pass for each lookup. */
+  single_lookups_t lookups = {&glyphs, &added, fail_after, 0,
+			      {{3, 4}, {2, 3}, {1, 2}}};
+  glyphs.add (1);
+
+  assert (OT::hb_closure_apply_lookups (lookups, &glyphs, added));
+  assert (glyphs.get_population () == 4);
+  assert (glyphs.has (4));
+  assert (added.in_error () == (fail_after < 3));
+
+  /* Each lookup is applied in full the first time around only, unless
+   * added failed to grow. */
+  if (fail_after >= 3)
+    assert (lookups.full_count == 3);
+  else
+    assert (lookups.full_count > 3);
+}
+
+int
+main (int argc, char **argv)
+{
+  test_closure ((unsigned int) -1);
+  test_closure (0);
+  test_closure (1);
+  test_closure (2);
+}
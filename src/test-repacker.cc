@@ -0,0 +1,246 @@
+/*
+ * Copyright © 2026  HarfBuzz contributors
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb-repacker.hh"
+#include "hb-open-type.hh"
+
+static void
+start_object (char tag, unsigned len, hb_serialize_context_t *c)
+{
+  c->push ();
+  char *obj = c->allocate_size<char> (len);
+  memset (obj, tag, len);
+}
+
+static unsigned
+add_object (char tag, unsigned len, hb_serialize_context_t *c)
+{
+  start_object (tag, len, c);
+  return c->pop_pack (false);
+}
+
+static void
+add_offset (unsigned id, hb_serialize_context_t *c)
+{
+  OT::Offset16 *offset = c->start_embed<OT::Offset16> ();
+  c->extend_min (offset);
+  c->add_link (*offset, id);
+}
+
+static void
+add_uint16 (unsigned value, hb_serialize_context_t *c)
+{
+  OT::HBUINT16 *v = c->start_embed<OT::HBUINT16> ();
+  c->extend_min (v);
+  *v = value;
+}
+
+static unsigned
+offset_at (const char *table, unsigned position)
+{ return * (const OT::HBUINT16 *) (table + position); }
+
+static void
+test_no_overflow ()
+{
+  hb_vector_t<char> buf;
+  buf.resize (100);
+  hb_serialize_context_t c ((void *) buf, buf.length);
+  c.start_serialize<char> ();
+  unsigned b = add_object ('b', 10, &c);
+  unsigned a = add_object ('a', 10, &c);
+  add_offset (a, &c);
+  add_offset (b, &c);
+  c.end_serialize ();
+  assert (!c.in_error ());
+
+  hb_blob_t *expected = c.copy_blob ();
+  hb_blob_t *actual = hb_resolve_overflows (c.object_graph (), HB_TAG_NONE);
+  assert (actual);
+  assert (actual->length == expected->length);
+  assert (0 == memcmp (actual->data, expected->data, actual->length));
+  hb_blob_destroy (actual);
+  hb_blob_destroy (expected);
+}
+
+static void
+test_resolve_by_sorting ()
+{
+  hb_vector_t<char> buf;
+  buf.resize (200000);
+  hb_serialize_context_t c ((void *) buf, buf.length);
+  c.start_serialize<char> ();
+  unsigned z = add_object ('z', 10, &c);
+  unsigned y = add_object ('y', 50000, &c);
+  add_object ('o', 1000, &c); /* Orphan. */
+  unsigned x = add_object ('x', 50000, &c);
+  add_offset (x, &c);
+  add_offset (y, &c);
+  add_offset (z, &c);
+  c.end_serialize ();
+  assert (c.offset_overflow);
+
+  hb_blob_t *out = hb_resolve_overflows (c.object_graph (), HB_TAG_NONE);
+  assert (out);
+  /* Unreachable objects are dropped. */
+  assert (out->length == 6 + 100010);
+  assert (out->data[offset_at (out->data, 0)] == 'x');
+  assert (out->data[offset_at (out->data, 2)] == 'y');
+  assert (out->data[offset_at (out->data, 4)] == 'z');
+  hb_blob_destroy (out);
+}
+
+static void
+test_resolve_by_duplication ()
+{
+  hb_vector_t<char> buf;
+  buf.resize (200000);
+  hb_serialize_context_t c ((void *) buf, buf.length);
+  c.start_serialize<char> ();
+  unsigned s = add_object ('s', 10, &c);
+  start_object ('q', 40000, &c);
+  add_offset (s, &c);
+  unsigned q = c.pop_pack (false);
+  start_object ('p', 40000, &c);
+  add_offset (s, &c);
+  unsigned p = c.pop_pack (false);
+  add_offset (p, &c);
+  add_offset (q, &c);
+  c.end_serialize ();
+  assert (c.offset_overflow);
+
+  hb_blob_t *out = hb_resolve_overflows (c.object_graph (), HB_TAG_NONE);
+  assert (out);
+  /* s is now there twice. */
+  assert (out->length == 4 + 2 * 40002 + 2 * 10);
+  const char *data = out->data;
+  for (unsigned i = 0; i < 2; i++)
+  {
+    const char *parent = data + offset_at (data, 2 * i);
+    assert (*parent == (i ? 'q' : 'p'));
+    assert (parent[offset_at (parent, 40000)] == 's');
+  }
+  hb_blob_destroy (out);
+}
+
+static void
+test_resolve_by_extension_promotion ()
+{
+  const unsigned num_lookups = 5;
+  hb_vector_t<char> buf;
+  buf.resize (200000);
+  hb_serialize_context_t c ((void *) buf, buf.length);
+  c.start_serialize<char> ();
+
+  unsigned subtables[num_lookups];
+  for (unsigned i = 0; i < num_lookups; i++)
+    subtables[i] = add_object ('a' + i, 20000, &c);
+
+  unsigned lookups[num_lookups];
+  for (unsigned i = 0; i < num_lookups; i++)
+  {
+    c.push ();
+    add_uint16 (1, &c); /* lookupType */
+    add_uint16 (0, &c); /* lookupFlag */
+    add_uint16 (1, &c); /* subTableCount */
+    add_offset (subtables[i], &c);
+    lookups[i] = c.pop_pack (false);
+  }
+
+  c.push ();
+  add_uint16 (num_lookups, &c);
+  for (unsigned i = 0; i < num_lookups; i++)
+    add_offset (lookups[i], &c);
+  unsigned lookup_list = c.pop_pack (false);
+  unsigned feature_list = add_object ('f', 2, &c);
+  unsigned script_list = add_object ('s', 2, &c);
+
+  add_uint16 (1, &c); /* majorVersion */
+  add_uint16 (0, &c); /* minorVersion */
+  add_offset (script_list, &c);
+  add_offset (feature_list, &c);
+  add_offset (lookup_list, &c);
+  c.end_serialize ();
+  assert (c.offset_overflow);
+
+  /* Reordering alone can't fit this. */
+  assert (!hb_resolve_overflows (c.object_graph (), HB_TAG_NONE));
+
+  hb_blob_t *out = hb_resolve_overflows (c.object_graph (), HB_OT_TAG_GSUB);
+  assert (out);
+  const char *data = out->data;
+  const char *list = data + offset_at (data, 8);
+  assert (offset_at (list, 0) == num_lookups);
+  for (unsigned i = 0; i < num_lookups; i++)
+  {
+    const char *lookup = list + offset_at (list, 2 + 2 * i);
+    assert (offset_at (lookup, 0) == 7);
+    const char *ext = lookup + offset_at (lookup, 6);
+    assert (offset_at (ext, 0) == 1);
+    assert (offset_at (ext, 2) == 1);
+    unsigned ext_offset = * (const OT::HBUINT32 *) (ext + 4);
+    assert (ext[ext_offset] == 'a' + (char) i);
+  }
+  hb_blob_destroy (out);
+}
+
+static void
+test_memory_budget ()
+{
+  hb_vector_t<char> buf;
+  buf.resize (100);
+  hb_serialize_context_t c ((void *) buf, buf.length);
+  c.start_serialize<char> ();
+  unsigned b = add_object ('b', 10, &c);
+  unsigned a = add_object ('a', 10, &c);
+  add_offset (a, &c);
+  add_offset (b, &c);
+  c.end_serialize ();
+  assert (!c.in_error ());
+  unsigned used = c.get_memory_usage ();
+  assert (used);
+  assert (hb_resolve_overflows_memory_usage (c.object_graph ()) >= 2 + 2 + 10 + 10);
+
+  /* One byte short of packing the root. */
+  c.reset ();
+  c.set_memory_budget (used - 1);
+  c.start_serialize<char> ();
+  b = add_object ('b', 10, &c);
+  a = add_object ('a', 10, &c);
+  add_offset (a, &c);
+  add_offset (b, &c);
+  assert (!c.in_error ());
+  c.end_serialize ();
+  assert (c.in_error ());
+  assert (c.get_memory_usage () < used);
+}
+
+int
+main (int argc, char **argv)
+{
+  test_no_overflow ();
+  test_resolve_by_sorting ();
+  test_resolve_by_duplication ();
+  test_resolve_by_extension_promotion ();
+  test_memory_budget ();
+}
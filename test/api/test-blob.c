@@ -322,6 +322,41 @@ test_blob_subblob (fixture_t *fixture, gconstpointer user_data)
     g_assert ('\0' == data[i]);
 }
 
+static void
+test_blob_from_file_with_flags (void)
+{
+  static const hb_blob_file_flags_t flags[] = {
+    HB_BLOB_FILE_FLAG_POPULATE,
+    HB_BLOB_FILE_FLAG_COPY,
+    HB_BLOB_FILE_FLAG_COPY | HB_BLOB_FILE_FLAG_POPULATE,
+    HB_BLOB_FILE_FLAG_HUGE_PAGES,
+  };
+#if GLIB_CHECK_VERSION(2,37,2)
+  char *path = g_test_build_filename (G_TEST_DIST, "fonts/NotoNastaliqUrdu-Regular.ttf", NULL);
+#else
+  char *path = g_strdup ("fonts/NotoNastaliqUrdu-Regular.ttf");
+#endif
+  hb_blob_t *expected = hb_blob_create_from_file (path);
+  unsigned int expected_len, len, i;
+  const char *expected_data = hb_blob_get_data (expected, &expected_len);
+
+  g_assert_cmpuint (expected_len, >, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (flags); i++)
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_with_flags (path, flags[i]);
+    const char *data = hb_blob_get_data (blob, &len);
+    g_assert_cmpuint (len, ==, expected_len);
+    g_assert (0 == memcmp (data, expected_data, len));
+    hb_blob_destroy (blob);
+  }
+
+  g_assert (hb_blob_create_from_file_with_flags ("does-not-exist.ttf", HB_BLOB_FILE_FLAG_COPY) == hb_blob_get_empty ());
+
+  hb_blob_destroy (expected);
+  g_free (path);
+}
+
 
 int
 main (int argc, char **argv)
@@ -331,6 +366,7 @@ main (int argc, char **argv)
   hb_test_init (&argc, &argv);
 
   hb_test_add (test_blob_empty);
+  hb_test_add (test_blob_from_file_with_flags);
 
   for (i = 0; i < G_N_ELEMENTS (blob_names); i++)
   {
@@ -32,6 +32,7 @@ typedef struct user_data_t
   char *str;
   unsigned size;
   unsigned consumed;
+  hb_position_t dx, dy; /* added to every point */
 } user_data_t;
 
 /* Our modified itoa, why not using libc's? it is going to be used
@@ -100,9 +101,9 @@ move_to (hb_position_t to_x, hb_position_t to_y, user_data_t *user_data)
   /* 4 = command character space + comma + array starts with 0 index + nul character space */
   if (user_data->consumed + 2 * ITOA_BUF_SIZE + 4 > user_data->size) return;
   user_data->str[user_data->consumed++] = 'M';
-  user_data->consumed += _hb_itoa (to_x, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dx + to_x, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ',';
-  user_data->consumed += _hb_itoa (to_y, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dy + to_y, user_data->str + user_data->consumed);
 }
 
 static void
@@ -110,9 +111,9 @@ line_to (hb_position_t to_x, hb_position_t to_y, user_data_t *user_data)
 {
   if (user_data->consumed + 2 * ITOA_BUF_SIZE + 4 > user_data->size) return;
   user_data->str[user_data->consumed++] = 'L';
-  user_data->consumed += _hb_itoa (to_x, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dx + to_x, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ',';
-  user_data->consumed += _hb_itoa (to_y, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dy + to_y, user_data->str + user_data->consumed);
 }
 
 static void
@@ -123,13 +124,13 @@ quadratic_to (hb_position_t control_x, hb_position_t control_y,
 
   if (user_data->consumed + 4 * ITOA_BUF_SIZE + 6 > user_data->size) return;
   user_data->str[user_data->consumed++] = 'Q';
-  user_data->consumed += _hb_itoa (control_x, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dx + control_x, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ',';
-  user_data->consumed += _hb_itoa (control_y, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dy + control_y, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ' ';
-  user_data->consumed += _hb_itoa (to_x, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dx + to_x, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ',';
-  user_data->consumed += _hb_itoa (to_y, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dy + to_y, user_data->str + user_data->consumed);
 }
 
 static void
@@ -140,17 +141,17 @@ cubic_to (hb_position_t control1_x, hb_position_t control1_y,
 {
   if (user_data->consumed + 6 * ITOA_BUF_SIZE + 8 > user_data->size) return;
   user_data->str[user_data->consumed++] = 'C';
-  user_data->consumed += _hb_itoa (control1_x, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dx + control1_x, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ',';
-  user_data->consumed += _hb_itoa (control1_y, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dy + control1_y, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ' ';
-  user_data->consumed += _hb_itoa (control2_x, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dx + control2_x, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ',';
-  user_data->consumed += _hb_itoa (control2_y, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dy + control2_y, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ' ';
-  user_data->consumed += _hb_itoa (to_x, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dx + to_x, user_data->str + user_data->consumed);
   user_data->str[user_data->consumed++] = ',';
-  user_data->consumed += _hb_itoa (to_y, user_data->str + user_data->consumed);
+  user_data->consumed += _hb_itoa (user_data->dy + to_y, user_data->str + user_data->consumed);
 }
 
 static void
@@ -160,6 +161,13 @@ close_path (user_data_t *user_data)
   user_data->str[user_data->consumed++] = 'Z';
 }
 
+static void
+lines_to (const hb_position_t *points, unsigned count, user_data_t *user_data)
+{
+  for (unsigned i = 0; i < count; i++)
+    line_to (points[2 * i], points[2 * i + 1], user_data);
+}
+
 static hb_draw_funcs_t *funcs;
 static hb_draw_funcs_t *funcs2; /* this one translates quadratic calls to cubic ones */
 
@@ -890,6 +898,342 @@ test_hb_draw_stroking (void)
   }
 }
 
+static void
+test_hb_draw_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *cached_font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  char str[1024], expected[1024];
+  user_data_t user_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  user_data_t expected_data = {
+    .str = expected,
+    .size = sizeof (expected)
+  };
+
+  hb_font_set_draw_cache_size (cached_font, 1 << 16);
+
+  g_assert (!hb_font_draw_glyph (cached_font, 4, funcs, &user_data));
+
+  for (unsigned i = 0; i < 2; i++)
+  {
+    hb_draw_funcs_t *f = i ? funcs2 : funcs;
+
+    expected_data.consumed = 0;
+    g_assert (hb_font_draw_glyph (font, 3, f, &expected_data));
+
+    /* First call records, second one replays. */
+    user_data.consumed = 0;
+    g_assert (hb_font_draw_glyph (cached_font, 3, f, &user_data));
+    g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+    user_data.consumed = 0;
+    g_assert (hb_font_draw_glyph (cached_font, 3, f, &user_data));
+    g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+  }
+
+  /* Each instance is cached separately. */
+  hb_variation_t var;
+  var.tag = HB_TAG ('w','g','h','t');
+  var.value = 800;
+  hb_font_set_variations (font, &var, 1);
+  hb_font_set_variations (cached_font, &var, 1);
+
+  expected_data.consumed = 0;
+  g_assert (hb_font_draw_glyph (font, 3, funcs, &expected_data));
+  user_data.consumed = 0;
+  g_assert (hb_font_draw_glyph (cached_font, 3, funcs, &user_data));
+  g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+
+  hb_font_set_scale (font, 2000, 2000);
+  hb_font_set_scale (cached_font, 2000, 2000);
+
+  expected_data.consumed = 0;
+  g_assert (hb_font_draw_glyph (font, 3, funcs, &expected_data));
+  user_data.consumed = 0;
+  g_assert (hb_font_draw_glyph (cached_font, 3, funcs, &user_data));
+  g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+
+  /* A cache too small to hold the glyph still draws it. */
+  hb_font_set_draw_cache_size (cached_font, 1);
+  user_data.consumed = 0;
+  g_assert (hb_font_draw_glyph (cached_font, 3, funcs, &user_data));
+  g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+
+  hb_font_set_draw_cache_size (cached_font, 0);
+  user_data.consumed = 0;
+  g_assert (hb_font_draw_glyph (cached_font, 3, funcs, &user_data));
+  g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+
+  hb_font_destroy (font);
+  hb_font_destroy (cached_font);
+}
+
+/* Checks that outlines and extents served from the face's caches match
+ * those of a face loading each glyph afresh.  The caches are filled at the
+ * default instance; with wght, both fonts are then set to that instance. */
+static void
+check_cached_outlines (const char *font_file, float wght)
+{
+  static char str[8192], expected[8192];
+  user_data_t user_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  user_data_t expected_data = {
+    .str = expected,
+    .size = sizeof (expected)
+  };
+
+  hb_face_t *face = hb_test_open_font_file (font_file);
+  hb_face_t *cold_face = hb_test_open_font_file (font_file);
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *cold_font = hb_font_create (cold_face);
+  unsigned glyph_count = hb_face_get_glyph_count (face);
+  hb_face_destroy (face);
+  hb_face_destroy (cold_face);
+
+  for (unsigned gid = 0; gid < glyph_count; gid++)
+  {
+    hb_glyph_extents_t extents;
+    user_data.consumed = 0;
+    hb_font_draw_glyph (font, gid, funcs, &user_data);
+    hb_font_get_glyph_extents (font, gid, &extents);
+  }
+
+  if (wght)
+  {
+    hb_variation_t var;
+    var.tag = HB_TAG ('w','g','h','t');
+    var.value = wght;
+    hb_font_set_variations (font, &var, 1);
+    hb_font_set_variations (cold_font, &var, 1);
+  }
+
+  /* Go backwards on cold_face, so that components are not cached yet
+   * when the glyphs made of them are loaded. */
+  for (unsigned i = glyph_count; i; i--)
+  {
+    hb_codepoint_t gid = i - 1;
+    hb_glyph_extents_t extents, expected_extents;
+
+    hb_bool_t expected_ret = hb_font_get_glyph_extents (cold_font, gid, &expected_extents);
+    expected_data.consumed = 0;
+    hb_bool_t ret = hb_font_draw_glyph (cold_font, gid, funcs, &expected_data);
+
+    for (unsigned j = 0; j < 2; j++)
+    {
+      user_data.consumed = 0;
+      g_assert_cmpint (hb_font_draw_glyph (font, gid, funcs, &user_data), ==, ret);
+      g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+      g_assert_cmpint (hb_font_get_glyph_extents (font, gid, &extents), ==, expected_ret);
+      if (expected_ret)
+	g_assert_cmpmem (&extents, sizeof (extents), &expected_extents, sizeof (expected_extents));
+    }
+  }
+
+  hb_font_destroy (font);
+  hb_font_destroy (cold_font);
+}
+
+static void
+test_hb_draw_cff_outline_cache (void)
+{
+  const char *font_files[] = {
+    "fonts/cff1_seac.otf",
+    "fonts/cff1_flex.otf",
+    "fonts/SourceSansPro-Regular.otf",
+    "fonts/AdobeVFPrototype.abc.otf",
+    "fonts/AdobeVFPrototype-Subset.otf"
+  };
+
+  for (unsigned f = 0; f < G_N_ELEMENTS (font_files); f++)
+  {
+    check_cached_outlines (font_files[f], 0);
+    /* Non-default CFF2 instances are not cached; check them all the same. */
+    check_cached_outlines (font_files[f], 700);
+  }
+}
+
+static void
+test_hb_draw_glyf_points_cache (void)
+{
+  check_cached_outlines ("fonts/OpenSans-Regular.ttf", 0);
+  check_cached_outlines ("fonts/SourceSansVariable-Roman.modcomp.ttf", 0);
+  check_cached_outlines ("fonts/SourceSansVariable-Roman.modcomp.ttf", 700);
+  check_cached_outlines ("fonts/Estedad-VF.ttf", 0);
+  /* Points cached at the default instance must not be used for others. */
+  check_cached_outlines ("fonts/Estedad-VF.ttf", 100);
+}
+
+static void
+test_hb_draw_glyphs (void)
+{
+  const char *font_files[] = {
+    "fonts/SourceSerifVariable-Roman-VVAR.abc.ttf",
+    "fonts/Estedad-VF.ttf",
+    "fonts/cff1_seac.otf",
+    "fonts/AdobeVFPrototype.abc.otf"
+  };
+  char str[8192], expected[8192];
+  user_data_t user_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  user_data_t expected_data = {
+    .str = expected,
+    .size = sizeof (expected)
+  };
+
+  for (unsigned f = 0; f < G_N_ELEMENTS (font_files); f++)
+  {
+    hb_face_t *face = hb_test_open_font_file (font_files[f]);
+    hb_font_t *font = hb_font_create (face);
+    unsigned glyph_count = hb_face_get_glyph_count (face);
+    hb_face_destroy (face);
+
+    hb_variation_t var;
+    var.tag = HB_TAG ('w','g','h','t');
+    var.value = 700;
+    hb_font_set_variations (font, &var, 1);
+
+    hb_glyph_info_t infos[5];
+    hb_position_t xs[5], ys[5];
+    unsigned count = G_N_ELEMENTS (infos);
+    for (unsigned i = 0; i < count; i++)
+    {
+      infos[i].codepoint = (i + 1) % glyph_count;
+      xs[i] = 1000 * i - 1001;
+      ys[i] = -33 * i;
+    }
+
+    for (unsigned cached = 0; cached < 3; cached++)
+    {
+      if (cached == 1)
+	hb_font_set_draw_cache_size (font, 1 << 16);
+
+      for (unsigned i = 0; i < 2; i++)
+      {
+	hb_draw_funcs_t *fs = i ? funcs2 : funcs;
+
+	expected_data.consumed = 0;
+	for (unsigned j = 0; j < count; j++)
+	{
+	  expected_data.dx = xs[j];
+	  expected_data.dy = ys[j];
+	  hb_font_draw_glyph (font, infos[j].codepoint, fs, &expected_data);
+	}
+
+	user_data.consumed = 0;
+	g_assert (hb_font_draw_glyphs (font, count,
+				       &infos[0].codepoint, sizeof (infos[0]),
+				       xs, sizeof (xs[0]),
+				       ys, sizeof (ys[0]),
+				       fs, &user_data));
+	g_assert_cmpuint (user_data.consumed, !=, 0);
+	g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+      }
+    }
+
+    /* Out-of-range glyphs are skipped. */
+    hb_codepoint_t glyphs[2] = {1, 65000};
+    hb_position_t zero = 0;
+    user_data.consumed = 0;
+    g_assert (!hb_font_draw_glyphs (font, 2, glyphs, sizeof (glyphs[0]),
+				    &zero, 0, &zero, 0, funcs, &user_data));
+    expected_data.consumed = 0;
+    expected_data.dx = expected_data.dy = 0;
+    g_assert (hb_font_draw_glyph (font, 1, funcs, &expected_data));
+    g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+
+    hb_font_destroy (font);
+  }
+}
+
+static unsigned
+count_chars (const char *str, unsigned len, char c)
+{
+  unsigned n = 0;
+  for (unsigned i = 0; i < len; i++)
+    n += str[i] == c;
+  return n;
+}
+
+static void
+test_hb_draw_flatten (void)
+{
+  const char *font_files[] = {
+    "fonts/SourceSerifVariable-Roman-VVAR.abc.ttf",
+    "fonts/cff1_flex.otf",
+    "fonts/AdobeVFPrototype.abc.otf"
+  };
+  char str[8192], expected[8192];
+  user_data_t user_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  user_data_t expected_data = {
+    .str = expected,
+    .size = sizeof (expected)
+  };
+
+  hb_draw_funcs_t *flat_funcs = hb_draw_funcs_create ();
+  hb_draw_funcs_set_move_to_func (flat_funcs, (hb_draw_move_to_func_t) move_to);
+  hb_draw_funcs_set_line_to_func (flat_funcs, (hb_draw_line_to_func_t) line_to);
+  hb_draw_funcs_set_close_path_func (flat_funcs, (hb_draw_close_path_func_t) close_path);
+  hb_draw_funcs_set_flatten_tolerance (flat_funcs, .5f);
+
+  hb_draw_funcs_t *batch_funcs = hb_draw_funcs_create ();
+  hb_draw_funcs_set_move_to_func (batch_funcs, (hb_draw_move_to_func_t) move_to);
+  hb_draw_funcs_set_lines_to_func (batch_funcs, (hb_draw_lines_to_func_t) lines_to);
+  hb_draw_funcs_set_close_path_func (batch_funcs, (hb_draw_close_path_func_t) close_path);
+  hb_draw_funcs_set_flatten_tolerance (batch_funcs, .5f);
+
+  for (unsigned f = 0; f < G_N_ELEMENTS (font_files); f++)
+  {
+    hb_face_t *face = hb_test_open_font_file (font_files[f]);
+    hb_font_t *font = hb_font_create (face);
+    hb_face_destroy (face);
+
+    for (unsigned cached = 0; cached < 2; cached++)
+    {
+      if (cached)
+	hb_font_set_draw_cache_size (font, 1 << 16);
+
+      expected_data.consumed = 0;
+      g_assert (hb_font_draw_glyph (font, 1, funcs, &expected_data));
+      g_assert_cmpuint (count_chars (expected, expected_data.consumed, 'Q') +
+			count_chars (expected, expected_data.consumed, 'C'), !=, 0);
+
+      /* Curves become lines, contours stay as they were. */
+      user_data.consumed = 0;
+      g_assert (hb_font_draw_glyph (font, 1, flat_funcs, &user_data));
+      g_assert_cmpuint (count_chars (str, user_data.consumed, 'Q'), ==, 0);
+      g_assert_cmpuint (count_chars (str, user_data.consumed, 'C'), ==, 0);
+      g_assert_cmpuint (count_chars (str, user_data.consumed, 'L'), >,
+			count_chars (expected, expected_data.consumed, 'L'));
+      g_assert_cmpuint (count_chars (str, user_data.consumed, 'M'), ==,
+			count_chars (expected, expected_data.consumed, 'M'));
+      g_assert_cmpuint (count_chars (str, user_data.consumed, 'Z'), ==,
+			count_chars (expected, expected_data.consumed, 'Z'));
+
+      /* Batched lines are the same lines. */
+      expected_data.consumed = 0;
+      g_assert (hb_font_draw_glyph (font, 1, batch_funcs, &expected_data));
+      g_assert_cmpmem (str, user_data.consumed, expected, expected_data.consumed);
+    }
+
+    hb_font_destroy (font);
+  }
+
+  hb_draw_funcs_destroy (flat_funcs);
+  hb_draw_funcs_destroy (batch_funcs);
+}
+
 static void
 test_hb_draw_immutable (void)
 {
@@ -930,6 +1274,11 @@ main (int argc, char **argv)
   hb_test_add (test_hb_draw_font_kit_variations_tests);
   hb_test_add (test_hb_draw_estedad_vf);
   hb_test_add (test_hb_draw_stroking);
+  hb_test_add (test_hb_draw_cache);
+  hb_test_add (test_hb_draw_cff_outline_cache);
+  hb_test_add (test_hb_draw_glyf_points_cache);
+  hb_test_add (test_hb_draw_glyphs);
+  hb_test_add (test_hb_draw_flatten);
   hb_test_add (test_hb_draw_immutable);
   unsigned result = hb_test_run ();
 
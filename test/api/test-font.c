@@ -598,6 +598,34 @@ test_font_properties (void)
   hb_font_destroy (subfont);
 }
 
+static void
+test_font_memory_usage (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansVariable-Roman.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_memory_usage_t usage[4];
+  unsigned int count = G_N_ELEMENTS (usage);
+  unsigned int total;
+  int coords[1] = {8192};
+
+  g_assert_cmpuint (hb_font_get_memory_usage (hb_font_get_empty (), 0, &count, usage), ==, 0);
+  g_assert_cmpuint (count, ==, 0);
+
+  count = G_N_ELEMENTS (usage);
+  total = hb_font_get_memory_usage (font, 0, &count, usage);
+  g_assert_cmpuint (total, >, 0);
+  g_assert_cmpuint (count, ==, 1);
+  g_assert_cmpuint (usage[0].tag, ==, HB_MEMORY_USAGE_TAG_OBJECT);
+  g_assert_cmpuint (usage[0].bytes, ==, total);
+
+  /* Variation coordinates are held by the font. */
+  hb_font_set_var_coords_normalized (font, coords, 1);
+  g_assert_cmpuint (hb_font_get_memory_usage (font, 0, NULL, NULL), >, total);
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -614,6 +642,7 @@ main (int argc, char **argv)
 
   hb_test_add (test_font_empty);
   hb_test_add (test_font_properties);
+  hb_test_add (test_font_memory_usage);
 
   return hb_test_run();
 }
@@ -232,6 +232,7 @@ test_object (void)
     const object_t *o = &objects[i];
     void *obj;
     hb_user_data_key_t key[1001];
+    hb_user_data_key_t more_keys[3000];
 
     {
       unsigned int j;
@@ -297,6 +298,30 @@ test_object (void)
       for (j = 100; j < 1000; j++)
 	g_assert (!o->get_user_data (obj, &key[j]));
       g_assert_cmpuint (global_data, ==, 900);
+      g_assert (o->set_user_data (obj, &key[100], &data[100], NULL, FALSE));
+      g_assert (o->get_user_data (obj, &key[100]) == &data[100]);
+      g_assert (!o->set_user_data (obj, &key[100], &data[101], NULL, FALSE));
+      g_assert (o->set_user_data (obj, &key[100], NULL, NULL, TRUE));
+      g_assert (!o->get_user_data (obj, &key[100]));
+
+      /* Remove a key, grow the array a few times past it, and set it again. */
+      g_assert (o->set_user_data (obj, &key[2], NULL, NULL, TRUE));
+      g_assert_cmpuint (global_data, ==, 901);
+      for (j = 0; j < G_N_ELEMENTS (more_keys); j++)
+	g_assert (o->set_user_data (obj, &more_keys[j], &data[j % 1000], NULL, TRUE));
+      g_assert (!o->get_user_data (obj, &key[2]));
+      g_assert (o->set_user_data (obj, &key[2], &data[2], NULL, TRUE));
+      g_assert (o->get_user_data (obj, &key[2]) == &data[2]);
+      for (j = 3; j < 100; j++)
+	g_assert (o->get_user_data (obj, &key[j]) == &data[j]);
+      for (j = 100; j < 1000; j++)
+	g_assert (!o->get_user_data (obj, &key[j]));
+      for (j = 0; j < G_N_ELEMENTS (more_keys); j++)
+	g_assert (o->get_user_data (obj, &more_keys[j]) == &data[j % 1000]);
+      /* Items moved to a new array still update in place. */
+      g_assert (o->set_user_data (obj, &more_keys[0], &data[1], NULL, TRUE));
+      g_assert (o->get_user_data (obj, &more_keys[0]) == &data[1]);
+      g_assert_cmpuint (global_data, ==, 901);
 
       /* Test set_user_data where the destroy() func calls user_data functions.
        * Make sure it doesn't deadlock or corrupt memory. */
@@ -189,6 +189,501 @@ test_ot_var_axis_on_zero_named_instance (void)
   hb_face_destroy (face);
 }
 
+static void
+_shape_and_look_up_names (hb_face_t *face, GString *out)
+{
+  hb_font_t *font = hb_font_create (face);
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_glyph_info_t *infos;
+  hb_glyph_position_t *positions;
+  unsigned int count, i;
+
+  hb_buffer_add_utf8 (buffer, "\xd8\xa8\xd8\xb3\xd9\x85 \xd8\xa7\xd9\x84\xd9\x84\xd9\x87", -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_shape (font, buffer, NULL, 0);
+  infos = hb_buffer_get_glyph_infos (buffer, &count);
+  positions = hb_buffer_get_glyph_positions (buffer, &count);
+  for (i = 0; i < count; i++)
+    g_string_append_printf (out, "%u@%d,%d+%d ", infos[i].codepoint,
+			    positions[i].x_offset, positions[i].y_offset,
+			    positions[i].x_advance);
+
+  for (i = 0; i < 100; i++)
+  {
+    char name[64];
+    hb_codepoint_t glyph;
+    g_assert (hb_font_get_glyph_name (font, i, name, sizeof (name)));
+    g_assert (hb_font_get_glyph_from_name (font, name, -1, &glyph));
+    g_string_append_printf (out, "%s=%u ", name, glyph);
+  }
+
+  hb_buffer_destroy (buffer);
+  hb_font_destroy (font);
+}
+
+/* Asserts that face shapes and names glyphs just like reference. */
+static void
+_assert_same_output (hb_face_t *reference, hb_face_t *face)
+{
+  GString *expected = g_string_new (NULL);
+  GString *actual = g_string_new (NULL);
+
+  _shape_and_look_up_names (reference, expected);
+  _shape_and_look_up_names (face, actual);
+  g_assert_cmpstr (actual->str, ==, expected->str);
+
+  g_string_free (expected, TRUE);
+  g_string_free (actual, TRUE);
+}
+
+static void
+test_ot_face_accelerator_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_face_t *other = hb_test_open_font_file ("fonts/Mplus1p-Regular.ttf");
+  hb_face_t *cached;
+  hb_blob_t *cache, *other_cache, *corrupted;
+  char *data;
+  unsigned int length;
+
+  cache = hb_face_reference_accelerator_cache (face);
+  g_assert_cmpuint (hb_blob_get_length (cache), >, 0);
+
+  cached = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  g_assert (hb_face_set_accelerator_cache (cached, cache));
+  _assert_same_output (face, cached);
+  /* Too late once the face is in use. */
+  g_assert (!hb_face_set_accelerator_cache (cached, cache));
+  hb_face_destroy (cached);
+
+  /* A face takes one cache only, even while still mutable. */
+  other_cache = hb_face_reference_accelerator_cache (other);
+  cached = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  g_assert (hb_face_set_accelerator_cache (cached, cache));
+  g_assert (!hb_face_set_accelerator_cache (cached, other_cache));
+  g_assert (!hb_face_set_accelerator_cache (cached, cache));
+  g_assert (!hb_face_is_immutable (cached));
+  hb_face_destroy (cached);
+
+  /* A cache for another font is accepted, but not used. */
+  cached = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  g_assert (hb_face_set_accelerator_cache (cached, other_cache));
+  _assert_same_output (face, cached);
+  hb_face_destroy (cached);
+
+  /* Corrupted data is not used either. */
+  data = (char *) hb_blob_get_data (cache, &length);
+  data = (char *) g_memdup (data, length);
+  data[length - 1] ^= 0x5A;
+  data[length / 2] ^= 0x5A;
+  corrupted = hb_blob_create (data, length, HB_MEMORY_MODE_WRITABLE, data, g_free);
+  cached = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  g_assert (hb_face_set_accelerator_cache (cached, corrupted));
+  _assert_same_output (face, cached);
+  hb_face_destroy (cached);
+  hb_blob_destroy (corrupted);
+
+  /* Anything but a cache is rejected. */
+  cached = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  g_assert (!hb_face_set_accelerator_cache (cached, hb_blob_get_empty ()));
+  corrupted = hb_blob_create_sub_blob (cache, 0, 20);
+  g_assert (!hb_face_set_accelerator_cache (cached, corrupted));
+  hb_blob_destroy (corrupted);
+  corrupted = hb_face_reference_blob (face);
+  g_assert (!hb_face_set_accelerator_cache (cached, corrupted));
+  hb_blob_destroy (corrupted);
+  /* Neither is one from a build that digests glyphs differently. */
+  data = (char *) hb_blob_get_data (cache, &length);
+  data = (char *) g_memdup (data, length);
+  data[16] ^= 0x01;
+  corrupted = hb_blob_create (data, length, HB_MEMORY_MODE_WRITABLE, data, g_free);
+  g_assert (!hb_face_set_accelerator_cache (cached, corrupted));
+  hb_blob_destroy (corrupted);
+  hb_face_destroy (cached);
+
+  hb_blob_destroy (other_cache);
+  hb_blob_destroy (cache);
+  hb_face_destroy (other);
+  hb_face_destroy (face);
+}
+
+static hb_face_t *
+_open_tampered_font (const char *path, hb_tag_t tag, unsigned int offset)
+{
+  hb_face_t *face = hb_test_open_font_file (path);
+  hb_blob_t *blob = hb_face_reference_blob (face);
+  hb_blob_t *table = hb_face_reference_table (face, tag);
+  unsigned int length;
+  const char *font_data = hb_blob_get_data (blob, &length);
+  char *data = (char *) g_memdup (font_data, length);
+
+  g_assert_cmpuint (hb_blob_get_length (table), >, offset + 1);
+  offset += hb_blob_get_data (table, NULL) - font_data;
+  data[offset] = data[offset + 1] = (char) 0xFF;
+
+  hb_blob_destroy (table);
+  hb_blob_destroy (blob);
+  hb_face_destroy (face);
+
+  blob = hb_blob_create (data, length, HB_MEMORY_MODE_WRITABLE, data, g_free);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static void
+test_ot_face_trusted_accelerator_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_face_t *cached, *tampered;
+  hb_blob_t *cache;
+
+  cache = hb_face_reference_accelerator_cache (face);
+
+  cached = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  g_assert (hb_face_set_trusted_accelerator_cache (cached, cache));
+  _assert_same_output (face, cached);
+  g_assert_cmpuint (hb_ot_layout_table_get_lookup_count (cached, HB_OT_TAG_GSUB), ==,
+		    hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB));
+  g_assert (!hb_face_set_trusted_accelerator_cache (cached, cache));
+  hb_face_destroy (cached);
+
+  /* A table that changed since is sanitized; here the LookupList offset
+   * points out of the table and gets neutered. */
+  tampered = _open_tampered_font ("fonts/NotoNastaliqUrdu-Regular.ttf", HB_OT_TAG_GSUB, 8);
+  g_assert_cmpuint (hb_ot_layout_table_get_lookup_count (tampered, HB_OT_TAG_GSUB), ==, 0);
+
+  cached = _open_tampered_font ("fonts/NotoNastaliqUrdu-Regular.ttf", HB_OT_TAG_GSUB, 8);
+  g_assert (hb_face_set_trusted_accelerator_cache (cached, cache));
+  g_assert_cmpuint (hb_ot_layout_table_get_lookup_count (cached, HB_OT_TAG_GSUB), ==, 0);
+  _assert_same_output (tampered, cached);
+  hb_face_destroy (cached);
+  hb_face_destroy (tampered);
+
+  hb_blob_destroy (cache);
+  hb_face_destroy (face);
+}
+
+static unsigned int
+_get_uint16 (hb_blob_t *blob, unsigned int offset)
+{
+  const unsigned char *data = (const unsigned char *) hb_blob_get_data (blob, NULL);
+  g_assert_cmpuint (hb_blob_get_length (blob), >=, offset + 2);
+  return (data[offset] << 8) | data[offset + 1];
+}
+
+static unsigned int
+_shape_fi (hb_face_t *face)
+{
+  hb_font_t *font = hb_font_create (face);
+  hb_buffer_t *buffer = hb_buffer_create ();
+  unsigned int length;
+
+  hb_buffer_add_utf8 (buffer, "fi", -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_shape (font, buffer, NULL, 0);
+  length = hb_buffer_get_length (buffer);
+
+  hb_buffer_destroy (buffer);
+  hb_font_destroy (font);
+  return length;
+}
+
+static void
+test_ot_face_lazy_sanitize (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.gsub.fi.ttf");
+  hb_face_t *tampered;
+  hb_blob_t *gsub = hb_face_reference_table (face, HB_OT_TAG_GSUB);
+  hb_set_t *glyphs = hb_set_create ();
+  unsigned int lookup_list, lookup;
+
+  g_assert_cmpuint (_shape_fi (face), ==, 1);
+  hb_ot_layout_lookup_collect_glyphs (face, HB_OT_TAG_GSUB, 0, NULL, glyphs, NULL, NULL);
+  g_assert (!hb_set_is_empty (glyphs));
+
+  /* Point the first subtable of the first lookup out of the table.  The
+   * lookup is only sanitized when used, and can't be edited in place by
+   * then; it must still come out neutered. */
+  lookup_list = _get_uint16 (gsub, 8);
+  lookup = lookup_list + _get_uint16 (gsub, lookup_list + 2);
+  tampered = _open_tampered_font ("fonts/Roboto-Regular.gsub.fi.ttf", HB_OT_TAG_GSUB, lookup + 6);
+  g_assert_cmpuint (hb_ot_layout_table_get_lookup_count (tampered, HB_OT_TAG_GSUB), ==,
+		    hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB));
+  g_assert_cmpuint (_shape_fi (tampered), ==, 2);
+  hb_set_clear (glyphs);
+  hb_ot_layout_lookup_collect_glyphs (tampered, HB_OT_TAG_GSUB, 0, NULL, glyphs, NULL, NULL);
+  g_assert (hb_set_is_empty (glyphs));
+  hb_face_destroy (tampered);
+
+  hb_set_destroy (glyphs);
+  hb_blob_destroy (gsub);
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_face_table_directory (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.gsub.fi.ttf");
+  hb_blob_t *blob = hb_face_reference_blob (face);
+  hb_face_t *unsorted, *other;
+  hb_tag_t tags[64];
+  unsigned int count = G_N_ELEMENTS (tags);
+  unsigned int length, last, i;
+  const char *font_data = hb_blob_get_data (blob, &length);
+  char *data = (char *) g_memdup (font_data, length);
+  char record[16];
+
+  /* Swap the first and last table records, so the directory is no longer
+   * sorted by tag; all tables must still be found. */
+  hb_face_get_table_tags (face, 0, &count, tags);
+  g_assert_cmpuint (count, >, 1);
+  last = 12 + 16 * (count - 1);
+  memcpy (record, data + 12, 16);
+  memcpy (data + 12, data + last, 16);
+  memcpy (data + last, record, 16);
+  hb_blob_destroy (blob);
+  blob = hb_blob_create (data, length, HB_MEMORY_MODE_WRITABLE, data, g_free);
+  unsorted = hb_face_create (blob, 0);
+  other = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+
+  for (i = 0; i < count; i++)
+  {
+    hb_blob_t *expected = hb_face_reference_table (face, tags[i]);
+    hb_blob_t *actual = hb_face_reference_table (unsorted, tags[i]);
+    hb_blob_t *shared = hb_face_reference_table (other, tags[i]);
+    g_assert_cmpuint (hb_blob_get_length (actual), ==, hb_blob_get_length (expected));
+    g_assert (!memcmp (hb_blob_get_data (actual, NULL),
+		       hb_blob_get_data (expected, NULL),
+		       hb_blob_get_length (expected)));
+    g_assert (hb_blob_get_data (shared, NULL) == hb_blob_get_data (actual, NULL));
+    hb_blob_destroy (shared);
+    hb_blob_destroy (actual);
+    hb_blob_destroy (expected);
+  }
+  blob = hb_face_reference_table (unsorted, HB_TAG ('z','z','z','z'));
+  g_assert_cmpuint (hb_blob_get_length (blob), ==, 0);
+  hb_blob_destroy (blob);
+
+  /* Faces made from the same blob share the tables they sanitized. */
+  g_assert_cmpuint (_shape_fi (unsorted), ==, 1);
+  g_assert_cmpuint (_shape_fi (other), ==, 1);
+
+  hb_face_destroy (other);
+  hb_face_destroy (unsorted);
+  hb_face_destroy (face);
+}
+
+static unsigned int
+_get_memory_usage (hb_face_t *face, hb_tag_t tag)
+{
+  hb_memory_usage_t usage[64];
+  unsigned int count = G_N_ELEMENTS (usage);
+  unsigned int total = hb_face_get_memory_usage (face, 0, &count, usage);
+  unsigned int sum = 0, bytes = 0, i;
+
+  g_assert_cmpuint (count, <, G_N_ELEMENTS (usage));
+  for (i = 0; i < count; i++)
+  {
+    sum += usage[i].bytes;
+    if (usage[i].tag == tag)
+      bytes = usage[i].bytes;
+  }
+  g_assert_cmpuint (sum, ==, total);
+  return bytes;
+}
+
+static void
+test_ot_face_memory_usage (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_face_t *reference = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_memory_usage_t usage;
+  unsigned int count = 1;
+  unsigned int total;
+
+  g_assert_cmpuint (hb_face_get_memory_usage (hb_face_get_empty (), 0, &count, &usage), ==, 0);
+  g_assert_cmpuint (count, ==, 0);
+
+  total = hb_face_get_memory_usage (face, 0, NULL, NULL);
+  g_assert_cmpuint (total, >, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), ==, 0);
+
+  _assert_same_output (reference, face);
+  g_assert_cmpuint (hb_face_get_memory_usage (face, 0, NULL, NULL), >, total);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), >, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_TAG ('p','o','s','t')), >, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_MEMORY_USAGE_TAG_SHAPE_PLANS), >, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_MEMORY_USAGE_TAG_OBJECT), >, 0);
+
+  count = 1;
+  hb_face_get_memory_usage (face, 1000, &count, &usage);
+  g_assert_cmpuint (count, ==, 0);
+
+  /* Dropped accelerators are rebuilt on demand. */
+  hb_face_drop_accelerators (face);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), ==, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_MEMORY_USAGE_TAG_SHAPE_PLANS), ==, 0);
+  _assert_same_output (reference, face);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), >, 0);
+
+  hb_face_destroy (reference);
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_face_trim (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_face_t *reference = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_font_t *font;
+  hb_codepoint_t glyph;
+  unsigned int generation, total;
+
+  g_assert_cmpuint (hb_face_trim (hb_face_get_empty (), 0), ==, 0);
+
+  _assert_same_output (reference, face);
+  total = hb_face_get_memory_usage (face, 0, NULL, NULL);
+
+  /* Nothing goes at first. */
+  generation = hb_face_trim (face, 0);
+  g_assert_cmpuint (hb_face_get_memory_usage (face, 0, NULL, NULL), ==, total);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), >, 0);
+
+  /* Then what was not used since. */
+  font = hb_font_create (face);
+  g_assert (hb_font_get_nominal_glyph (font, 0x0628, &glyph));
+  hb_font_destroy (font);
+  generation = hb_face_trim (face, generation);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), ==, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_TAG ('p','o','s','t')), ==, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_TAG ('c','m','a','p')), >, 0);
+
+  /* And is loaded again when needed. */
+  _assert_same_output (reference, face);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), >, 0);
+  generation = hb_face_trim (face, generation);
+  g_assert_cmpuint (_get_memory_usage (face, HB_OT_TAG_GSUB), >, 0);
+
+  hb_face_destroy (reference);
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_face_trim_glyf (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansVariable-Roman.modcomp.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *bold = hb_font_create (face);
+  hb_variation_t wght = {HB_TAG ('w','g','h','t'), 700};
+  hb_glyph_extents_t expected, extents;
+  unsigned int generation, i;
+
+  hb_font_set_variations (bold, &wght, 1);
+  g_assert (hb_font_get_glyph_extents (bold, 1, &expected));
+
+  /* At the default instance, glyf reads hmtx but not gvar or vmtx, so
+   * these go while glyf stays. */
+  generation = hb_face_trim (face, 0);
+  for (i = 0; i < 2; i++)
+  {
+    g_assert (hb_font_get_glyph_extents (font, 1, &extents));
+    generation = hb_face_trim (face, generation);
+  }
+  g_assert_cmpuint (_get_memory_usage (face, HB_TAG ('g','l','y','f')), >, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_TAG ('g','v','a','r')), ==, 0);
+  g_assert_cmpuint (_get_memory_usage (face, HB_TAG ('v','m','t','x')), ==, 0);
+
+  /* Which glyf then loads again to apply variations. */
+  g_assert (hb_font_get_glyph_extents (bold, 1, &extents));
+  g_assert_cmpint (extents.x_bearing, ==, expected.x_bearing);
+  g_assert_cmpint (extents.y_bearing, ==, expected.y_bearing);
+  g_assert_cmpint (extents.width, ==, expected.width);
+  g_assert_cmpint (extents.height, ==, expected.height);
+  g_assert_cmpuint (_get_memory_usage (face, HB_TAG ('g','v','a','r')), >, 0);
+
+  hb_font_destroy (bold);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_face_paging_hints (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_face_t *reference = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+
+  _assert_same_output (reference, face);
+  hb_face_drop_accelerators (face);
+
+  /* Hints only change how pages come in, never what is read. */
+  hb_face_advise_tables (face);
+  hb_face_prefault_tables (face);
+  hb_face_prefault_tables_async (face);
+  _assert_same_output (reference, face);
+
+  hb_face_advise_tables (hb_face_get_empty ());
+  hb_face_prefault_tables (hb_face_get_empty ());
+  g_assert (!hb_face_prefault_tables_async (hb_face_get_empty ()));
+
+  hb_face_destroy (reference);
+  hb_face_destroy (face);
+}
+
+static void
+_set_true (void *data)
+{
+  *(hb_bool_t *) data = TRUE;
+}
+
+static void
+test_ot_face_shared (void)
+{
+  static hb_user_data_key_t key;
+#if GLIB_CHECK_VERSION(2,37,2)
+  char *path = g_test_build_filename (G_TEST_DIST, "fonts/NotoNastaliqUrdu-Regular.ttf", NULL);
+#else
+  char *path = g_strdup ("fonts/NotoNastaliqUrdu-Regular.ttf");
+#endif
+  hb_bool_t freed = FALSE;
+  hb_face_t *face, *again, *other;
+  hb_blob_t *blob, *other_blob;
+
+  face = hb_face_create_shared_from_file (path, 0);
+  g_assert (hb_face_is_immutable (face));
+  g_assert_cmpuint (hb_face_get_glyph_count (face), >, 0);
+  hb_face_set_user_data (face, &key, &freed, _set_true, TRUE);
+
+  again = hb_face_create_shared_from_file (path, 0);
+  g_assert (again == face);
+
+  /* Another index of the same file shares the blob. */
+  other = hb_face_create_shared_from_file (path, 1);
+  g_assert (other != face);
+  blob = hb_face_reference_blob (face);
+  other_blob = hb_face_reference_blob (other);
+  g_assert (blob == other_blob);
+  hb_blob_destroy (blob);
+  hb_blob_destroy (other_blob);
+  hb_face_destroy (other);
+
+  hb_face_destroy (again);
+  g_assert (!freed);
+  hb_face_destroy (face);
+  g_assert (freed);
+
+  /* Evicted; a fresh face is made next time. */
+  face = hb_face_create_shared_from_file (path, 0);
+  g_assert (!hb_face_get_user_data (face, &key));
+  hb_face_destroy (face);
+
+  face = hb_face_create_shared_from_file ("does-not-exist.ttf", 0);
+  g_assert (face == hb_face_get_empty ());
+
+  g_free (path);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -196,6 +691,15 @@ main (int argc, char **argv)
 
   hb_test_add (test_ot_face_empty);
   hb_test_add (test_ot_var_axis_on_zero_named_instance);
+  hb_test_add (test_ot_face_accelerator_cache);
+  hb_test_add (test_ot_face_trusted_accelerator_cache);
+  hb_test_add (test_ot_face_lazy_sanitize);
+  hb_test_add (test_ot_face_table_directory);
+  hb_test_add (test_ot_face_memory_usage);
+  hb_test_add (test_ot_face_trim);
+  hb_test_add (test_ot_face_trim_glyf);
+  hb_test_add (test_ot_face_paging_hints);
+  hb_test_add (test_ot_face_shared);
 
   return hb_test_run();
 }
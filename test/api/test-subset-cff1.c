@@ -336,6 +336,59 @@ test_subset_cff1_j_retaingids (void)
   hb_face_destroy (face_41_4c2e);
 }
 
+static void
+test_subset_cff1_resubr (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansPro-Regular.otf");
+  hb_face_t *face_desubr, *face_resubr;
+  hb_font_t *font_desubr, *font_resubr;
+  hb_blob_t *cff_desubr, *cff_resubr;
+  hb_subset_input_t *input;
+  hb_set_t *codepoints = hb_set_create ();
+  unsigned int num_glyphs, gid;
+
+  hb_set_add_range (codepoints, 'A', 'Z');
+  hb_set_add_range (codepoints, 'a', 'z');
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_desubroutinize (input, true);
+  face_desubr = hb_subset_test_create_subset (face, input);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_resubroutinize (input, true);
+  face_resubr = hb_subset_test_create_subset (face, input);
+  hb_set_destroy (codepoints);
+
+  cff_desubr = hb_face_reference_table (face_desubr, HB_TAG ('C','F','F',' '));
+  cff_resubr = hb_face_reference_table (face_resubr, HB_TAG ('C','F','F',' '));
+  g_assert_cmpuint (hb_blob_get_length (cff_resubr), >, 0);
+  g_assert_cmpuint (hb_blob_get_length (cff_resubr), <, hb_blob_get_length (cff_desubr));
+
+  /* Same outlines either way. */
+  font_desubr = hb_font_create (face_desubr);
+  font_resubr = hb_font_create (face_resubr);
+  num_glyphs = hb_face_get_glyph_count (face_desubr);
+  g_assert_cmpuint (num_glyphs, ==, hb_face_get_glyph_count (face_resubr));
+  for (gid = 0; gid < num_glyphs; gid++)
+  {
+    hb_glyph_extents_t extents_desubr, extents_resubr;
+    g_assert (hb_font_get_glyph_extents (font_desubr, gid, &extents_desubr));
+    g_assert (hb_font_get_glyph_extents (font_resubr, gid, &extents_resubr));
+    g_assert_cmpint (extents_desubr.x_bearing, ==, extents_resubr.x_bearing);
+    g_assert_cmpint (extents_desubr.y_bearing, ==, extents_resubr.y_bearing);
+    g_assert_cmpint (extents_desubr.width, ==, extents_resubr.width);
+    g_assert_cmpint (extents_desubr.height, ==, extents_resubr.height);
+  }
+
+  hb_font_destroy (font_desubr);
+  hb_font_destroy (font_resubr);
+  hb_blob_destroy (cff_desubr);
+  hb_blob_destroy (cff_resubr);
+  hb_face_destroy (face_desubr);
+  hb_face_destroy (face_resubr);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -355,6 +408,7 @@ main (int argc, char **argv)
   hb_test_add (test_subset_cff1_dotsection);
   hb_test_add (test_subset_cff1_retaingids);
   hb_test_add (test_subset_cff1_j_retaingids);
+  hb_test_add (test_subset_cff1_resubr);
 
   return hb_test_run ();
 }
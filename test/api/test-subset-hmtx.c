@@ -150,6 +150,38 @@ test_subset_hmtx_noop (void)
   hb_face_destroy (face_abc);
 }
 
+static void
+test_subset_hmtx_grow_buffer (void)
+{
+  /* Keeping the last glyph only, with its glyph id, makes hmtx about as long
+   * as the source's, while its buffer is first sized for two glyphs out of
+   * 938.  The output must match that of subsetting without growing. */
+  hb_face_t *face = hb_test_open_font_file ("fonts/OpenSans-Regular.ttf");
+  hb_face_t *expected = hb_test_open_font_file ("fonts/OpenSans-Regular.gid937.retaingids.ttf");
+  hb_face_t *subset;
+  hb_blob_t *expected_blob, *subset_blob;
+
+  hb_set_t *glyphs = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_set_add (glyphs, 937);
+  input = hb_subset_test_create_input_from_glyphs (glyphs);
+  hb_subset_input_set_retain_gids (input, true);
+  subset = hb_subset_test_create_subset (face, input);
+  hb_set_destroy (glyphs);
+
+  check_num_hmetrics (subset, 938);
+  hb_subset_test_check (expected, subset, HB_TAG ('h','m','t','x'));
+  expected_blob = hb_face_reference_blob (expected);
+  subset_blob = hb_face_reference_blob (subset);
+  hb_test_assert_blobs_equal (expected_blob, subset_blob);
+
+  hb_blob_destroy (expected_blob);
+  hb_blob_destroy (subset_blob);
+  hb_face_destroy (subset);
+  hb_face_destroy (expected);
+  hb_face_destroy (face);
+}
+
 static void
 test_subset_invalid_hmtx (void)
 {
@@ -181,6 +213,7 @@ main (int argc, char **argv)
   hb_test_add (test_subset_hmtx_keep_num_metrics);
   hb_test_add (test_subset_hmtx_decrease_num_metrics);
   hb_test_add (test_subset_hmtx_noop);
+  hb_test_add (test_subset_hmtx_grow_buffer);
   hb_test_add (test_subset_invalid_hmtx);
 
   return hb_test_run();
@@ -95,6 +95,314 @@ test_subset_crash (void)
   hb_face_destroy (face);
 }
 
+static void
+test_subset_num_threads (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_face_t *serial, *parallel;
+  hb_blob_t *serial_blob, *parallel_blob;
+
+  hb_set_add (codepoints, 'a');
+  hb_set_add (codepoints, 'c');
+
+  input = hb_subset_test_create_input (codepoints);
+  g_assert_cmpuint (hb_subset_input_get_num_threads (input), ==, 1);
+  serial = hb_subset_test_create_subset (face, input);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_num_threads (input, 4);
+  g_assert_cmpuint (hb_subset_input_get_num_threads (input), ==, 4);
+  parallel = hb_subset_test_create_subset (face, input);
+
+  serial_blob = hb_face_reference_blob (serial);
+  parallel_blob = hb_face_reference_blob (parallel);
+  hb_test_assert_blobs_equal (serial_blob, parallel_blob);
+
+  hb_blob_destroy (serial_blob);
+  hb_blob_destroy (parallel_blob);
+  hb_face_destroy (serial);
+  hb_face_destroy (parallel);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (face);
+}
+
+static void
+test_subset_dedup_budget (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Inconsolata-Regular.abc.ttf");
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_face_t *shared, *unshared;
+  hb_blob_t *shared_blob, *unshared_blob;
+
+  hb_set_add (codepoints, 'a');
+  hb_set_add (codepoints, 'b');
+  hb_set_add (codepoints, 'c');
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_set_clear (hb_subset_input_drop_tables_set (input));
+  g_assert_cmpuint (hb_subset_input_get_dedup_budget (input), ==, (unsigned int) -1);
+  shared = hb_subset_test_create_subset (face, input);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_set_clear (hb_subset_input_drop_tables_set (input));
+  hb_subset_input_set_dedup_budget (input, 0);
+  g_assert_cmpuint (hb_subset_input_get_dedup_budget (input), ==, 0);
+  unshared = hb_subset_test_create_subset (face, input);
+
+  shared_blob = hb_face_reference_blob (shared);
+  unshared_blob = hb_face_reference_blob (unshared);
+  g_assert_cmpuint (hb_blob_get_length (shared_blob), >, 0);
+  g_assert_cmpuint (hb_blob_get_length (unshared_blob), >, hb_blob_get_length (shared_blob));
+
+  hb_blob_destroy (shared_blob);
+  hb_blob_destroy (unshared_blob);
+  hb_face_destroy (shared);
+  hb_face_destroy (unshared);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (face);
+}
+
+static hb_face_t *
+_subset_with_layout (hb_face_t *face, const hb_set_t *codepoints)
+{
+  hb_subset_input_t *input = hb_subset_test_create_input (codepoints);
+  hb_set_clear (hb_subset_input_drop_tables_set (input));
+  return hb_subset_test_create_subset (face, input);
+}
+
+static void
+test_subset_preprocess (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_face_t *preprocessed;
+  hb_set_t *codepoints = hb_set_create ();
+  hb_face_t *expected, *actual;
+  hb_blob_t *expected_blob, *actual_blob;
+  unsigned i;
+
+  hb_set_add (codepoints, 'a');
+  hb_set_add (codepoints, 'c');
+
+  expected = _subset_with_layout (face, codepoints);
+  expected_blob = hb_face_reference_blob (expected);
+
+  preprocessed = hb_subset_preprocess (face);
+  g_assert (preprocessed == face);
+
+  /* The second round is answered from the cached closure. */
+  for (i = 0; i < 2; i++)
+  {
+    actual = _subset_with_layout (preprocessed, codepoints);
+    actual_blob = hb_face_reference_blob (actual);
+    hb_test_assert_blobs_equal (expected_blob, actual_blob);
+    hb_blob_destroy (actual_blob);
+    hb_face_destroy (actual);
+  }
+
+  hb_blob_destroy (expected_blob);
+  hb_face_destroy (expected);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (preprocessed);
+  hb_face_destroy (face);
+}
+
+static hb_bool_t
+_append_to_string (const char *data, unsigned int length, void *user_data)
+{
+  g_string_append_len ((GString *) user_data, data, length);
+  return TRUE;
+}
+
+static hb_bool_t
+_refuse_to_write (const char *data HB_UNUSED, unsigned int length HB_UNUSED, void *user_data HB_UNUSED)
+{
+  return FALSE;
+}
+
+static void
+test_subset_write (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_face_t *subset;
+  hb_blob_t *expected, *actual;
+  GString *written = g_string_new (NULL);
+
+  hb_set_add (codepoints, 'a');
+  hb_set_add (codepoints, 'c');
+  input = hb_subset_test_create_input (codepoints);
+
+  subset = hb_subset (face, input);
+  expected = hb_face_reference_blob (subset);
+
+  g_assert (hb_subset_write (face, input, _append_to_string, written));
+  actual = hb_blob_create (written->str, written->len, HB_MEMORY_MODE_READONLY, NULL, NULL);
+  hb_test_assert_blobs_equal (expected, actual);
+
+  g_assert (!hb_subset_write (face, input, _refuse_to_write, NULL));
+
+  hb_blob_destroy (actual);
+  g_string_free (written, TRUE);
+  hb_blob_destroy (expected);
+  hb_face_destroy (subset);
+  hb_subset_input_destroy (input);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (face);
+}
+
+static void
+test_subset_memory_limit (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_face_t *unlimited, *limited;
+  hb_blob_t *unlimited_blob, *limited_blob;
+
+  hb_set_add (codepoints, 'a');
+  hb_set_add (codepoints, 'c');
+
+  input = hb_subset_test_create_input (codepoints);
+  g_assert_cmpuint (hb_subset_input_get_memory_limit (input), ==, (unsigned int) -1);
+  unlimited = hb_subset_test_create_subset (face, input);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_memory_limit (input, 1 << 20);
+  g_assert_cmpuint (hb_subset_input_get_memory_limit (input), ==, 1 << 20);
+  limited = hb_subset_test_create_subset (face, input);
+
+  unlimited_blob = hb_face_reference_blob (unlimited);
+  limited_blob = hb_face_reference_blob (limited);
+  hb_test_assert_blobs_equal (unlimited_blob, limited_blob);
+  hb_blob_destroy (limited_blob);
+  hb_face_destroy (limited);
+
+  /* Not even enough for the first table. */
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_memory_limit (input, 64);
+  limited = hb_subset_test_create_subset (face, input);
+  g_assert (limited == hb_face_get_empty ());
+
+  hb_blob_destroy (unlimited_blob);
+  hb_face_destroy (unlimited);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (face);
+}
+
+static void
+test_subset_op_budget (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.gsub.fi.ttf");
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_face_t *unlimited, *limited;
+  hb_blob_t *unlimited_blob, *limited_blob;
+
+  hb_set_add (codepoints, 'f');
+  hb_set_add (codepoints, 'i');
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_set_clear (hb_subset_input_drop_tables_set (input));
+  g_assert_cmpuint (hb_subset_input_get_op_budget (input), ==, (unsigned int) -1);
+  unlimited = hb_subset_test_create_subset (face, input);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_set_clear (hb_subset_input_drop_tables_set (input));
+  hb_subset_input_set_op_budget (input, 1000);
+  g_assert_cmpuint (hb_subset_input_get_op_budget (input), ==, 1000);
+  limited = hb_subset_test_create_subset (face, input);
+
+  unlimited_blob = hb_face_reference_blob (unlimited);
+  limited_blob = hb_face_reference_blob (limited);
+  hb_test_assert_blobs_equal (unlimited_blob, limited_blob);
+  hb_blob_destroy (limited_blob);
+  hb_face_destroy (limited);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_set_clear (hb_subset_input_drop_tables_set (input));
+  hb_subset_input_set_op_budget (input, 0);
+  limited = hb_subset_test_create_subset (face, input);
+  g_assert (limited == hb_face_get_empty ());
+
+  hb_blob_destroy (unlimited_blob);
+  hb_face_destroy (unlimited);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (face);
+}
+
+typedef struct
+{
+  hb_tag_t cancel_before;
+  unsigned int calls;
+  hb_bool_t seen_gsub;
+  hb_bool_t seen_glyf;
+  hb_bool_t destroyed;
+} progress_data_t;
+
+static hb_bool_t
+_record_progress (hb_tag_t table_tag, void *user_data)
+{
+  progress_data_t *data = (progress_data_t *) user_data;
+  data->calls++;
+  if (table_tag == HB_TAG ('G','S','U','B')) data->seen_gsub = TRUE;
+  if (table_tag == HB_TAG ('g','l','y','f')) data->seen_glyf = TRUE;
+  return table_tag != data->cancel_before;
+}
+
+static void
+_progress_destroy (void *user_data)
+{
+  ((progress_data_t *) user_data)->destroyed = TRUE;
+}
+
+static void
+test_subset_progress (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.gsub.fi.ttf");
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_face_t *expected, *subset;
+  hb_blob_t *expected_blob, *subset_blob;
+  progress_data_t data = {HB_TAG_NONE, 0, FALSE, FALSE, FALSE};
+
+  hb_set_add (codepoints, 'f');
+  hb_set_add (codepoints, 'i');
+
+  expected = _subset_with_layout (face, codepoints);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_set_clear (hb_subset_input_drop_tables_set (input));
+  hb_subset_input_set_progress_func (input, _record_progress, &data, _progress_destroy);
+  subset = hb_subset (face, input);
+  g_assert (data.calls > 0);
+  g_assert (data.seen_gsub);
+  g_assert (data.seen_glyf);
+  g_assert (!data.destroyed);
+  hb_subset_input_destroy (input);
+  g_assert (data.destroyed);
+
+  expected_blob = hb_face_reference_blob (expected);
+  subset_blob = hb_face_reference_blob (subset);
+  hb_test_assert_blobs_equal (expected_blob, subset_blob);
+  hb_blob_destroy (subset_blob);
+  hb_face_destroy (subset);
+
+  data.cancel_before = HB_TAG ('g','l','y','f');
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_progress_func (input, _record_progress, &data, NULL);
+  subset = hb_subset_test_create_subset (face, input);
+  g_assert (subset == hb_face_get_empty ());
+
+  hb_blob_destroy (expected_blob);
+  hb_face_destroy (expected);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -103,6 +411,13 @@ main (int argc, char **argv)
   hb_test_add (test_subset_32_tables);
   hb_test_add (test_subset_no_inf_loop);
   hb_test_add (test_subset_crash);
+  hb_test_add (test_subset_num_threads);
+  hb_test_add (test_subset_dedup_budget);
+  hb_test_add (test_subset_preprocess);
+  hb_test_add (test_subset_write);
+  hb_test_add (test_subset_memory_limit);
+  hb_test_add (test_subset_op_budget);
+  hb_test_add (test_subset_progress);
 
   return hb_test_run();
 }